@@ -16,6 +16,13 @@ if(IS_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}/Tests")
     list(FILTER HEADERS EXCLUDE REGEX ".*\\/Tests\\/.*")
 endif()
 
+set(LIBRARY_HAS_BENCHMARKS FALSE)
+if(IS_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}/Benchmarks")
+    set(LIBRARY_HAS_BENCHMARKS TRUE)
+    list(FILTER SOURCES EXCLUDE REGEX ".*\\/Benchmarks\\/.*")
+    list(FILTER HEADERS EXCLUDE REGEX ".*\\/Benchmarks\\/.*")
+endif()
+
 # main library
 if(NOT SOURCES)
     add_library(${LIB} INTERFACE ${SOURCES})
@@ -62,3 +69,26 @@ if(LIBRARY_HAS_TESTS)
 
     ENDFOREACH()
 endif()
+
+# benchmarks, built like the tests but only on request and not registered with ctest since they take a while
+if(LIBRARY_HAS_BENCHMARKS)
+    message(STATUS "Library has benchmarks: ")
+
+    file(GLOB Benchmarks
+        ${CMAKE_CURRENT_SOURCE_DIR}/Benchmarks/*.cpp
+    )
+    FOREACH(benchmark ${Benchmarks})
+
+        get_filename_component(BenchmarkName ${benchmark} NAME_WE)
+        set(BENCHMARK_EXECUTABLE "${LIB}Benchmark${BenchmarkName}")
+
+        add_executable(${BENCHMARK_EXECUTABLE} EXCLUDE_FROM_ALL ${benchmark})
+        set_target_properties(${BENCHMARK_EXECUTABLE} PROPERTIES RUNTIME_OUTPUT_DIRECTORY_RELEASE ${CMAKE_BINARY_DIR}/out/release_benchmarks)
+        set_target_properties(${BENCHMARK_EXECUTABLE} PROPERTIES RUNTIME_OUTPUT_DIRECTORY_RELWITHDEBINFO ${CMAKE_BINARY_DIR}/out/releaseWithDebInfo_benchmarks)
+        set_target_properties(${BENCHMARK_EXECUTABLE} PROPERTIES RUNTIME_OUTPUT_DIRECTORY_DEBUG ${CMAKE_BINARY_DIR}/out/debug_benchmarks)
+        target_link_libraries(${BENCHMARK_EXECUTABLE} PRIVATE ${LIB})
+
+        message(STATUS "    ${BenchmarkName}")
+
+    ENDFOREACH()
+endif()
@@ -3,12 +3,15 @@
 #include "Scene/Scene.hpp"
 #include <Datastructures/Span.hpp>
 #include <Engine/Graphics/Barrier/Barrier.hpp>
+#include <Engine/Graphics/Culling/Frustum.hpp>
 #include <Engine/Graphics/Mesh/Cube.hpp>
 #include <Engine/Graphics/Mesh/Fullscreen.hpp>
 #include <Engine/Misc/Math.hpp>
 #include <ImGui/imgui.h>
 #include <ImGui/imgui_impl_glfw.h>
 #include <ImGui/imgui_impl_vulkan.h>
+#include <algorithm>
+#include <cstddef>
 #include <format>
 #include <fstream>
 #include <future>
@@ -34,7 +37,8 @@ Editor::Editor()
     auto index = threadPool.getThreadPoolThreadIndex();
     assert(index == 0);
     ThreadPool::nameCurrentThread("Main Thread");
-    threadPool.start(4);
+    // VulkanDevice has one command pool per hardwareThreadCount(), the scene pass gets recorded on all of them
+    threadPool.start(ThreadPool::hardwareThreadCount() - 1);
 
     mainCamera =
         Camera{static_cast<float>(mainWindow.width) / static_cast<float>(mainWindow.height), 0.1f, 1000.0f};
@@ -46,10 +50,18 @@ Editor::Editor()
 
     // TODO: execute this while GPU is already doing work, instead of waiting for this *then* starting GPU
     // https://developer.nvidia.com/ue4-sun-temple (exported from blender as gltf)
-    Scene::load("C:/Users/jonas/Documents/Models/Sponza/out/Sponza.gltf", &ecs, scene.root);
+    scene.load("C:/Users/jonas/Documents/Models/Sponza/out/Sponza.gltf", &ecs, scene.root, &threadPool);
 
     // ------------------------ Build MeshData & InstanceInfo buffer ------------------------------------------
     TracyCZoneN(zoneGPUScene, "Build GPU Scene", true);
+    // offsets of MeshData, InstanceInfo and DrawCandidate in the shaders, which are compiled with scalar layout
+    static_assert(offsetof(GPUMeshData, encoding) == 20 && offsetof(GPUMeshData, positionOffset) == 24);
+    static_assert(offsetof(GPUMeshData, uvOffset) == 48 && offsetof(GPUMeshData, meshletCount) == 64);
+    static_assert(offsetof(GPUMeshData, aabbMin) == 80 && offsetof(GPUMeshData, sphereRadius) == 116);
+    static_assert(sizeof(GPUMeshData) == 120);
+    static_assert(sizeof(Meshlets::Meshlet) == 60);
+    static_assert(offsetof(InstanceInfo, meshDataIndex) == 48 && sizeof(InstanceInfo) == 64);
+    static_assert(offsetof(GPUCullingData::Candidate, cullable) == 20 && sizeof(GPUCullingData::Candidate) == 24);
     VkCommandBuffer mainCmdBuffer = gfxDevice.beginCommandBuffer();
 
     auto& rm = resourceManager;
@@ -78,17 +90,33 @@ Editor::Editor()
             break;
         }
 
+        const bool hasMeshlets = renderData.meshletCount > 0;
         auto freeIndex = gpuMeshDataBuffer.freeIndex++;
-        assert(renderData.gpuIndex == 0xFFFFFFFF);
-        renderData.gpuIndex = freeIndex;
+        assert(!gpuMeshDataBuffer.meshIndices.contains(mesh));
+        gpuMeshDataBuffer.meshIndices.insert(mesh, freeIndex);
         gpuPtr[freeIndex] = GPUMeshData{
             .indexCount = renderData.indexCount,
-            .additionalUVCount = renderData.additionalUVCount,
+            .additionalUVCount = renderData.attributeFormat.additionalUVCount,
             .indexBuffer = *rm.get<ResourceIndex>(renderData.indexBuffer),
             .positionBuffer = *rm.get<ResourceIndex>(renderData.positionBuffer),
             .attributeBuffer = *rm.get<ResourceIndex>(renderData.attributeBuffer),
+            .encoding = renderData.attributeFormat.encoding.bits(),
+            .positionOffset = renderData.dequantization.positionOffset,
+            .positionScale = renderData.dequantization.positionScale,
+            .uvOffset = renderData.dequantization.uvOffset,
+            .uvScale = renderData.dequantization.uvScale,
+            .meshletCount = renderData.meshletCount,
+            .meshletBuffer = hasMeshlets ? *rm.get<ResourceIndex>(renderData.meshletBuffer) : 0xFFFFFFFF,
+            .meshletVertexBuffer =
+                hasMeshlets ? *rm.get<ResourceIndex>(renderData.meshletVertexBuffer) : 0xFFFFFFFF,
+            .meshletTriangleBuffer =
+                hasMeshlets ? *rm.get<ResourceIndex>(renderData.meshletTriangleBuffer) : 0xFFFFFFFF,
+            .aabbMin = glm::make_vec3(renderData.aabb.min),
+            .aabbMax = glm::make_vec3(renderData.aabb.max),
+            .sphereCenter = glm::make_vec3(renderData.boundingSphere.center),
+            .sphereRadius = renderData.boundingSphere.radius,
         };
-        assert(resourceManager.get<Mesh::RenderData>(mesh)->gpuIndex != 0xFFFFFFFF);
+        assert(gpuMeshDataBuffer.meshIndices.contains(mesh));
     }
     gfxDevice.copyBuffer(mainCmdBuffer, meshDataAllocBuffer, gpuMeshDataBuffer.buffer);
     gfxDevice.destroy(meshDataAllocBuffer);
@@ -115,8 +143,8 @@ Editor::Editor()
                     break;
                 }
                 assert(resourceManager.getMeshPool().isHandleValid(mesh));
-                const Mesh::RenderData& renderData = *rm.get<Mesh::RenderData>(mesh);
-                assert(renderData.gpuIndex != 0xFFFFFFFF);
+                const uint32_t* meshDataIndex = gpuMeshDataBuffer.meshIndices.get(mesh);
+                assert(meshDataIndex != nullptr);
 
                 auto* name = rm.get<std::string>(mesh);
 
@@ -130,8 +158,7 @@ Editor::Editor()
 
                 gpuInstancePtr[freeIndex] = InstanceInfo{
                     .transform = transform->localToWorld,
-                    .invTranspTransform = glm::inverseTranspose(transform->localToWorld),
-                    .meshDataIndex = renderData.gpuIndex,
+                    .meshDataIndex = *meshDataIndex,
                     .materialIndex = 0xFFFFFFFF, // TODO: correct value
                     .materialParamsBuffer = hasMatParameters ? *rm.get<ResourceIndex>(matParamBuffer) : 0xFFFFFFFF,
                     .materialInstanceParamsBuffer =
@@ -142,6 +169,7 @@ Editor::Editor()
         });
     gfxDevice.copyBuffer(mainCmdBuffer, instanceAllocBuffer, gpuInstanceInfoBuffer.buffer);
     gfxDevice.destroy(instanceAllocBuffer);
+    createCullingCandidates();
     TracyCZoneEnd(zoneGPUScene);
 
     // ------------------------------------------------------------------------------
@@ -198,6 +226,42 @@ void Editor::createDefaultAssets()
             .allStates = ResourceState::UniformBuffer,
             .initialState = ResourceState::UniformBuffer,
         });
+        perFrameData[i].instanceIndexBuffer = resourceManager.createBuffer(Buffer::CreateInfo{
+            .debugName = ("InstanceIndexBuffer" + std::to_string(i)),
+            .size = sizeof(uint32_t) * gpuInstanceInfoBuffer.limit,
+            .memoryType = Buffer::MemoryType::GPU_BUT_CPU_VISIBLE,
+            .allStates = ResourceState::Storage,
+            .initialState = ResourceState::Storage,
+        });
+        perFrameData[i].frustumPlaneBuffer = resourceManager.createBuffer(Buffer::CreateInfo{
+            .debugName = ("FrustumPlaneBuffer" + std::to_string(i)),
+            .size = sizeof(Culling::Frustum::planes),
+            .memoryType = Buffer::MemoryType::GPU_BUT_CPU_VISIBLE,
+            .allStates = ResourceState::Storage,
+            .initialState = ResourceState::Storage,
+        });
+        // there is at most one candidate and one group per instance
+        perFrameData[i].drawCommandBuffer = resourceManager.createBuffer(Buffer::CreateInfo{
+            .debugName = ("DrawCommandBuffer" + std::to_string(i)),
+            .size = sizeof(VkDrawIndirectCommand) * gpuInstanceInfoBuffer.limit,
+            .memoryType = Buffer::MemoryType::GPU,
+            .allStates = ResourceState::StorageCompute | ResourceState::IndirectArgument,
+            .initialState = ResourceState::IndirectArgument,
+        });
+        perFrameData[i].drawCountBuffer = resourceManager.createBuffer(Buffer::CreateInfo{
+            .debugName = ("DrawCountBuffer" + std::to_string(i)),
+            .size = sizeof(uint32_t) * gpuInstanceInfoBuffer.limit,
+            .memoryType = Buffer::MemoryType::GPU_BUT_CPU_VISIBLE,
+            .allStates = ResourceState::StorageCompute | ResourceState::IndirectArgument,
+            .initialState = ResourceState::IndirectArgument,
+        });
+        perFrameData[i].culledInstanceIndexBuffer = resourceManager.createBuffer(Buffer::CreateInfo{
+            .debugName = ("CulledInstanceIndexBuffer" + std::to_string(i)),
+            .size = sizeof(uint32_t) * gpuInstanceInfoBuffer.limit,
+            .memoryType = Buffer::MemoryType::GPU,
+            .allStates = ResourceState::StorageCompute | ResourceState::StorageGraphics,
+            .initialState = ResourceState::StorageGraphics,
+        });
     }
 
     createDefaultSamplers();
@@ -236,6 +300,8 @@ void Editor::createDefaultAssets()
         assert(!meshRenderer->subMeshes[1].isNonNull());
         // renderInfo->materialInstance = equiSkyboxMatInst;
         meshRenderer->materialInstances[0] = cubeSkyboxMatInst;
+        meshRenderer->updateLocalBounds();
+        meshRenderer->frustumCulled = false;
     }
 
     auto triangleObject = scene.createEntity();
@@ -243,11 +309,9 @@ void Editor::createDefaultAssets()
         auto* meshRenderer = triangleObject.addComponent<MeshRenderer>();
         meshRenderer->subMeshes[0] = triangleMesh;
         meshRenderer->materialInstances[0] = unlitMatInst;
+        meshRenderer->updateLocalBounds();
         auto* transform = triangleObject.getComponent<Transform>();
-        transform->position = glm::vec3{3.0f, 0.0f, 0.0f};
-        transform->calculateLocalTransformMatrix();
-        // dont like having to call this manually
-        transform->localToWorld = transform->localTransform;
+        transform->setPosition(glm::vec3{3.0f, 0.0f, 0.0f});
 
         assert(meshRenderer->subMeshes[0].isNonNull());
         assert(meshRenderer->materialInstances[0].isNonNull());
@@ -410,13 +474,15 @@ void Editor::createDefaultComputeShaders()
         {.sourcePath = SHADERS_PATH "/Skybox/generateIrradiance.comp", .debugName = "generateIrradiance"},
         {.sourcePath = SHADERS_PATH "/Misc/debugMipFill.comp", .debugName = "debugMipFill"},
         {.sourcePath = SHADERS_PATH "/Skybox/prefilter.comp", .debugName = "prefilterEnvComp"},
-        {.sourcePath = SHADERS_PATH "/PBR/integrateBRDF.comp", .debugName = "integrateBRDFComp"} //
+        {.sourcePath = SHADERS_PATH "/PBR/integrateBRDF.comp", .debugName = "integrateBRDFComp"},
+        {.sourcePath = SHADERS_PATH "/Culling/cullInstances.comp", .debugName = "cullInstances"} //
     });
     equiToCubeShader = shaders[0];
     irradianceCalcShader = shaders[1];
     debugMipFillShader = shaders[2];
     prefilterEnvShader = shaders[3];
     integrateBrdfShader = shaders[4];
+    cullInstancesShader = shaders[5];
 }
 
 void Editor::createRendertargets()
@@ -764,7 +830,14 @@ void Editor::update()
     }
     // Not sure about the order of UI & engine code
 
+    scene.updateTransforms();
+    updateSelection();
+
     ImGui::ShowDemoWindow();
+    drawSelectionUI();
+    ImGui::Begin("Rendering");
+    ImGui::Checkbox("GPU driven culling", &gpuDrivenRendering);
+    ImGui::End();
     ImGui::Render();
 
     // --------------- Rendering code -----------------------------
@@ -780,6 +853,7 @@ void Editor::update()
     }
 
     VkCommandBuffer materialParamUpdates = updateDirtyMaterialParameters();
+    VkCommandBuffer instanceUpdates = updateMovedInstances();
 
     // update renderPassData
     RenderPassData renderPassData;
@@ -790,15 +864,26 @@ void Editor::update()
     void* renderPassDataPtr = *resourceManager.get<void*>(getCurrentFrameData().renderPassDataBuffer);
     memcpy(renderPassDataPtr, &renderPassData, sizeof(RenderPassData));
 
-    auto offscreenFuture =
-        threadPool.queueJob([editor = this](int threadIndex) { return editor->drawScene(threadIndex); });
+    // the jobs only record, everything they read has to be ready before they start
+    const uint32_t scenePartCount = prepareScene();
+    std::vector<std::future<VkCommandBuffer>> offscreenFutures;
+    offscreenFutures.reserve(scenePartCount);
+    for(uint32_t part = 0; part < scenePartCount; part++)
+    {
+        offscreenFutures.push_back(threadPool.queueJob(
+            [editor = this, part, scenePartCount](int threadIndex)
+            { return editor->drawScene(threadIndex, part, scenePartCount); }));
+    }
     auto onscreenFuture =
         threadPool.queueJob([editor = this](int threadIndex) { return editor->drawUI(threadIndex); });
 
-    VkCommandBuffer offscreenCmdBuffer = offscreenFuture.get();
-    VkCommandBuffer onscreenCmdBuffer = onscreenFuture.get();
+    // the parts of the scene pass have to stay in order and next to each other
+    std::vector<VkCommandBuffer> cmdBuffers{materialParamUpdates, instanceUpdates};
+    for(auto& future : offscreenFutures)
+        cmdBuffers.push_back(future.get());
+    cmdBuffers.push_back(onscreenFuture.get());
 
-    gfxDevice.submitCommandBuffers({materialParamUpdates, offscreenCmdBuffer, onscreenCmdBuffer});
+    gfxDevice.submitCommandBuffers(cmdBuffers);
 
     gfxDevice.presentSwapchain();
 
@@ -806,79 +891,400 @@ void Editor::update()
     FrameMark;
 }
 
-VkCommandBuffer Editor::drawScene(int threadIndex)
+void Editor::cullScene()
+{
+    ZoneScoped;
+    culling.visibleEntities.clear();
+    culling.visible.clear();
+    const Culling::Frustum frustum = Culling::extractFrustum(glm::value_ptr(mainCamera.getProjView()));
+    scene.queryVisible(frustum, culling.visibleEntities);
+    for(ECS::Entity entity : culling.visibleEntities)
+        culling.visible.push_back({entity.getComponent<MeshRenderer>(), entity.getComponent<Transform>()});
+    TracyPlot("Visible objects", int64_t(culling.visible.size()));
+}
+
+void Editor::updateSelection()
+{
+    // Camera movement uses the same button, only clicks that barely moved the mouse select something
+    constexpr float maxClickDistance = 4.0f;
+    const ImGuiIO& io = ImGui::GetIO();
+    if(io.WantCaptureMouse || !ImGui::IsMouseReleased(ImGuiMouseButton_Left) ||
+       io.MouseDragMaxDistanceSqr[ImGuiMouseButton_Left] > maxClickDistance * maxClickDistance)
+        return;
+
+    // window coordinates to NDC, Vulkan has y pointing down just like the window
+    const glm::vec2 ndc = glm::vec2{io.MousePos.x, io.MousePos.y} / glm::vec2{io.DisplaySize.x, io.DisplaySize.y};
+    const glm::mat4 invProjView = mainCamera.getInvProjView();
+    const auto unproject = [&](float depth)
+    {
+        const glm::vec4 world = invProjView * glm::vec4{ndc * 2.0f - 1.0f, depth, 1.0f};
+        return glm::vec3{world} / world.w;
+    };
+    const glm::vec3 nearPoint = unproject(0.0f);
+    const glm::vec3 farPoint = unproject(1.0f);
+    selectedEntity = scene.raycast(nearPoint, glm::normalize(farPoint - nearPoint));
+}
+
+void Editor::drawSelectionUI()
+{
+    ImGui::Begin("Selection");
+    // a default constructed Entity if the last click didnt hit anything
+    const bool hasSelection = selectedEntity.getID() != ECS::Entity{}.getID();
+    auto* transform = hasSelection ? selectedEntity.getComponent<Transform>() : nullptr;
+    if(transform == nullptr)
+    {
+        ImGui::TextUnformatted("Click on an object to select it");
+        ImGui::End();
+        return;
+    }
+    ImGui::Text("Entity %u", selectedEntity.getID());
+    glm::vec3 position = transform->getPosition();
+    if(ImGui::DragFloat3("Position", &position.x, 0.1f))
+        transform->setPosition(position);
+    if(const auto* meshRenderer = selectedEntity.getComponent<MeshRenderer>())
+    {
+        const Bounds::AABB& bounds = meshRenderer->worldBounds;
+        ImGui::Text("Bounds min: %.2f %.2f %.2f", bounds.min[0], bounds.min[1], bounds.min[2]);
+        ImGui::Text("Bounds max: %.2f %.2f %.2f", bounds.max[0], bounds.max[1], bounds.max[2]);
+    }
+    ImGui::End();
+}
+
+void Editor::buildDrawList()
 {
     ZoneScoped;
-    VkCommandBuffer offscreenCmdBuffer = gfxDevice.beginCommandBuffer(threadIndex);
+    drawList.draws.clear();
+    drawList.packets.clear();
+
+    // LODs are picked by their error in pixels
+    const glm::vec3 cameraPosition = mainCamera.getPosition();
+    const float projectionScale =
+        float(gfxDevice.getSwapchainHeight()) / (2.0f * glm::tan(mainCamera.getFov() * 0.5f));
+
+    for(const DrawObject& object : culling.visible)
+    {
+        const MeshRenderer* meshRenderer = object.meshRenderer;
+        // to the closest point of the bounding sphere, selectLOD picks LOD 0 when the camera is inside
+        const Bounds::Sphere& sphere = meshRenderer->worldSphere;
+        const float distance = glm::length(cameraPosition - glm::make_vec3(sphere.center)) - sphere.radius;
+        const float worldScale = object.transform->localToWorld.getMaxScale();
+
+        for(int i = 0; i < Mesh::MAX_SUBMESHES; i++)
+        {
+            const Mesh::Handle mesh = meshRenderer->subMeshes[i];
+            if(!mesh.isNonNull())
+                break;
+            const MaterialInstance::Handle materialInstance = meshRenderer->materialInstances[i];
+            const Material::Handle material = *resourceManager.get<Material::Handle>(materialInstance);
+            const Mesh::RenderData& meshData = *resourceManager.get<Mesh::RenderData>(mesh);
+            const Mesh::LOD& lod = meshData.lods[Mesh::selectLOD(meshData, worldScale, distance, projectionScale)];
+
+            // opaque only for now, so everything goes into pass 0
+            const uint64_t key = DrawList::makeKey(
+                0, material.getIndex(), materialInstance.getIndex(), mesh.getIndex(), distance);
+            drawList.packets.push_back({.key = key, .draw = uint32_t(drawList.draws.size())});
+            drawList.draws.push_back({
+                .material = material,
+                .indexCount = lod.indexCount,
+                .firstIndex = lod.indexOffset,
+                .instanceIndex = meshRenderer->instanceBufferIndices[i],
+            });
+        }
+    }
+    DrawList::sort(drawList.packets, drawList.scratch);
+
+    // the vertex shader reads everything else per instance, so only the index range has to match
+    drawList.batches.clear();
+    DrawList::buildBatches(
+        drawList.packets,
+        [&](uint32_t a, uint32_t b)
+        {
+            const DrawCommand& drawA = drawList.draws[a];
+            const DrawCommand& drawB = drawList.draws[b];
+            return drawA.indexCount == drawB.indexCount && drawA.firstIndex == drawB.firstIndex;
+        },
+        drawList.batches);
+
+    assert(drawList.packets.size() <= gpuInstanceInfoBuffer.limit);
+    auto* instanceIndices =
+        static_cast<uint32_t*>(*resourceManager.get<void*>(getCurrentFrameData().instanceIndexBuffer));
+    for(uint32_t i = 0; i < drawList.packets.size(); i++)
+        instanceIndices[i] = drawList.draws[drawList.packets[i].draw].instanceIndex;
+
+    const DrawList::StateChanges changes = DrawList::countStateChanges(drawList.packets);
+    TracyPlot("Draws", int64_t(drawList.batches.size()));
+    TracyPlot("Instances", int64_t(drawList.packets.size()));
+    TracyPlot("Pipeline changes", int64_t(changes.pipelines));
+    TracyPlot("Material instance changes", int64_t(changes.materials));
+    TracyPlot("Mesh changes", int64_t(changes.meshes));
+}
+
+void Editor::createCullingCandidates()
+{
+    ZoneScoped;
+    struct UnsortedCandidate
+    {
+        Material::Handle material;
+        GPUCullingData::Candidate candidate;
+    };
+    std::vector<UnsortedCandidate> unsorted;
+    ecs.forEach<MeshRenderer, Transform>(
+        [&](MeshRenderer* meshRenderer, Transform* /*transform*/)
+        {
+            for(int i = 0; i < Mesh::MAX_SUBMESHES; i++)
+            {
+                const Mesh::Handle mesh = meshRenderer->subMeshes[i];
+                if(!mesh.isNonNull())
+                    break;
+                const Mesh::LOD& lod = resourceManager.get<Mesh::RenderData>(mesh)->lods[0];
+                unsorted.push_back({
+                    .material = *resourceManager.get<Material::Handle>(meshRenderer->materialInstances[i]),
+                    .candidate =
+                        {
+                            .instanceIndex = meshRenderer->instanceBufferIndices[i],
+                            .firstIndex = lod.indexOffset,
+                            .indexCount = lod.indexCount,
+                            .cullable = meshRenderer->frustumCulled ? 1u : 0u,
+                        },
+                });
+            }
+        });
+    assert(unsorted.size() <= gpuInstanceInfoBuffer.limit);
+    std::stable_sort(
+        unsorted.begin(),
+        unsorted.end(),
+        [](const UnsortedCandidate& a, const UnsortedCandidate& b)
+        { return a.material.getIndex() < b.material.getIndex(); });
+
+    // every group reserves a draw command per candidate, so the culling shader can never run out of space
+    std::vector<GPUCullingData::Candidate> candidates(unsorted.size());
+    gpuCulling.groups.clear();
+    for(uint32_t i = 0; i < unsorted.size(); i++)
+    {
+        if(gpuCulling.groups.empty() || gpuCulling.groups.back().material != unsorted[i].material)
+        {
+            gpuCulling.groups.push_back(
+                {.material = unsorted[i].material, .firstCandidate = i, .candidateCount = 0});
+        }
+        GPUCullingData::Group& group = gpuCulling.groups.back();
+        group.candidateCount++;
+        candidates[i] = unsorted[i].candidate;
+        candidates[i].group = uint32_t(gpuCulling.groups.size() - 1);
+        candidates[i].firstCommand = group.firstCandidate;
+    }
+
+    gpuCulling.candidateCount = uint32_t(candidates.size());
+    if(candidates.empty())
+        return;
+    gpuCulling.candidateBuffer = resourceManager.createBuffer(Buffer::CreateInfo{
+        .debugName = "CullingCandidateBuffer",
+        .size = sizeof(GPUCullingData::Candidate) * candidates.size(),
+        .memoryType = Buffer::MemoryType::GPU,
+        .allStates = ResourceState::Storage | ResourceState::TransferDst,
+        .initialState = ResourceState::Storage,
+        .initialData = {(uint8_t*)candidates.data(), sizeof(GPUCullingData::Candidate) * candidates.size()},
+    });
+}
+
+void Editor::cullOnGPU(VkCommandBuffer cmd)
+{
+    ZoneScoped;
+    if(gpuCulling.candidateCount == 0)
+        return;
+    PerFrameData& frameData = getCurrentFrameData();
+
+    const Culling::Frustum frustum = Culling::extractFrustum(glm::value_ptr(mainCamera.getProjView()));
+    memcpy(*resourceManager.get<void*>(frameData.frustumPlaneBuffer), frustum.planes, sizeof(frustum.planes));
+    // the GPU is done with this frames buffers, so the counters can just be reset from here
+    memset(*resourceManager.get<void*>(frameData.drawCountBuffer), 0, sizeof(uint32_t) * gpuCulling.groups.size());
 
     gfxDevice.insertBarriers(
-        offscreenCmdBuffer,
+        cmd,
         {
-            Barrier::FromImage{
-                .texture = depthTexture,
-                .stateBefore = ResourceState::DepthStencilTarget,
-                .stateAfter = ResourceState::DepthStencilTarget,
-                .allowDiscardOriginal = true,
+            Barrier::FromBuffer{
+                .buffer = frameData.drawCommandBuffer,
+                .stateBefore = ResourceState::IndirectArgument,
+                .stateAfter = ResourceState::StorageCompute,
             },
-            Barrier::FromImage{
-                .texture = offscreenTexture,
-                .stateBefore = ResourceState::SampleSourceGraphics,
-                .stateAfter = ResourceState::Rendertarget,
-                .allowDiscardOriginal = true,
+            Barrier::FromBuffer{
+                .buffer = frameData.drawCountBuffer,
+                .stateBefore = ResourceState::IndirectArgument,
+                .stateAfter = ResourceState::StorageCompute,
+            },
+            Barrier::FromBuffer{
+                .buffer = frameData.culledInstanceIndexBuffer,
+                .stateBefore = ResourceState::StorageGraphics,
+                .stateAfter = ResourceState::StorageCompute,
+            },
+        });
+
+    struct CullingPushConstants
+    {
+        ResourceIndex candidates;
+        ResourceIndex instances;
+        ResourceIndex frustumPlanes;
+        ResourceIndex drawCommands;
+        ResourceIndex drawCounts;
+        ResourceIndex instanceIndices;
+        uint32_t candidateCount;
+    };
+    const auto index = [&](Buffer::Handle buffer) { return *resourceManager.get<ResourceIndex>(buffer); };
+    const CullingPushConstants constants{
+        .candidates = index(gpuCulling.candidateBuffer),
+        .instances = index(gpuInstanceInfoBuffer.buffer),
+        .frustumPlanes = index(frameData.frustumPlaneBuffer),
+        .drawCommands = index(frameData.drawCommandBuffer),
+        .drawCounts = index(frameData.drawCountBuffer),
+        .instanceIndices = index(frameData.culledInstanceIndexBuffer),
+        .candidateCount = gpuCulling.candidateCount,
+    };
+    gfxDevice.setComputePipelineState(cmd, resourceManager.get(cullInstancesShader)->pipeline);
+    gfxDevice.pushConstants(cmd, sizeof(CullingPushConstants), &constants);
+    // 64 threads per group, see cullInstances.comp
+    gfxDevice.dispatchCompute(cmd, UintDivAndCeil(gpuCulling.candidateCount, 64), 1, 1);
+
+    gfxDevice.insertBarriers(
+        cmd,
+        {
+            Barrier::FromBuffer{
+                .buffer = frameData.drawCommandBuffer,
+                .stateBefore = ResourceState::StorageCompute,
+                .stateAfter = ResourceState::IndirectArgument,
+            },
+            Barrier::FromBuffer{
+                .buffer = frameData.drawCountBuffer,
+                .stateBefore = ResourceState::StorageCompute,
+                .stateAfter = ResourceState::IndirectArgument,
+            },
+            Barrier::FromBuffer{
+                .buffer = frameData.culledInstanceIndexBuffer,
+                .stateBefore = ResourceState::StorageCompute,
+                .stateAfter = ResourceState::StorageGraphics,
             },
         });
+}
+
+void Editor::drawGPUCulled(VkCommandBuffer cmd)
+{
+    ZoneScoped;
+    const PerFrameData& frameData = getCurrentFrameData();
+    for(uint32_t i = 0; i < gpuCulling.groups.size(); i++)
+    {
+        const GPUCullingData::Group& group = gpuCulling.groups[i];
+        gfxDevice.setGraphicsPipelineState(cmd, *resourceManager.get<VkPipeline>(group.material));
+        gfxDevice.drawIndirectCount(
+            cmd,
+            frameData.drawCommandBuffer,
+            sizeof(VkDrawIndirectCommand) * group.firstCandidate,
+            frameData.drawCountBuffer,
+            sizeof(uint32_t) * i,
+            group.candidateCount);
+    }
+    // the amount of visible instances is only known on the GPU
+    TracyPlot("Draws", int64_t(gpuCulling.groups.size()));
+}
+
+uint32_t Editor::prepareScene()
+{
+    ZoneScoped;
+    if(gpuDrivenRendering)
+        return 1;
+
+    cullScene();
+    buildDrawList();
+    const auto batchCount = uint32_t(drawList.batches.size());
+    const uint32_t partCount =
+        std::clamp(batchCount / minBatchesPerScenePart, 1u, uint32_t(threadPool.amountOfThreads()));
+    TracyPlot("Scene recording jobs", int64_t(partCount));
+    return partCount;
+}
 
+VkCommandBuffer Editor::drawScene(int threadIndex, uint32_t part, uint32_t partCount)
+{
+    ZoneScoped;
+    // only the GPU culling needs compute
+    const bool needsCompute = part == 0 && gpuDrivenRendering;
+    VkCommandBuffer offscreenCmdBuffer = gfxDevice.beginCommandBuffer(
+        threadIndex,
+        needsCompute ? VulkanDevice::BindPoints::GraphicsAndCompute : VulkanDevice::BindPoints::Graphics);
+
+    RenderingSplit split = RenderingSplit::None;
+    if(partCount > 1)
+    {
+        if(part == 0)
+            split = RenderingSplit::Suspend;
+        else
+            split = part + 1 == partCount ? RenderingSplit::Resume : RenderingSplit::ResumeAndSuspend;
+    }
+
+    if(part == 0)
+    {
+        // before the graphics push constants, the dispatch overwrites them
+        if(gpuDrivenRendering)
+            cullOnGPU(offscreenCmdBuffer);
+
+        gfxDevice.insertBarriers(
+            offscreenCmdBuffer,
+            {
+                Barrier::FromImage{
+                    .texture = depthTexture,
+                    .stateBefore = ResourceState::DepthStencilTarget,
+                    .stateAfter = ResourceState::DepthStencilTarget,
+                    .allowDiscardOriginal = true,
+                },
+                Barrier::FromImage{
+                    .texture = offscreenTexture,
+                    .stateBefore = ResourceState::SampleSourceGraphics,
+                    .stateAfter = ResourceState::Rendertarget,
+                    .allowDiscardOriginal = true,
+                },
+            });
+    }
+
+    // the clears only happen in the first part, resuming continues where the last part suspended
     gfxDevice.beginRendering(
         offscreenCmdBuffer,
         {ColorTarget{.texture = offscreenTexture, .loadOp = RenderTarget::LoadOp::Clear}},
-        DepthTarget{.texture = depthTexture, .loadOp = RenderTarget::LoadOp::Clear});
+        DepthTarget{.texture = depthTexture, .loadOp = RenderTarget::LoadOp::Clear},
+        split);
 
     GraphicsPushConstants pushConstants;
     pushConstants.renderInfoBuffer =
         *resourceManager.get<ResourceIndex>(getCurrentFrameData().renderPassDataBuffer);
     pushConstants.instanceBuffer = *resourceManager.get<ResourceIndex>(gpuInstanceInfoBuffer.buffer);
+    const PerFrameData& frameData = getCurrentFrameData();
+    pushConstants.instanceIndexBuffer = *resourceManager.get<ResourceIndex>(
+        gpuDrivenRendering ? frameData.culledInstanceIndexBuffer : frameData.instanceIndexBuffer);
 
     gfxDevice.pushConstants(offscreenCmdBuffer, sizeof(GraphicsPushConstants), &pushConstants);
 
-    Mesh::Handle lastMesh = Mesh::Handle::Invalid();
-    Material::Handle lastMaterial = Material::Handle::Invalid();
-    MaterialInstance::Handle lastMaterialInstance = MaterialInstance::Handle::Invalid();
-    uint32_t indexCount = 0;
+    if(gpuDrivenRendering)
+    {
+        drawGPUCulled(offscreenCmdBuffer);
+    }
+    else
+    {
+        // contiguous ranges of batches, so the parts keep the sorted order between them
+        const auto batchCount = uint32_t(drawList.batches.size());
+        const uint32_t firstBatch = uint64_t(batchCount) * part / partCount;
+        const uint32_t endBatch = uint64_t(batchCount) * (part + 1) / partCount;
 
-    ecs.forEach<MeshRenderer>(
-        [&](MeshRenderer* meshRenderer)
+        Material::Handle lastMaterial = Material::Handle::Invalid();
+        for(uint32_t i = firstBatch; i < endBatch; i++)
         {
-            for(int i = 0; i < Mesh::MAX_SUBMESHES; i++)
+            const DrawList::Batch& batch = drawList.batches[i];
+            const DrawCommand& draw = drawList.draws[drawList.packets[batch.firstPacket].draw];
+            if(draw.material != lastMaterial)
             {
-                Mesh::Handle objectMesh = meshRenderer->subMeshes[i];
-                if(!objectMesh.isNonNull())
-                {
-                    break;
-                }
-
-                MaterialInstance::Handle objectMaterialInstance = meshRenderer->materialInstances[i];
-
-                if(objectMaterialInstance != lastMaterialInstance)
-                {
-                    Material::Handle newMaterial = *resourceManager.get<Material::Handle>(objectMaterialInstance);
-                    if(newMaterial != lastMaterial)
-                    {
-                        gfxDevice.setGraphicsPipelineState(
-                            offscreenCmdBuffer, *resourceManager.get<VkPipeline>(newMaterial));
-                        lastMaterial = newMaterial;
-                    }
-                }
-
-                if(objectMesh != lastMesh)
-                {
-                    const Mesh::RenderData& meshData = *resourceManager.get<Mesh::RenderData>(objectMesh);
-                    indexCount = meshData.indexCount;
-                    lastMesh = objectMesh;
-                }
-
-                gfxDevice.draw(offscreenCmdBuffer, indexCount, 1, 0, meshRenderer->instanceBufferIndices[i]);
+                gfxDevice.setGraphicsPipelineState(
+                    offscreenCmdBuffer, *resourceManager.get<VkPipeline>(draw.material));
+                lastMaterial = draw.material;
             }
-        });
+            // firstInstance points into the instance index buffer, see VSInput
+            gfxDevice.draw(
+                offscreenCmdBuffer, draw.indexCount, batch.packetCount, draw.firstIndex, batch.firstPacket);
+        }
+    }
 
     gfxDevice.endRendering(offscreenCmdBuffer);
     gfxDevice.endCommandBuffer(offscreenCmdBuffer);
@@ -889,7 +1295,8 @@ VkCommandBuffer Editor::drawScene(int threadIndex)
 VkCommandBuffer Editor::drawUI(int threadIndex)
 {
     ZoneScoped;
-    VkCommandBuffer onscreenCmdBuffer = gfxDevice.beginCommandBuffer(threadIndex);
+    VkCommandBuffer onscreenCmdBuffer =
+        gfxDevice.beginCommandBuffer(threadIndex, VulkanDevice::BindPoints::Graphics);
 
     gfxDevice.insertBarriers(
         onscreenCmdBuffer,
@@ -1003,4 +1410,68 @@ VkCommandBuffer Editor::updateDirtyMaterialParameters()
     gfxDevice.endCommandBuffer(materialUpdateCmds);
 
     return materialUpdateCmds;
+}
+
+VkCommandBuffer Editor::updateMovedInstances()
+{
+    ZoneScoped;
+    VkCommandBuffer instanceUpdateCmds = gfxDevice.beginCommandBuffer();
+
+    const TransformHierarchy& hierarchy = scene.transformHierarchy;
+    movedInstances.clear();
+    for(uint32_t node : hierarchy.getMovedNodes())
+    {
+        const auto* meshRenderer = hierarchy.getEntity(node).getComponent<MeshRenderer>();
+        if(meshRenderer == nullptr)
+            continue;
+        for(uint32_t instanceIndex : meshRenderer->instanceBufferIndices)
+        {
+            // MeshRenderers created after the InstanceInfo buffer was filled dont have an entry
+            if(instanceIndex != 0xFFFFFFFF)
+                movedInstances.push_back({instanceIndex, node});
+        }
+    }
+    TracyPlot("Moved instances", int64_t(movedInstances.size()));
+    if(movedInstances.empty())
+    {
+        gfxDevice.endCommandBuffer(instanceUpdateCmds);
+        return instanceUpdateCmds;
+    }
+
+    gfxDevice.insertBarriers(
+        instanceUpdateCmds,
+        {
+            Barrier::FromBuffer{
+                .buffer = gpuInstanceInfoBuffer.buffer,
+                .stateBefore = ResourceState::Storage,
+                .stateAfter = ResourceState::TransferDst,
+            },
+        });
+    // only the transforms change, the rest of each InstanceInfo stays as it was written in the constructor
+    auto gpuAlloc = gfxDevice.allocateStagingData(movedInstances.size() * sizeof(Affine3x4));
+    auto* transforms = static_cast<Affine3x4*>(gpuAlloc.ptr);
+    movedInstanceCopies.clear();
+    for(size_t i = 0; i < movedInstances.size(); i++)
+    {
+        const auto [instanceIndex, node] = movedInstances[i];
+        transforms[i] = hierarchy.getWorldMatrix(node);
+        movedInstanceCopies.push_back(VkBufferCopy{
+            .srcOffset = gpuAlloc.offset + i * sizeof(Affine3x4),
+            .dstOffset = instanceIndex * sizeof(InstanceInfo) + offsetof(InstanceInfo, transform),
+            .size = sizeof(Affine3x4),
+        });
+    }
+    gfxDevice.copyBuffer(instanceUpdateCmds, gpuAlloc.buffer, gpuInstanceInfoBuffer.buffer, movedInstanceCopies);
+    gfxDevice.insertBarriers(
+        instanceUpdateCmds,
+        {
+            Barrier::FromBuffer{
+                .buffer = gpuInstanceInfoBuffer.buffer,
+                .stateBefore = ResourceState::TransferDst,
+                .stateAfter = ResourceState::Storage,
+            },
+        });
+    gfxDevice.endCommandBuffer(instanceUpdateCmds);
+
+    return instanceUpdateCmds;
 }
\ No newline at end of file
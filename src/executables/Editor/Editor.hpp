@@ -1,11 +1,16 @@
 #pragma once
 
 #include "Scene/Scene.hpp"
+#include <Datastructures/Pool/HandleMap.hpp>
 #include <Datastructures/ThreadPool.hpp>
 #include <ECS/ECS.hpp>
 #include <Engine/Application/Application.hpp>
 #include <Engine/Graphics/Buffer/Buffer.hpp>
 #include <Engine/Graphics/Device/VulkanDevice.hpp>
+#include <Engine/Graphics/DrawList/DrawList.hpp>
+
+struct MeshRenderer;
+struct Transform;
 
 class Editor final : public Application
 {
@@ -19,6 +24,8 @@ class Editor final : public Application
     void update();
 
     VkCommandBuffer updateDirtyMaterialParameters();
+    // copies the transforms of everything Scene::updateTransforms() moved into the InstanceInfo buffer
+    VkCommandBuffer updateMovedInstances();
 
     uint32_t frameNumber = 0xFFFFFFFF;
 
@@ -71,9 +78,101 @@ class Editor final : public Application
     SkyboxTextures
     generateSkyboxTextures(uint32_t hdriCubeRes, uint32_t irradianceRes, uint32_t prefilteredEnvMapBaseSize);
 
-    VkCommandBuffer drawScene(int threadIndex);
+    /*
+        The scene pass gets recorded by several jobs, each into its own command buffer, see RenderingSplit
+        prepareScene() culls and builds the draw list up front and returns into how many parts the pass gets split
+        The first part also records everything in front of the pass (barriers, GPU culling)
+    */
+    uint32_t prepareScene();
+    VkCommandBuffer drawScene(int threadIndex, uint32_t part, uint32_t partCount);
+    // below this many batches per part the job overhead is larger than what recording in parallel saves
+    static constexpr uint32_t minBatchesPerScenePart = 128;
     VkCommandBuffer drawUI(int threadIndex);
 
+    struct DrawObject
+    {
+        MeshRenderer* meshRenderer;
+        const Transform* transform;
+    };
+    // Only used by drawScene(), kept around so the allocations get reused every frame
+    struct CullingData
+    {
+        std::vector<ECS::Entity> visibleEntities;
+        // result, everything that passed the frustum test and everything that never gets culled
+        std::vector<DrawObject> visible;
+    } culling;
+    // Queries the scene for all MeshRenderers inside the camera frustum and fills culling.visible
+    void cullScene();
+
+    // One per visible submesh, with the LOD already picked
+    struct DrawCommand
+    {
+        Material::Handle material;
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        uint32_t instanceIndex;
+    };
+    // Only used by drawScene() as well
+    struct DrawListData
+    {
+        std::vector<DrawCommand> draws;
+        // sorted, see DrawList.hpp
+        std::vector<DrawList::Packet> packets;
+        std::vector<DrawList::Packet> scratch;
+        // instanced draws, their instances are contiguous in the frames instanceIndexBuffer
+        std::vector<DrawList::Batch> batches;
+    } drawList;
+    /*
+        Creates the draws for everything in culling.visible, sorts them to minimize state changes and merges
+        instances of the same mesh, material and LOD into batches
+        Writes the instance indices of all batches into the current frames instanceIndexBuffer
+    */
+    void buildDrawList();
+
+    /*
+        GPU driven alternative to cullScene() + buildDrawList(): Culling/cullInstances.comp frustum culls every
+        submesh and appends the visible ones to the draw commands of their pipeline, each pipeline then gets
+        drawn with a single drawIndirectCount, without the CPU touching individual objects
+        The candidates are created together with the GPU scene and use the transforms from back then
+        Always draws LOD 0, the LOD selection only exists on the CPU side
+    */
+    bool gpuDrivenRendering = false;
+    Handle<ComputeShader> cullInstancesShader;
+    struct GPUCullingData
+    {
+        // see DrawCandidate in Culling/cullInstances.comp
+        struct Candidate
+        {
+            uint32_t instanceIndex;
+            uint32_t group;
+            uint32_t firstCommand;
+            uint32_t firstIndex;
+            uint32_t indexCount;
+            uint32_t cullable;
+        };
+        // candidates of one pipeline, they are contiguous and so are their draw commands
+        struct Group
+        {
+            Material::Handle material;
+            uint32_t firstCandidate;
+            uint32_t candidateCount;
+        };
+        std::vector<Group> groups;
+        uint32_t candidateCount = 0;
+        Buffer::Handle candidateBuffer = Buffer::Handle::Invalid();
+    } gpuCulling;
+    // Needs the instanceBufferIndices of the MeshRenderers, so has to run after building the GPU scene
+    void createCullingCandidates();
+    // Records the culling dispatch and the barriers to consume its results, has to happen outside of rendering
+    void cullOnGPU(VkCommandBuffer cmd);
+    // One drawIndirectCount per group, expects the graphics push constants to point at culledInstanceIndexBuffer
+    void drawGPUCulled(VkCommandBuffer cmd);
+
+    // Entity under the mouse when it was last clicked (without dragging the camera), invalid if nothing got hit
+    ECS::Entity selectedEntity;
+    void updateSelection();
+    void drawSelectionUI();
+
     // TODO: store somewhere else and keep synced with shader code version of struct
     struct RenderPassData
     {
@@ -92,6 +191,22 @@ class Editor final : public Application
         ResourceIndex indexBuffer;
         ResourceIndex positionBuffer;
         ResourceIndex attributeBuffer;
+        // Mesh::VertexEncoding::bits()
+        uint32_t encoding;
+        glm::vec3 positionOffset;
+        glm::vec3 positionScale;
+        glm::vec2 uvOffset;
+        glm::vec2 uvScale;
+        // Meshlets::Meshlet, meshlet vertex indices and packed meshlet triangles, 0xFFFFFFFF if meshletCount is 0
+        uint32_t meshletCount;
+        ResourceIndex meshletBuffer;
+        ResourceIndex meshletVertexBuffer;
+        ResourceIndex meshletTriangleBuffer;
+        // object space
+        glm::vec3 aabbMin;
+        glm::vec3 aabbMax;
+        glm::vec3 sphereCenter;
+        float sphereRadius;
     };
     struct GPUMeshDataBuffer
     {
@@ -99,11 +214,13 @@ class Editor final : public Application
         Buffer::Handle buffer;
         // TODO: bitset and/or full pool logic instead
         uint32_t freeIndex = 0;
+        // index of each meshes GPUMeshData entry inside the buffer
+        HandleMap<Mesh::Handle, uint32_t> meshIndices;
     } gpuMeshDataBuffer;
     struct InstanceInfo
     {
-        glm::mat4 transform;
-        glm::mat4 invTranspTransform;
+        // normals are transformed with the cofactor matrix of the upper 3x3, see Structs.hlsl
+        Affine3x4 transform;
         uint32_t meshDataIndex;
         uint32_t materialIndex;
         ResourceIndex materialParamsBuffer;
@@ -116,6 +233,15 @@ class Editor final : public Application
         // TODO: bitset and/or full pool logic instead
         uint32_t freeIndex = 0;
     } gpuInstanceInfoBuffer;
+    struct MovedInstance
+    {
+        uint32_t instanceIndex;
+        // TransformHierarchy node to take the world matrix from
+        uint32_t node;
+    };
+    // reused every frame by updateMovedInstances(), one copy region per moved instance
+    std::vector<MovedInstance> movedInstances;
+    std::vector<VkBufferCopy> movedInstanceCopies;
 
     struct GraphicsPushConstants
     {
@@ -123,11 +249,23 @@ class Editor final : public Application
         ResourceIndex renderInfoBuffer;
 
         ResourceIndex instanceBuffer;
+        // see DrawListData::batches
+        ResourceIndex instanceIndexBuffer;
     };
 
     struct PerFrameData
     {
         Buffer::Handle renderPassDataBuffer;
+        // every instance gets drawn at most once, so it needs at most gpuInstanceInfoBuffer.limit entries
+        Buffer::Handle instanceIndexBuffer;
+        // used by the GPU driven path, see GPUCullingData
+        Buffer::Handle frustumPlaneBuffer;
+        // VkDrawIndirectCommands, one per candidate
+        Buffer::Handle drawCommandBuffer;
+        // one per group, zeroed by the CPU every frame
+        Buffer::Handle drawCountBuffer;
+        // like instanceIndexBuffer, but written by the culling shader
+        Buffer::Handle culledInstanceIndexBuffer;
     };
 
     PerFrameData perFrameData[VulkanDevice::FRAMES_IN_FLIGHT];
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #include <immintrin.h>
+    #define AFFINE_SSE
+#endif
+
+/*
+    Affine transform stored as the upper 3 rows of a 4x4 matrix, the last row is always (0, 0, 0, 1)
+    48 instead of 64 bytes and the same memory layout as a row_major float3x4 in HLSL,
+    so it can be copied into GPU buffers as is
+*/
+struct Affine3x4
+{
+    glm::vec4 rows[3] = {{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}};
+
+    static Affine3x4 fromMat4(const glm::mat4& mat)
+    {
+        // glm is column major, so the rows are the columns of the transpose
+        const glm::mat4 transposed = glm::transpose(mat);
+        return {.rows = {transposed[0], transposed[1], transposed[2]}};
+    }
+
+    [[nodiscard]] glm::mat4 toMat4() const
+    {
+        return glm::transpose(glm::mat4{rows[0], rows[1], rows[2], glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}});
+    }
+
+    [[nodiscard]] glm::vec3 getTranslation() const { return {rows[0].w, rows[1].w, rows[2].w}; }
+
+    // largest factor any length gets scaled by (exact without shear)
+    [[nodiscard]] float getMaxScale() const
+    {
+        const glm::vec3 x{rows[0].x, rows[1].x, rows[2].x};
+        const glm::vec3 y{rows[0].y, rows[1].y, rows[2].y};
+        const glm::vec3 z{rows[0].z, rows[1].z, rows[2].z};
+        return glm::sqrt(glm::max(glm::dot(x, x), glm::max(glm::dot(y, y), glm::dot(z, z))));
+    }
+
+    [[nodiscard]] glm::vec3 transformPoint(const glm::vec3& point) const
+    {
+        const glm::vec4 p{point, 1.0f};
+        return {glm::dot(rows[0], p), glm::dot(rows[1], p), glm::dot(rows[2], p)};
+    }
+
+    bool operator==(const Affine3x4&) const = default;
+};
+
+inline Affine3x4 operator*(const Affine3x4& lhs, const Affine3x4& rhs)
+{
+    Affine3x4 result;
+#ifdef AFFINE_SSE
+    const __m128 r0 = _mm_loadu_ps(&rhs.rows[0].x);
+    const __m128 r1 = _mm_loadu_ps(&rhs.rows[1].x);
+    const __m128 r2 = _mm_loadu_ps(&rhs.rows[2].x);
+    const __m128 r3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    for(int i = 0; i < 3; i++)
+    {
+        // result row i = sum over k of lhs[i][k] * rhs row k
+        const __m128 l = _mm_loadu_ps(&lhs.rows[i].x);
+        __m128 row = _mm_mul_ps(_mm_shuffle_ps(l, l, _MM_SHUFFLE(0, 0, 0, 0)), r0);
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(l, l, _MM_SHUFFLE(1, 1, 1, 1)), r1));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(l, l, _MM_SHUFFLE(2, 2, 2, 2)), r2));
+        row = _mm_add_ps(row, _mm_mul_ps(_mm_shuffle_ps(l, l, _MM_SHUFFLE(3, 3, 3, 3)), r3));
+        _mm_storeu_ps(&result.rows[i].x, row);
+    }
+#else
+    for(int i = 0; i < 3; i++)
+    {
+        const glm::vec4& l = lhs.rows[i];
+        result.rows[i] = l.x * rhs.rows[0] + l.y * rhs.rows[1] + l.z * rhs.rows[2];
+        result.rows[i].w += l.w;
+    }
+#endif
+    return result;
+}
@@ -1,13 +1,98 @@
 #include "DefaultComponents.hpp"
+#include "TransformHierarchy.hpp"
 
+#include <Engine/Graphics/Culling/BVH.hpp>
+#include <Engine/ResourceManager/ResourceManager.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/euler_angles.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
 
-void Transform::calculateLocalTransformMatrix()
+Affine3x4 Transform::calculateLocalTransform()
 {
-    localTransform =               //
-        glm::translate(position) * //
-        glm::toMat4(orientation) * //
-        glm::scale(scale);
-}
\ No newline at end of file
+    // translate * rotate * scale, built directly instead of multiplying full 4x4 matrices
+    const glm::mat3 rotation = glm::mat3_cast(orientation);
+    const glm::mat3 rotationScale{rotation[0] * scale.x, rotation[1] * scale.y, rotation[2] * scale.z};
+    dirty = false;
+    return Affine3x4{
+        .rows =
+            {
+                glm::vec4{rotationScale[0][0], rotationScale[1][0], rotationScale[2][0], position.x},
+                glm::vec4{rotationScale[0][1], rotationScale[1][1], rotationScale[2][1], position.y},
+                glm::vec4{rotationScale[0][2], rotationScale[1][2], rotationScale[2][2], position.z},
+            },
+    };
+}
+
+void Transform::setPosition(const glm::vec3& newPosition)
+{
+    position = newPosition;
+    markDirty();
+}
+
+void Transform::setScale(const glm::vec3& newScale)
+{
+    scale = newScale;
+    markDirty();
+}
+
+void Transform::setOrientation(const glm::quat& newOrientation)
+{
+    orientation = newOrientation;
+    markDirty();
+}
+
+void Transform::markDirty()
+{
+    // only the first change per update needs to be reported
+    if(dirty)
+        return;
+    dirty = true;
+    if(hierarchy != nullptr)
+        hierarchy->markLocalChanged(hierarchyIndex);
+}
+
+void MeshRenderer::updateLocalBounds()
+{
+    auto* rm = ResourceManager::impl();
+    localBounds = {};
+    localSphere = {};
+    for(const Mesh::Handle subMesh : subMeshes)
+    {
+        if(!subMesh.isNonNull())
+            break;
+        const Mesh::RenderData& renderData = *rm->get<Mesh::RenderData>(subMesh);
+        localBounds.merge(renderData.aabb);
+        localSphere.merge(renderData.boundingSphere);
+    }
+}
+
+void MeshRenderer::updateWorldBounds(const Affine3x4& localToWorld)
+{
+    worldBounds = {};
+    worldSphere = {};
+    if(localBounds.isEmpty())
+        return;
+
+    // transform the center and project the extents onto the world axes (Arvo, Graphics Gems 1990)
+    const glm::vec3 min = glm::make_vec3(localBounds.min);
+    const glm::vec3 max = glm::make_vec3(localBounds.max);
+    const glm::vec3 center = localToWorld.transformPoint((min + max) * 0.5f);
+    const glm::vec3 extent = (max - min) * 0.5f;
+    for(int i = 0; i < 3; i++)
+    {
+        const glm::vec3 row{localToWorld.rows[i]};
+        const float worldExtent = glm::dot(glm::abs(row), extent);
+        worldBounds.min[i] = center[i] - worldExtent;
+        worldBounds.max[i] = center[i] + worldExtent;
+    }
+
+    const glm::vec3 sphereCenter = localToWorld.transformPoint(glm::make_vec3(localSphere.center));
+    worldSphere = {
+        .center = {sphereCenter.x, sphereCenter.y, sphereCenter.z},
+        .radius = localSphere.radius * localToWorld.getMaxScale(),
+    };
+
+    if(bvh != nullptr)
+        bvh->updateItem(bvhItem, worldBounds);
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "Affine.hpp"
+
+#include <Datastructures/InlineVector.hpp>
 #include <Datastructures/Pool/Pool.hpp>
 #include <ECS/ECS.hpp>
 #include <Engine/Graphics/Material/Material.hpp>
@@ -8,23 +11,52 @@
 #include <glm/gtc/quaternion.hpp>
 #include <vector>
 
+class TransformHierarchy;
+class BVH;
+
+/*
+    position, scale and orientation can only be changed through the setters, which mark the transform as dirty
+    Dirty transforms get picked up by Scene::updateTransforms(), which recalculates the local transform and the
+    localToWorld matrices of the transform and all its descendants
+    The setters are not thread safe (they may append to the hierarchy's list of changed nodes)!
+*/
 struct Transform
 {
+    [[nodiscard]] const glm::vec3& getPosition() const { return position; }
+    [[nodiscard]] const glm::vec3& getScale() const { return scale; }
+    [[nodiscard]] const glm::quat& getOrientation() const { return orientation; }
+    [[nodiscard]] bool isDirty() const { return dirty; }
+
+    void setPosition(const glm::vec3& newPosition);
+    void setScale(const glm::vec3& newScale);
+    void setOrientation(const glm::quat& newOrientation);
+
+    // Only up to date after Scene::updateTransforms()
+    Affine3x4 localToWorld;
+
+    // calculates the local transform from position, scale & orientation and clears the dirty flag
+    Affine3x4 calculateLocalTransform();
+
+  private:
+    void markDirty();
+
     glm::vec3 position{0.f, 0.f, 0.f};
     glm::vec3 scale{1.0f, 1.0f, 1.0f};
-    glm::quat orientation;
-
-    glm::mat4 localTransform{1.0f};
+    glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
 
-    glm::mat4 localToWorld{1.0f};
+    bool dirty = true;
+    // set when the Scene's TransformHierarchy gets rebuilt
+    TransformHierarchy* hierarchy = nullptr;
+    uint32_t hierarchyIndex = 0xFFFFFFFF;
 
-    void calculateLocalTransformMatrix();
+    friend TransformHierarchy;
 };
 
 struct Hierarchy
 {
     ECS::Entity parent;
-    std::vector<ECS::Entity> children;
+    // most nodes only have a few children, avoids a heap allocation per entity
+    InlineVector<ECS::Entity, 4> children;
 };
 
 // TODO: where to put this
@@ -48,4 +80,28 @@ struct MeshRenderer
     // GPU Render item info
     std::array<uint32_t, Mesh::MAX_SUBMESHES> instanceBufferIndices =
         FilledArray<uint32_t, Mesh::MAX_SUBMESHES>(0xFFFFFFFF);
+
+    // the skybox for example has to be drawn no matter where its bounds are
+    // Changing it after the entity is in the hierarchy needs a Scene::markBVHStale()
+    bool frustumCulled = true;
+
+    // object space, of all submeshes together
+    Bounds::AABB localBounds;
+    Bounds::Sphere localSphere;
+    // Only up to date after Scene::updateTransforms(), just like Transform::localToWorld
+    Bounds::AABB worldBounds;
+    Bounds::Sphere worldSphere;
+
+    /*
+        Needs to be called after changing subMeshes
+        The world bounds follow along with the next Scene::updateTransforms(), but only if the Transform changed,
+        so call updateWorldBounds() as well otherwise
+    */
+    void updateLocalBounds();
+    // Also passes the new bounds on to the Scene's BVH, which picks them up in its next refit
+    void updateWorldBounds(const Affine3x4& localToWorld);
+
+    // set when the Scene's BVH gets rebuilt, stays null for MeshRenderers that dont get frustum culled
+    BVH* bvh = nullptr;
+    uint32_t bvhItem = 0xFFFFFFFF;
 };
\ No newline at end of file
@@ -2,6 +2,10 @@
 
 #include "DefaultComponents.hpp"
 
+#include <Engine/ResourceManager/ResourceManager.hpp>
+#include <cassert>
+#include <tracy/Tracy.hpp>
+
 Scene::Scene() : root(ECS::impl()->createEntity())
 {
     auto& ecs = *ECS::impl();
@@ -20,6 +24,217 @@ ECS::Entity Scene::createEntity(ECS::Entity parent)
     ECS::Entity newEntt = ECS::impl()->createEntity();
     newEntt.addComponent<Transform>();
     newEntt.addComponent<Hierarchy>(parent);
+    parent.getComponent<Hierarchy>()->children.push_back(newEntt);
+    hierarchyChanged = true;
 
     return newEntt;
-}
\ No newline at end of file
+}
+
+void Scene::load(
+    std::string path,
+    ECS* ecs,
+    ECS::Entity parent,
+    ThreadPool* threadPool,
+    const ImportSettings& settings)
+{
+    ZoneScoped;
+
+    const std::string cachePath = SceneCache::cachePathFor(path);
+    // a cache written with different import settings is stale as well
+    const uint64_t importSettings = settings.cacheKey();
+    {
+        const SceneCache::Reader cache{path, cachePath, importSettings};
+        if(cache.isValid())
+        {
+            loadCached(cache, ecs, parent, settings.vertexEncoding);
+            return;
+        }
+    }
+    SceneCache::Writer cacheWriter{path, cachePath, importSettings};
+    loadglTF(path, ecs, parent, threadPool, settings, cacheWriter);
+}
+
+uint64_t Scene::ImportSettings::cacheKey() const
+{
+    // MeshOptimize::Options::key() only uses bits 0-2 and the upper half
+    const uint64_t key = meshOptimization.key() | uint64_t(buildMeshlets) << 3;
+    return key * 0x9E3779B97F4A7C15ull ^ lods.key();
+}
+
+void Scene::instantiate(
+    Span<const SceneCache::Material> materials,
+    Span<const SceneCache::Node> nodes,
+    const std::vector<std::array<Mesh::Handle, Mesh::MAX_SUBMESHES>>& meshes,
+    const std::vector<Texture::Handle>& textures,
+    ECS* ecs,
+    ECS::Entity parent)
+{
+    ZoneScoped;
+    auto* rm = ResourceManager::impl();
+
+    // Create material instances
+    std::vector<MaterialInstance::Handle> materialInstances;
+    materialInstances.reserve(materials.size());
+    auto basicPBRMaterial = rm->getMaterial("PBRBasic");
+    assert(rm->get<std::string>(basicPBRMaterial) != nullptr);
+    for(const SceneCache::Material& material : materials)
+    {
+        auto matInst = rm->createMaterialInstance(basicPBRMaterial);
+
+        const auto setSlot = [&](const std::string& prefix, const SceneCache::TextureSlot& slot)
+        {
+            if(slot.texture == SceneCache::noIndex)
+            {
+                MaterialInstance::setResource(matInst, prefix + "Texture", 0xFFFFFFFF);
+                return;
+            }
+            assert(slot.texture < textures.size());
+            MaterialInstance::setResource(
+                matInst, prefix + "Texture", *rm->get<ResourceIndex>(textures[slot.texture]));
+            MaterialInstance::setValue<uint32_t>(matInst, prefix + "UVSet", slot.uvSet);
+            MaterialInstance::setValue<glm::vec4>(matInst, prefix + "TexOffsetScale", slot.offsetScale);
+        };
+        setSlot("baseColor", material.baseColor);
+        setSlot("normal", material.normal);
+        setSlot("metalRough", material.metalRough);
+        setSlot("occlusion", material.occlusion);
+        MaterialInstance::setValue<float>(matInst, "metallicFactor", material.metallicFactor);
+        MaterialInstance::setValue<float>(matInst, "roughnessFactor", material.roughnessFactor);
+
+        materialInstances.push_back(matInst);
+    }
+
+    // Create all nodes, parents always come first so they can be linked right away
+    std::vector<ECS::Entity> entities;
+    entities.reserve(nodes.size());
+    for(const SceneCache::Node& node : nodes)
+    {
+        ECS::Entity& entity = entities.emplace_back(ecs->createEntity());
+
+        auto* transform = entity.addComponent<Transform>();
+        transform->setPosition(node.translation);
+        transform->setOrientation(node.orientation);
+        transform->setScale(node.scale);
+
+        if(node.mesh != SceneCache::noIndex)
+        {
+            assert(node.mesh < meshes.size());
+            auto* renderInfo = entity.addComponent<MeshRenderer>();
+            renderInfo->subMeshes = meshes[node.mesh];
+            for(int i = 0; i < Mesh::MAX_SUBMESHES; i++)
+            {
+                if(node.materials[i] != SceneCache::noIndex)
+                    renderInfo->materialInstances[i] = materialInstances[node.materials[i]];
+            }
+            renderInfo->updateLocalBounds();
+        }
+
+        auto* hierarchy = entity.addComponent<Hierarchy>();
+        assert(node.parent == SceneCache::noIndex || node.parent < entities.size() - 1);
+        hierarchy->parent = node.parent == SceneCache::noIndex ? parent : entities[node.parent];
+        hierarchy->parent.getComponent<Hierarchy>()->children.push_back(entity);
+    }
+
+    markHierarchyChanged();
+    updateTransforms();
+}
+
+void Scene::markHierarchyChanged() { hierarchyChanged = true; }
+
+void Scene::markBVHStale() { bvhStale = true; }
+
+void Scene::updateTransforms()
+{
+    ZoneScoped;
+
+    if(hierarchyChanged)
+    {
+        // the old items might not match the new entities, MeshRenderers must not report to them while updating
+        unlinkBVH();
+        bvhStale = true;
+        transformHierarchy.rebuild(root);
+        hierarchyChanged = false;
+    }
+    transformHierarchy.update();
+
+    if(bvhStale)
+        rebuildBVH();
+    else
+        bvh.refit();
+}
+
+void Scene::unlinkBVH()
+{
+    for(ECS::Entity entity : bvhEntities)
+    {
+        if(auto* meshRenderer = entity.getComponent<MeshRenderer>())
+            meshRenderer->bvh = nullptr;
+    }
+    bvhEntities.clear();
+    unculledEntities.clear();
+    bvh.clear();
+}
+
+void Scene::rebuildBVH()
+{
+    ZoneScoped;
+
+    unlinkBVH();
+
+    std::vector<Bounds::AABB> bounds;
+    for(uint32_t node = 0; node < transformHierarchy.size(); node++)
+    {
+        ECS::Entity entity = transformHierarchy.getEntity(node);
+        auto* meshRenderer = entity.getComponent<MeshRenderer>();
+        if(meshRenderer == nullptr)
+            continue;
+        if(!meshRenderer->frustumCulled)
+        {
+            unculledEntities.push_back(entity);
+            continue;
+        }
+        meshRenderer->bvh = &bvh;
+        meshRenderer->bvhItem = static_cast<uint32_t>(bvhEntities.size());
+        bvhEntities.push_back(entity);
+        bounds.push_back(meshRenderer->worldBounds);
+    }
+    bvh.build(bounds);
+    bvhStale = false;
+}
+
+void Scene::queryVisible(const Culling::Frustum& frustum, std::vector<ECS::Entity>& result)
+{
+    ZoneScoped;
+    queryItems.clear();
+    bvh.queryFrustum(frustum, queryItems);
+    for(const uint32_t item : queryItems)
+        result.push_back(bvhEntities[item]);
+    result.insert(result.end(), unculledEntities.begin(), unculledEntities.end());
+}
+
+void Scene::queryAABB(const Bounds::AABB& box, std::vector<ECS::Entity>& result)
+{
+    queryItems.clear();
+    bvh.queryAABB(box, queryItems);
+    for(const uint32_t item : queryItems)
+        result.push_back(bvhEntities[item]);
+}
+
+void Scene::querySphere(const glm::vec3& center, float radius, std::vector<ECS::Entity>& result)
+{
+    queryItems.clear();
+    const float sphereCenter[3] = {center.x, center.y, center.z};
+    bvh.querySphere(sphereCenter, radius, queryItems);
+    for(const uint32_t item : queryItems)
+        result.push_back(bvhEntities[item]);
+}
+
+ECS::Entity Scene::raycast(const glm::vec3& origin, const glm::vec3& direction, float* distance) const
+{
+    const float rayOrigin[3] = {origin.x, origin.y, origin.z};
+    const float rayDirection[3] = {direction.x, direction.y, direction.z};
+    const BVH::RayHit hit = bvh.raycast(rayOrigin, rayDirection);
+    if(distance != nullptr)
+        *distance = hit.distance;
+    return hit.item == BVH::NoItem ? ECS::Entity{} : bvhEntities[hit.item];
+}
@@ -1,19 +1,114 @@
 #pragma once
 
+#include "SceneCache.hpp"
+#include "TransformHierarchy.hpp"
+
 #include <ECS/ECS.hpp>
+#include <Engine/Graphics/Culling/BVH.hpp>
+#include <Engine/Graphics/Mesh/MeshOptimize.hpp>
+#include <Engine/Graphics/Mesh/Simplify.hpp>
 #include <glm/glm.hpp>
 #include <string>
 
+class ThreadPool;
+
 struct Scene
 {
     ECS::Entity root;
+    TransformHierarchy transformHierarchy;
 
     Scene();
 
     ECS::Entity createEntity();
     ECS::Entity createEntity(ECS::Entity parent);
 
-    static void load(std::string path, ECS* ecs, ECS::Entity parent);
+    struct ImportSettings
+    {
+        // reordering passes, part of the cooked data
+        MeshOptimize::Options meshOptimization;
+        // cluster data for cluster culling/mesh shaders, part of the cooked data
+        bool buildMeshlets = true;
+        // simplified index lists appended after the original ones, part of the cooked data
+        Simplify::LODOptions lods;
+        // applied when uploading, so changing it doesnt invalidate the cooked cache
+        Mesh::VertexEncoding vertexEncoding = Mesh::VertexEncoding::compact();
+
+        // everything that changes the cooked data
+        [[nodiscard]] uint64_t cacheKey() const;
+    };
+
+    /*
+        Loads from the cooked cache next to path if its still up to date, otherwise imports the glTF file
+        and writes the cache for the next time
+        threadPool is used for texture decoding and vertex data conversion
+    */
+    void load(
+        std::string path,
+        ECS* ecs,
+        ECS::Entity parent,
+        ThreadPool* threadPool,
+        const ImportSettings& settings = {});
+
+    // Needs to be called after changing Hierarchy components manually, so the flat hierarchy gets rebuilt
+    void markHierarchyChanged();
+    /*
+        Picks up changed local transforms, recomputes localToWorld of all moved nodes and their descendants
+        and writes the results back into the Transform components and MeshRenderer world bounds
+    */
+    void updateTransforms();
+
+    /*
+        Spatial queries over the world bounds of all MeshRenderers in the hierarchy, backed by a BVH that gets
+        rebuilt together with the hierarchy and refitted in updateTransforms() otherwise
+        So just like the world bounds themselves, the results are only up to date after updateTransforms()
+    */
+    // Appends all MeshRenderers that are (conservatively) visible, and all that dont get frustum culled at all
+    void queryVisible(const Culling::Frustum& frustum, std::vector<ECS::Entity>& result);
+    void queryAABB(const Bounds::AABB& box, std::vector<ECS::Entity>& result);
+    void querySphere(const glm::vec3& center, float radius, std::vector<ECS::Entity>& result);
+    /*
+        MeshRenderer with the closest bounds along the ray, or an invalid Entity
+        TODO: bounds only for now, intersecting the actual triangles needs a CPU copy of the mesh data
+    */
+    ECS::Entity raycast(const glm::vec3& origin, const glm::vec3& direction, float* distance = nullptr) const;
+    // Forces a rebuild with the next updateTransforms(), the refitted tree gets worse after a lot of movement
+    void markBVHStale();
+
+  private:
+    void loadglTF(
+        const std::string& path,
+        ECS* ecs,
+        ECS::Entity parent,
+        ThreadPool* threadPool,
+        const ImportSettings& settings,
+        SceneCache::Writer& cacheWriter);
+    void loadCached(
+        const SceneCache::Reader& cache,
+        ECS* ecs,
+        ECS::Entity parent,
+        const Mesh::VertexEncoding& vertexEncoding);
+
+    // Last step of both load paths, creates the material instances and node entities
+    void instantiate(
+        Span<const SceneCache::Material> materials,
+        Span<const SceneCache::Node> nodes,
+        const std::vector<std::array<Mesh::Handle, Mesh::MAX_SUBMESHES>>& meshes,
+        const std::vector<Texture::Handle>& textures,
+        ECS* ecs,
+        ECS::Entity parent);
+
+    void unlinkBVH();
+    // Builds from the current world bounds of all MeshRenderers in the hierarchy and links them to their items
+    void rebuildBVH();
+
+    bool hierarchyChanged = true;
+    bool bvhStale = true;
 
-    static void updateTransformHierarchy(ECS::Entity entity, glm::mat4 parentToWorld);
+    BVH bvh;
+    // BVH item -> entity
+    std::vector<ECS::Entity> bvhEntities;
+    // MeshRenderers that have frustumCulled turned off, returned by every queryVisible()
+    std::vector<ECS::Entity> unculledEntities;
+    // reused between queries
+    std::vector<uint32_t> queryItems;
 };
\ No newline at end of file
@@ -0,0 +1,422 @@
+#include "SceneCache.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <system_error>
+#include <type_traits>
+
+namespace
+{
+    constexpr uint32_t magic = 0x4B4F4F43; // "COOK"
+    // all blobs and tables start at multiples of this, so they can be used in place
+    constexpr uint64_t blobAlignment = 16;
+
+    struct Table
+    {
+        uint64_t offset = 0;
+        uint64_t count = 0;
+    };
+
+    struct Header
+    {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t sourceSize = 0;
+        int64_t sourceLastWriteTime = 0;
+        uint64_t sourceHash = 0;
+        uint64_t importSettings = 0;
+        uint32_t meshCount = 0;
+
+        Table dependencies;
+        Table meshes;
+        Table textures;
+        Table samplers;
+        Table materials;
+        Table nodes;
+        Table strings;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header>);
+    static_assert(std::is_trivially_copyable_v<SceneCache::MeshRecord>);
+    static_assert(std::is_trivially_copyable_v<SceneCache::TextureRecord>);
+    static_assert(std::is_trivially_copyable_v<SceneCache::DependencyRecord>);
+    static_assert(std::is_trivially_copyable_v<SceneCache::Material>);
+    static_assert(std::is_trivially_copyable_v<SceneCache::Node>);
+    static_assert(std::is_trivially_copyable_v<Sampler::Info>);
+    static_assert(std::is_trivially_copyable_v<Meshlets::Meshlet>);
+
+    struct FileStamp
+    {
+        uint64_t size = 0;
+        int64_t lastWriteTime = 0;
+        bool exists = false;
+    };
+
+    FileStamp stampOf(const std::string& path)
+    {
+        std::error_code error;
+        FileStamp stamp;
+        stamp.size = std::filesystem::file_size(path, error);
+        if(error)
+            return {};
+        const auto time = std::filesystem::last_write_time(path, error);
+        if(error)
+            return {};
+        stamp.lastWriteTime = time.time_since_epoch().count();
+        stamp.exists = true;
+        return stamp;
+    }
+
+    // Not cryptographic, only needs to detect changes. Works on 8 bytes at a time so even .glb files hash quickly
+    uint64_t hashBytes(Span<const std::byte> bytes)
+    {
+        constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+        uint64_t hash = 0xCBF29CE484222325ull ^ bytes.size();
+        size_t i = 0;
+        for(; i + 8 <= bytes.size(); i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, bytes.data() + i, 8);
+            hash = (hash ^ word) * multiplier;
+            hash ^= hash >> 29;
+        }
+        for(; i < bytes.size(); i++)
+            hash = (hash ^ static_cast<uint64_t>(bytes[i])) * multiplier;
+        return hash;
+    }
+
+    uint64_t hashFile(const std::string& path)
+    {
+        const MappedFile file{path};
+        return file.isOpen() ? hashBytes(file.bytes()) : 0;
+    }
+
+    template <typename T>
+    Span<const T> tableSpan(const MappedFile& file, const Table& table)
+    {
+        if(table.count == 0)
+            return {};
+        return {reinterpret_cast<const T*>(file.data() + table.offset), table.count};
+    }
+
+    // written so huge offsets and counts from a corrupt file cant overflow
+    bool blobInBounds(const MappedFile& file, uint64_t offset, uint64_t count, size_t elementSize)
+    {
+        return offset % blobAlignment == 0 && offset <= file.size() &&
+               count <= (file.size() - offset) / elementSize;
+    }
+
+    bool tableInBounds(const MappedFile& file, const Table& table, size_t elementSize)
+    {
+        return blobInBounds(file, table.offset, table.count, elementSize);
+    }
+
+    bool stringInBounds(SceneCache::StringRef ref, size_t stringTableSize)
+    {
+        return ref.offset <= stringTableSize && ref.length <= stringTableSize - ref.offset;
+    }
+
+    // for references that may be left empty
+    bool optionalIndexInBounds(uint32_t index, size_t count)
+    {
+        return index == SceneCache::noIndex || index < count;
+    }
+
+    bool recordInBounds(const MappedFile& file, const SceneCache::MeshRecord& record)
+    {
+        if(record.lodCount > Mesh::MAX_LODS)
+            return false;
+        for(const Mesh::LOD& lod : Span<const Mesh::LOD>{record.lods.data(), record.lodCount})
+        {
+            if(lod.indexOffset > record.indexCount || lod.indexCount > record.indexCount - lod.indexOffset)
+                return false;
+        }
+        const Mesh::VertexAttributeFormat attribFormat{.additionalUVCount = record.additionalUVCount};
+        return blobInBounds(file, record.positions, record.vertexCount, sizeof(Mesh::PositionType)) &&
+               blobInBounds(file, record.attributes, record.vertexCount, attribFormat.combinedSize()) &&
+               blobInBounds(file, record.indices, record.indexCount, sizeof(uint32_t)) &&
+               blobInBounds(file, record.meshlets, record.meshletCount, sizeof(Meshlets::Meshlet)) &&
+               blobInBounds(file, record.meshletVertices, record.meshletVertexCount, sizeof(uint32_t)) &&
+               blobInBounds(file, record.meshletTriangles, record.meshletTriangleCount, sizeof(uint32_t));
+    }
+
+    bool recordInBounds(const MappedFile& file, const SceneCache::TextureRecord& record)
+    {
+        return blobInBounds(file, record.pixels, record.pixelsSize, sizeof(std::byte));
+    }
+} // namespace
+
+namespace SceneCache
+{
+    std::string cachePathFor(const std::string& sourcePath) { return sourcePath + ".cooked"; }
+
+    // ------------------- Writer -------------------
+
+    Writer::Writer(const std::string& sourcePath, const std::string& cachePath, uint64_t importSettings)
+        : sourcePath(sourcePath),
+          cachePath(cachePath),
+          tempPath(cachePath + ".tmp"),
+          importSettings(importSettings)
+    {
+        file.open(tempPath, std::ios::binary | std::ios::trunc);
+        // header gets filled in by finish()
+        const Header placeholder{};
+        writeBlob(&placeholder, sizeof(Header));
+    }
+
+    uint64_t Writer::writeBlob(const void* data, size_t size)
+    {
+        const uint64_t aligned = (offset + blobAlignment - 1) / blobAlignment * blobAlignment;
+        constexpr char padding[blobAlignment] = {};
+        file.write(padding, static_cast<std::streamsize>(aligned - offset));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        offset = aligned + size;
+        return aligned;
+    }
+
+    StringRef Writer::addString(std::string_view string)
+    {
+        const StringRef ref{.offset = strings.size(), .length = string.size()};
+        strings += string;
+        return ref;
+    }
+
+    void Writer::addDependency(const std::string& path)
+    {
+        const FileStamp stamp = stampOf(path);
+        dependencies.push_back(DependencyRecord{
+            .path = addString(path),
+            .size = stamp.size,
+            .lastWriteTime = stamp.lastWriteTime,
+        });
+    }
+
+    void Writer::addMesh(
+        uint32_t mesh,
+        uint32_t subMesh,
+        Span<const Mesh::PositionType> positions,
+        Span<const std::byte> attributes,
+        Mesh::VertexAttributeFormat attribFormat,
+        Span<const uint32_t> indices,
+        const Meshlets::View& meshlets,
+        Span<const Mesh::LOD> lods,
+        std::string_view name)
+    {
+        assert(attributes.size() == positions.size() * attribFormat.combinedSize());
+        assert(lods.size() <= Mesh::MAX_LODS);
+        MeshRecord record{
+            .mesh = mesh,
+            .subMesh = subMesh,
+            .additionalUVCount = attribFormat.additionalUVCount,
+            .vertexCount = static_cast<uint32_t>(positions.size()),
+            .indexCount = static_cast<uint32_t>(indices.size()),
+            .meshletCount = static_cast<uint32_t>(meshlets.meshlets.size()),
+            .meshletVertexCount = static_cast<uint32_t>(meshlets.vertices.size()),
+            .meshletTriangleCount = static_cast<uint32_t>(meshlets.triangles.size()),
+            .lodCount = static_cast<uint32_t>(lods.size()),
+            .name = addString(name),
+        };
+        for(int i = 0; i < lods.size(); i++)
+            record.lods[i] = lods[i];
+        record.positions = writeBlob(positions.data(), positions.size() * sizeof(Mesh::PositionType));
+        record.attributes = writeBlob(attributes.data(), attributes.size());
+        record.indices = writeBlob(indices.data(), indices.size() * sizeof(uint32_t));
+        record.meshlets = writeBlob(meshlets.meshlets.data(), record.meshletCount * sizeof(Meshlets::Meshlet));
+        record.meshletVertices = writeBlob(meshlets.vertices.data(), record.meshletVertexCount * sizeof(uint32_t));
+        record.meshletTriangles =
+            writeBlob(meshlets.triangles.data(), record.meshletTriangleCount * sizeof(uint32_t));
+        meshes.push_back(record);
+    }
+
+    void Writer::addTexture(const Texture::CreateInfo& createInfo)
+    {
+        textures.push_back(TextureRecord{
+            .format = createInfo.format,
+            .size = createInfo.size,
+            .mipLevels = createInfo.mipLevels,
+            .name = addString(createInfo.debugName),
+            .pixels = writeBlob(createInfo.initialData.data(), createInfo.initialData.size()),
+            .pixelsSize = createInfo.initialData.size(),
+        });
+    }
+
+    void Writer::addSampler(const Sampler::Info& info) { samplers.push_back(info); }
+
+    void Writer::addMaterial(const Material& material) { materials.push_back(material); }
+
+    void Writer::addNode(const Node& node)
+    {
+        assert(node.parent == noIndex || node.parent < nodes.size());
+        nodes.push_back(node);
+    }
+
+    bool Writer::finish(uint32_t meshCount)
+    {
+        if(!file.is_open())
+            return false;
+
+        const FileStamp sourceStamp = stampOf(sourcePath);
+        Header header{
+            .magic = magic,
+            .version = version,
+            .sourceSize = sourceStamp.size,
+            .sourceLastWriteTime = sourceStamp.lastWriteTime,
+            .sourceHash = hashFile(sourcePath),
+            .importSettings = importSettings,
+            .meshCount = meshCount,
+        };
+        const auto writeTable = [&](const auto& records) -> Table
+        {
+            using T = typename std::remove_cvref_t<decltype(records)>::value_type;
+            return {.offset = writeBlob(records.data(), records.size() * sizeof(T)), .count = records.size()};
+        };
+        header.dependencies = writeTable(dependencies);
+        header.meshes = writeTable(meshes);
+        header.textures = writeTable(textures);
+        header.samplers = writeTable(samplers);
+        header.materials = writeTable(materials);
+        header.nodes = writeTable(nodes);
+        header.strings = writeTable(strings);
+
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.close();
+        if(file.fail())
+            return false;
+
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+        if(error)
+        {
+            std::cout << "Failed to write scene cache: " << cachePath << std::endl;
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+
+    // ------------------- Reader -------------------
+
+    Reader::Reader(const std::string& sourcePath, const std::string& cachePath, uint64_t importSettings)
+        : file(cachePath)
+    {
+        if(!file.isOpen() || file.size() < sizeof(Header))
+            return;
+        Header header;
+        std::memcpy(&header, file.data(), sizeof(Header));
+        if(header.magic != magic || header.version != version || header.importSettings != importSettings)
+            return;
+
+        const Table* tables[] = {
+            &header.dependencies,
+            &header.meshes,
+            &header.textures,
+            &header.samplers,
+            &header.materials,
+            &header.nodes,
+            &header.strings};
+        const size_t elementSizes[] = {
+            sizeof(DependencyRecord),
+            sizeof(MeshRecord),
+            sizeof(TextureRecord),
+            sizeof(Sampler::Info),
+            sizeof(Material),
+            sizeof(Node),
+            sizeof(char)};
+        for(int i = 0; i < std::size(tables); i++)
+        {
+            if(!tableInBounds(file, *tables[i], elementSizes[i]))
+                return;
+        }
+        stringTable = tableSpan<char>(file, header.strings);
+
+        // cheap checks first, only hash the source if its size and timestamp still match
+        const FileStamp sourceStamp = stampOf(sourcePath);
+        if(!sourceStamp.exists || sourceStamp.size != header.sourceSize ||
+           sourceStamp.lastWriteTime != header.sourceLastWriteTime)
+            return;
+        for(const DependencyRecord& dependency : tableSpan<DependencyRecord>(file, header.dependencies))
+        {
+            if(!stringInBounds(dependency.path, stringTable.size()))
+                return;
+            const FileStamp stamp = stampOf(std::string{string(dependency.path)});
+            if(!stamp.exists || stamp.size != dependency.size || stamp.lastWriteTime != dependency.lastWriteTime)
+                return;
+        }
+        if(hashFile(sourcePath) != header.sourceHash)
+            return;
+
+        _meshCount = header.meshCount;
+        meshRecords = tableSpan<MeshRecord>(file, header.meshes);
+        textureRecords = tableSpan<TextureRecord>(file, header.textures);
+        samplerInfos = tableSpan<Sampler::Info>(file, header.samplers);
+        materialRecords = tableSpan<Material>(file, header.materials);
+        nodeRecords = tableSpan<Node>(file, header.nodes);
+
+        /*
+            The records are trusted from here on: at(), meshlets() and string() dont check their ranges again,
+            and Scene::loadCached/instantiate index with them directly
+            glTF meshes have at least one primitive, so meshCount cant be larger than the amount of records
+        */
+        if(_meshCount > meshRecords.size())
+            return;
+        for(const MeshRecord& record : meshRecords)
+        {
+            if(!recordInBounds(file, record) || !stringInBounds(record.name, stringTable.size()) ||
+               record.mesh >= _meshCount || record.subMesh >= Mesh::MAX_SUBMESHES)
+                return;
+        }
+        for(const TextureRecord& record : textureRecords)
+        {
+            if(!recordInBounds(file, record) || !stringInBounds(record.name, stringTable.size()))
+                return;
+        }
+        for(const Material& material : materialRecords)
+        {
+            const TextureSlot* slots[] = {
+                &material.baseColor, &material.normal, &material.metalRough, &material.occlusion};
+            // samplers arent used by Scene::instantiate yet, so only the texture has to be valid
+            for(const TextureSlot* slot : slots)
+            {
+                if(!optionalIndexInBounds(slot->texture, textureRecords.size()))
+                    return;
+            }
+        }
+        for(uint32_t i = 0; i < nodeRecords.size(); i++)
+        {
+            const Node& node = nodeRecords[i];
+            // parents always come before their children
+            if(node.parent != noIndex && node.parent >= i)
+                return;
+            if(!optionalIndexInBounds(node.mesh, _meshCount))
+                return;
+            for(uint32_t material : node.materials)
+            {
+                if(!optionalIndexInBounds(material, materialRecords.size()))
+                    return;
+            }
+        }
+        valid = true;
+    }
+
+    Meshlets::View Reader::meshlets(const MeshRecord& record) const
+    {
+        const auto* meshlets = reinterpret_cast<const Meshlets::Meshlet*>(at(record.meshlets));
+        const auto* vertices = reinterpret_cast<const uint32_t*>(at(record.meshletVertices));
+        const auto* triangles = reinterpret_cast<const uint32_t*>(at(record.meshletTriangles));
+        return {
+            .meshlets = {meshlets, record.meshletCount},
+            .vertices = {vertices, record.meshletVertexCount},
+            .triangles = {triangles, record.meshletTriangleCount},
+        };
+    }
+
+    std::string_view Reader::string(StringRef ref) const
+    {
+        assert(ref.offset + ref.length <= stringTable.size());
+        return {stringTable.data() + ref.offset, ref.length};
+    }
+} // namespace SceneCache
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <Datastructures/Span.hpp>
+#include <Engine/Graphics/Mesh/Mesh.hpp>
+#include <Engine/Graphics/Mesh/Meshlets.hpp>
+#include <Engine/Graphics/Texture/Sampler.hpp>
+#include <Engine/Graphics/Texture/Texture.hpp>
+#include <Engine/Misc/MappedFile.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+    Cooked binary version of an imported scene, written next to the source asset on the first load
+    Contains everything Scene::load needs in its final form:
+        vertex/index data in the Mesh::VertexAttributeFormat layout, with all LODs, and the meshlets built from it
+        decoded texture pixels
+        samplers, material parameters and the node hierarchy
+    Later loads map the file and hand the data to the ResourceManager directly, skipping JSON parsing,
+    vertex conversion and image decoding
+    Invalidated if the format version, the import settings, or the size, timestamp or content hash of any
+    source file changes
+*/
+namespace SceneCache
+{
+    // bump whenever the layout of anything below changes
+    constexpr uint32_t version = 4;
+    constexpr uint32_t noIndex = 0xFFFFFFFF;
+
+    std::string cachePathFor(const std::string& sourcePath);
+
+    // ------------------- Records, stored in the file as is -------------------
+
+    struct TextureSlot
+    {
+        uint32_t texture = noIndex;
+        uint32_t sampler = noIndex;
+        uint32_t uvSet = 0;
+        // xy: offset, zw: scale
+        glm::vec4 offsetScale{0.0f, 0.0f, 1.0f, 1.0f};
+    };
+
+    struct Material
+    {
+        TextureSlot baseColor;
+        TextureSlot normal;
+        TextureSlot metalRough;
+        TextureSlot occlusion;
+        float metallicFactor = 1.0f;
+        float roughnessFactor = 1.0f;
+    };
+
+    struct Node
+    {
+        glm::vec3 translation{0.0f};
+        glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec3 scale{1.0f};
+        // noIndex: child of the entity passed to Scene::load, parents always come before their children
+        uint32_t parent = noIndex;
+        uint32_t mesh = noIndex;
+        std::array<uint32_t, Mesh::MAX_SUBMESHES> materials = {
+            noIndex, noIndex, noIndex, noIndex, noIndex, noIndex};
+    };
+    static_assert(Mesh::MAX_SUBMESHES == 6, "Update the Node::materials initializer");
+
+    // String stored in the string table
+    struct StringRef
+    {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+    };
+
+    struct MeshRecord
+    {
+        uint32_t mesh = 0;
+        uint32_t subMesh = 0;
+        uint32_t additionalUVCount = 0;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint32_t meshletCount = 0;
+        uint32_t meshletVertexCount = 0;
+        uint32_t meshletTriangleCount = 0;
+        uint32_t lodCount = 0;
+        // ranges of the index blob
+        std::array<Mesh::LOD, Mesh::MAX_LODS> lods;
+        StringRef name;
+        // byte offsets into the file
+        uint64_t positions = 0;
+        uint64_t attributes = 0;
+        uint64_t indices = 0;
+        uint64_t meshlets = 0;
+        uint64_t meshletVertices = 0;
+        uint64_t meshletTriangles = 0;
+    };
+
+    struct TextureRecord
+    {
+        Texture::Format format = Texture::Format::UNDEFINED;
+        Texture::Extent size;
+        int32_t mipLevels = 1;
+        StringRef name;
+        uint64_t pixels = 0;
+        uint64_t pixelsSize = 0;
+    };
+
+    struct DependencyRecord
+    {
+        StringRef path;
+        uint64_t size = 0;
+        int64_t lastWriteTime = 0;
+    };
+
+    // ------------------- Writing -------------------
+
+    /*
+        Streams the blobs into a temporary file as they are added, finish() appends the record tables
+        and moves the file into place, so an interrupted import never leaves a half written cache behind
+    */
+    class Writer
+    {
+      public:
+        // importSettings: anything besides the source files that influences the cooked data
+        Writer(const std::string& sourcePath, const std::string& cachePath, uint64_t importSettings);
+
+        [[nodiscard]] bool isOpen() const { return file.is_open(); }
+
+        // files (besides the source itself) that should invalidate the cache when changed
+        void addDependency(const std::string& path);
+        void addMesh(
+            uint32_t mesh,
+            uint32_t subMesh,
+            Span<const Mesh::PositionType> positions,
+            Span<const std::byte> attributes,
+            Mesh::VertexAttributeFormat attribFormat,
+            Span<const uint32_t> indices,
+            const Meshlets::View& meshlets,
+            Span<const Mesh::LOD> lods,
+            std::string_view name);
+        void addTexture(const Texture::CreateInfo& createInfo);
+        void addSampler(const Sampler::Info& info);
+        void addMaterial(const Material& material);
+        void addNode(const Node& node);
+
+        bool finish(uint32_t meshCount);
+
+      private:
+        uint64_t writeBlob(const void* data, size_t size);
+        StringRef addString(std::string_view string);
+
+        std::string sourcePath;
+        std::string cachePath;
+        std::string tempPath;
+        uint64_t importSettings;
+        std::ofstream file;
+        uint64_t offset = 0;
+
+        std::vector<DependencyRecord> dependencies;
+        std::vector<MeshRecord> meshes;
+        std::vector<TextureRecord> textures;
+        std::vector<Sampler::Info> samplers;
+        std::vector<Material> materials;
+        std::vector<Node> nodes;
+        std::string strings;
+    };
+
+    // ------------------- Reading -------------------
+
+    // Read only view of a valid cache file, all spans point into the mapping
+    class Reader
+    {
+      public:
+        // check isValid() afterwards
+        Reader(const std::string& sourcePath, const std::string& cachePath, uint64_t importSettings);
+
+        [[nodiscard]] bool isValid() const { return valid; }
+
+        // amount of meshes, each made up of up to Mesh::MAX_SUBMESHES MeshRecords
+        [[nodiscard]] uint32_t meshCount() const { return _meshCount; }
+        [[nodiscard]] Span<const MeshRecord> meshes() const { return meshRecords; }
+        [[nodiscard]] Span<const TextureRecord> textures() const { return textureRecords; }
+        [[nodiscard]] Span<const Sampler::Info> samplers() const { return samplerInfos; }
+        [[nodiscard]] Span<const Material> materials() const { return materialRecords; }
+        [[nodiscard]] Span<const Node> nodes() const { return nodeRecords; }
+
+        [[nodiscard]] std::string_view string(StringRef ref) const;
+        [[nodiscard]] const std::byte* at(uint64_t offset) const { return file.data() + offset; }
+        [[nodiscard]] Meshlets::View meshlets(const MeshRecord& record) const;
+        [[nodiscard]] static Span<const Mesh::LOD> lods(const MeshRecord& record)
+        {
+            return {record.lods.data(), record.lodCount};
+        }
+
+      private:
+        MappedFile file;
+        bool valid = false;
+        uint32_t _meshCount = 0;
+
+        Span<const MeshRecord> meshRecords;
+        Span<const TextureRecord> textureRecords;
+        Span<const Sampler::Info> samplerInfos;
+        Span<const Material> materialRecords;
+        Span<const Node> nodeRecords;
+        Span<const char> stringTable;
+    };
+} // namespace SceneCache
@@ -0,0 +1,67 @@
+#include "DefaultComponents.hpp"
+#include "Scene.hpp"
+#include "SceneCache.hpp"
+
+#include <cassert>
+#include <Engine/ResourceManager/ResourceManager.hpp>
+#include <tracy/Tracy.hpp>
+#include <tracy/TracyC.h>
+
+void Scene::loadCached(
+    const SceneCache::Reader& cache,
+    ECS* ecs,
+    ECS::Entity parent,
+    const Mesh::VertexEncoding& vertexEncoding)
+{
+    ZoneScopedN("Scene Load Cached");
+    // Everything is already in its final layout, data gets copied straight from the mapping into staging memory
+
+    auto* rm = ResourceManager::impl();
+
+    // samplers arent referenced by the materials yet, but still create them so both paths match
+    for(const Sampler::Info& info : cache.samplers())
+        rm->createSampler(Sampler::Info{info});
+
+    TracyCZoneN(zoneMeshes, "Creating Meshes", true);
+    std::vector<std::array<Mesh::Handle, Mesh::MAX_SUBMESHES>> meshes;
+    meshes.resize(cache.meshCount(), FilledArray<Mesh::Handle, Mesh::MAX_SUBMESHES>(Mesh::Handle::Invalid()));
+    for(const SceneCache::MeshRecord& record : cache.meshes())
+    {
+        assert(record.mesh < meshes.size() && record.subMesh < Mesh::MAX_SUBMESHES);
+        const Mesh::VertexAttributeFormat attribFormat{.additionalUVCount = record.additionalUVCount};
+        // createMesh only reads the attributes, the mapping is read only
+        auto* attributes = const_cast<std::byte*>(cache.at(record.attributes));
+        meshes[record.mesh][record.subMesh] = rm->createMesh(
+            {reinterpret_cast<const Mesh::PositionType*>(cache.at(record.positions)), record.vertexCount},
+            {attributes, record.vertexCount * attribFormat.combinedSize()},
+            attribFormat,
+            {reinterpret_cast<const uint32_t*>(cache.at(record.indices)), record.indexCount},
+            std::string{cache.string(record.name)},
+            vertexEncoding,
+            cache.meshlets(record),
+            cache.lods(record));
+    }
+    TracyCZoneEnd(zoneMeshes);
+
+    TracyCZoneN(zoneTextures, "Creating Textures", true);
+    std::vector<Texture::Handle> textures;
+    textures.reserve(cache.textures().size());
+    for(const SceneCache::TextureRecord& record : cache.textures())
+    {
+        // same as above, initialData is only read
+        auto* pixels = reinterpret_cast<uint8_t*>(const_cast<std::byte*>(cache.at(record.pixels)));
+        textures.push_back(rm->createTexture(Texture::CreateInfo{
+            .debugName = std::string{cache.string(record.name)},
+            .format = record.format,
+            .allStates = ResourceState::SampleSource,
+            .initialState = ResourceState::SampleSource,
+            .size = record.size,
+            .mipLevels = record.mipLevels,
+            .initialData = {pixels, record.pixelsSize},
+            .fillMipLevels = true,
+        }));
+    }
+    TracyCZoneEnd(zoneTextures);
+
+    instantiate(cache.materials(), cache.nodes(), meshes, textures, ecs, parent);
+}
@@ -4,22 +4,254 @@
 #include "glTF/glTFtoTI.hpp"
 
 #include <Datastructures/Pool/Pool.hpp>
+#include <Datastructures/StridedSpan.hpp>
+#include <Datastructures/ThreadPool.hpp>
 #include <Engine/Application/Application.hpp>
+#include <Engine/Graphics/Mesh/AttributeDecode.hpp>
+#include <Engine/Graphics/Mesh/MeshOptimize.hpp>
+#include <Engine/Graphics/Mesh/Meshlets.hpp>
+#include <Engine/Misc/PathHelpers.hpp>
 #include <Engine/ResourceManager/ResourceManager.hpp>
 #include <cstddef>
 #include <daw/json/daw_json_exception.h>
 #include <filesystem>
-#include <fstream>
+#include <future>
 #include <tracy/Tracy.hpp>
 #include <tracy/TracyC.h>
 #include <vulkan/vulkan_core.h>
 
-void Scene::load(std::string path, ECS* ecs, ECS::Entity parent)
+namespace
 {
-    ZoneScopedN("Scene Load");
+    /*
+        Result of converting one glTF primitive into the unified mesh layout, ready to be passed to createMesh
+        Positions and indices that already are in the right format point directly into the glTF buffers,
+        otherwise they point into the owned vectors (moving this struct keeps them valid, vector moves dont
+        reallocate)
+    */
+    struct PrimitiveData
+    {
+        Span<const Mesh::PositionType> vertexPositions;
+        Span<const uint32_t> indices;
+        std::vector<std::byte> vertexAttributes;
+        Mesh::VertexAttributeFormat attribFormat;
+
+        std::vector<Mesh::PositionType> ownedPositions;
+        std::vector<uint32_t> ownedIndices;
+
+        // empty if disabled in the import settings, only covers LOD 0
+        Meshlets::MeshletData meshlets;
+        // ranges of indices, LOD 0 first
+        std::vector<Mesh::LOD> lods;
+    };
+
+    // one per glTF buffer, see glTF::Asset
+    using BufferList = std::vector<Span<const std::byte>>;
+
+    AttributeDecode::Source
+    getAccessorSource(const glTF::Main& gltf, const BufferList& buffers, const glTF::Accessor& accessor)
+    {
+        const glTF::BufferView& bufferView = gltf.bufferViews[accessor.bufferViewIndex];
+        const Span<const std::byte>& buffer = buffers[bufferView.bufferIndex];
+        const size_t start = size_t(bufferView.byteOffset) + accessor.byteOffset;
+        const AttributeDecode::Source source{
+            .data = buffer.data() + start,
+            .stride = bufferView.byteStride,
+            .count = accessor.count,
+            .componentType = glTF::toEngine::componentType(accessor.componentType),
+            .componentCount = glTF::toEngine::componentCount(accessor.type),
+            .normalized = accessor.normalized.value_or(false),
+        };
+        assert(
+            accessor.count == 0 ||
+            start + (accessor.count - 1) * source.effectiveStride() + source.elementSize() <= buffer.size());
+        return source;
+    }
+
+    // converts the accessor to floats and writes them into the interleaved attribute buffer
+    void decodeIntoAttributes(
+        const AttributeDecode::Source& source,
+        std::vector<std::byte>& attributes,
+        size_t attribStride,
+        size_t offset)
+    {
+        AttributeDecode::toFloat(reinterpret_cast<float*>(attributes.data() + offset), attribStride, source);
+    }
+
+    /*
+        not just using the bufferView/Accessors as defined by gltf
+        instead transforming the data so everything fits a unified mesh layout
+        Only reads from gltf and buffers, so this can run on any thread
+    */
+    PrimitiveData convertPrimitive(
+        const glTF::Main& gltf,
+        const BufferList& buffers,
+        const glTF::Primitive& primitive,
+        const Scene::ImportSettings& settings)
+    {
+        ZoneScopedN("Convert Primitive");
+        const glTF::Accessor& positionAccessor = gltf.accessors[primitive.attributes.positionAccessor];
+        const glTF::Accessor& normalAccessor = gltf.accessors[primitive.attributes.normalAccessor];
+        const glTF::Accessor& uv0Accessor = gltf.accessors[primitive.attributes.uv0Accessor];
+        // todo: load vertex colors (if available)
+        const uint32_t vertexCount = positionAccessor.count;
+        assert(normalAccessor.count == vertexCount);
+        assert(uv0Accessor.count == vertexCount);
+
+        PrimitiveData result;
+        Mesh::VertexAttributeFormat& attribFormat = result.attribFormat;
+        attribFormat.additionalUVCount = 0;
+        const glTF::Accessor* uv1Accessor = nullptr;
+        const glTF::Accessor* uv2Accessor = nullptr;
+        if(primitive.attributes.uv1Accessor.has_value())
+        {
+            attribFormat.additionalUVCount++;
+            uv1Accessor = &gltf.accessors[primitive.attributes.uv1Accessor.value()];
+        }
+        if(primitive.attributes.uv2Accessor.has_value())
+        {
+            attribFormat.additionalUVCount++;
+            uv2Accessor = &gltf.accessors[primitive.attributes.uv2Accessor.value()];
+        }
+
+        /*
+            Positions, normals and uvs are converted to floats, so besides plain floats this also accepts
+            the (normalized) integer formats from KHR_mesh_quantization
+        */
+        const AttributeDecode::Source positions = getAccessorSource(gltf, buffers, positionAccessor);
+        assert(positions.componentCount == 3);
+        if(positions.componentType == AttributeDecode::ComponentType::Float32 &&
+           StridedSpan<const Mesh::PositionType>{positions.data, positions.count, positions.stride}.isContiguous())
+        {
+            // no copy, createMesh reads straight from the mapping into the staging memory
+            result.vertexPositions = {reinterpret_cast<const Mesh::PositionType*>(positions.data), vertexCount};
+        }
+        else
+        {
+            result.ownedPositions.resize(vertexCount);
+            AttributeDecode::toFloat(
+                reinterpret_cast<float*>(result.ownedPositions.data()), sizeof(Mesh::PositionType), positions);
+            result.vertexPositions = result.ownedPositions;
+        }
+
+        // other attributes get interleaved
+        std::vector<std::byte>& vertexAttributes = result.vertexAttributes;
+        const size_t attribStride = attribFormat.combinedSize();
+        vertexAttributes.resize(vertexCount * attribStride);
+
+        const AttributeDecode::Source normals = getAccessorSource(gltf, buffers, normalAccessor);
+        assert(normals.componentCount == 3);
+        decodeIntoAttributes(normals, vertexAttributes, attribStride, attribFormat.normalOffset());
+
+        const glTF::Accessor* uvAccessors[3] = {&uv0Accessor, uv1Accessor, uv2Accessor};
+        for(int uvSet = 0; uvSet < 3 && uvAccessors[uvSet] != nullptr; uvSet++)
+        {
+            const AttributeDecode::Source uvs = getAccessorSource(gltf, buffers, *uvAccessors[uvSet]);
+            assert(uvs.componentCount == 2);
+            assert(uvs.count == vertexCount);
+            decodeIntoAttributes(uvs, vertexAttributes, attribStride, attribFormat.uvOffset(uvSet));
+        }
+
+        if(primitive.indexAccessor.has_value())
+        {
+            const AttributeDecode::Source indices =
+                getAccessorSource(gltf, buffers, gltf.accessors[primitive.indexAccessor.value()]);
+            // indices must be scalar and tightly packed
+            assert(indices.componentCount == 1);
+            assert(indices.stride == 0 || indices.stride == indices.elementSize());
+
+            if(indices.componentType == AttributeDecode::ComponentType::UInt32 &&
+               StridedSpan<const uint32_t>{indices.data, indices.count}.isContiguous())
+            {
+                result.indices = {reinterpret_cast<const uint32_t*>(indices.data), indices.count};
+            }
+            else
+            {
+                result.ownedIndices.resize(indices.count);
+                AttributeDecode::widenIndices(
+                    result.ownedIndices.data(), indices.data, indices.componentType, indices.count);
+            }
+        }
+        else
+        {
+            result.ownedIndices.resize(vertexCount);
+            for(int j = 0; j < vertexCount; j++)
+                result.ownedIndices[j] = j;
+        }
+        if(result.indices.empty())
+            result.indices = result.ownedIndices;
+
+        // Tangents are no longer loaded
+        // ...
+
+        const MeshOptimize::Options& meshOptions = settings.meshOptimization;
+        if(meshOptions.vertexCache || meshOptions.overdraw || meshOptions.vertexFetch)
+        {
+            // reordering is done in place, so the data cant point into the glTF buffers anymore
+            if(result.ownedPositions.empty())
+                result.ownedPositions.assign(result.vertexPositions.begin(), result.vertexPositions.end());
+            if(result.ownedIndices.empty())
+                result.ownedIndices.assign(result.indices.begin(), result.indices.end());
+            MeshOptimize::optimize(
+                meshOptions,
+                result.ownedIndices,
+                {reinterpret_cast<std::byte*>(result.ownedPositions.data()),
+                 result.ownedPositions.size() * sizeof(Mesh::PositionType)},
+                vertexAttributes,
+                attribStride);
+            result.vertexPositions = result.ownedPositions;
+            result.indices = result.ownedIndices;
+        }
+
+        // after the reordering, so the meshlets follow the optimized triangle order
+        if(settings.buildMeshlets)
+        {
+            result.meshlets = Meshlets::build(
+                result.indices.data(),
+                result.indices.size(),
+                reinterpret_cast<const float*>(result.vertexPositions.data()),
+                sizeof(Mesh::PositionType),
+                result.vertexPositions.size());
+        }
+
+        // the LODs get appended to the indices, so they cant point into the glTF buffers anymore either
+        if(result.ownedIndices.empty())
+            result.ownedIndices.assign(result.indices.begin(), result.indices.end());
+        result.lods = Mesh::generateLODs(
+            result.ownedIndices,
+            result.vertexPositions,
+            vertexAttributes,
+            attribFormat,
+            settings.lods,
+            meshOptions.vertexCache);
+        result.indices = result.ownedIndices;
+
+        return result;
+    }
+} // namespace
+
+void Scene::loadglTF(
+    const std::string& path,
+    ECS* ecs,
+    ECS::Entity parent,
+    ThreadPool* threadPool,
+    const ImportSettings& settings,
+    SceneCache::Writer& cacheWriter)
+{
+    ZoneScopedN("Scene Load glTF");
     /*
         todo:
             confirm its actually a gltf file
+
+        The import is split into stages so texture decoding and the vertex data conversion overlap
+        on the threadpool, while everything touching the ResourceManager, the GPU or the ECS is done on
+        this thread in batched commit steps:
+            1. parse the file & map all buffers, create samplers
+            2. queue one conversion job per primitive and one decode job per texture
+            3. create the meshes as soon as their conversion is done (texture decoding still running)
+            4. create the GPU textures as their decoding finishes
+            5. material instances & nodes, then finish the cache file
+        Everything created along the way is also streamed into cacheWriter, see SceneCache.hpp
+        Jobs never wait on other jobs, only this thread waits, so this cant deadlock the pool
     */
 
     auto* rm = ResourceManager::impl();
@@ -27,29 +259,82 @@ void Scene::load(std::string path, ECS* ecs, ECS::Entity parent)
     std::filesystem::path basePath{path};
     basePath = basePath.parent_path();
 
+    // ------------------------ 1. Parse & map buffers ------------------------
+
+    // The asset needs to stay alive until all meshes and textures are created, their data is read directly from it
     TracyCZoneN(zoneParse, "Parsing glTF", true);
-    const glTF::Main gltf = glTF::Main::load(path);
+    const glTF::Asset asset = glTF::Asset::load(path);
+    if(!asset.isValid())
+    {
+        assert(false); // TODO: error handling
+    }
+    const glTF::Main& gltf = asset.main;
     assert(gltf.asset.version == "2.0");
     TracyCZoneEnd(zoneParse);
 
+    // external files can change without the .gltf changing, embedded data is covered by the source hash
+    for(const glTF::Buffer& buffer : gltf.buffers)
+    {
+        if(buffer.uri.has_value() && !buffer.uri.value().starts_with("data:"))
+            cacheWriter.addDependency((basePath / buffer.uri.value()).generic_string());
+    }
+    for(const glTF::Image& image : gltf.images)
+    {
+        if(image.uri.has_value() && !image.uri.value().starts_with("data:"))
+            cacheWriter.addDependency((basePath / image.uri.value()).generic_string());
+    }
+
     // create samplers
     std::vector<Handle<Sampler>> samplers;
     samplers.resize(gltf.samplers.size());
     for(int i = 0; i < gltf.samplers.size(); i++)
     {
         auto& samplerInfo = gltf.samplers[i];
-        samplers[i] = rm->createSampler(Sampler::Info{
+        Sampler::Info info{
             .magFilter = glTF::toEngine::magFilter(samplerInfo.magFilter),
             .minFilter = glTF::toEngine::minFilter(samplerInfo.minFilter),
             .mipMapFilter = glTF::toEngine::mipmapMode(samplerInfo.minFilter),
             .addressModeU = glTF::toEngine::addressMode(samplerInfo.wrapS),
             .addressModeV = glTF::toEngine::addressMode(samplerInfo.wrapT),
-        });
+        };
+        cacheWriter.addSampler(info);
+        samplers[i] = rm->createSampler(std::move(info));
+    }
+
+    // ------------------------ 2. Queue primitive conversion & texture decoding ------------------------
+
+    struct PrimitiveJob
+    {
+        int mesh;
+        int primitive;
+        std::future<PrimitiveData> data;
+    };
+    std::vector<PrimitiveJob> primitiveJobs;
+    for(int i = 0; i < gltf.meshes.size(); i++)
+    {
+        const glTF::Mesh& mesh = gltf.meshes[i];
+
+        if(mesh.primitives.size() > Mesh::MAX_SUBMESHES)
+        {
+            BREAKPOINT;
+            // TODO: warn more than max allowed submeshes
+        }
+
+        for(int prim = 0; prim < glm::min<int>(Mesh::MAX_SUBMESHES, mesh.primitives.size()); prim++)
+        {
+            primitiveJobs.push_back(PrimitiveJob{
+                .mesh = i,
+                .primitive = prim,
+                .data = threadPool->queueJob(
+                    [&gltf, &asset, &settings, &primitive = mesh.primitives[prim]](int threadIndex)
+                    { return convertPrimitive(gltf, asset.buffers, primitive, settings); }),
+            });
+        }
     }
 
-    // Load & create textures ("images" in glTF)
+    // Load textures ("images" in glTF)
+    // Queued after the primitives, since the pool works in FIFO order and the meshes get committed first
     // first find out which textures arent linear (all those that are used as basecolor textures)
-    TracyCZoneN(zoneTextures, "Loading textures", true);
     std::vector<bool> textureIsLinear;
     textureIsLinear.resize(gltf.images.size());
     for(int i = 0; i < textureIsLinear.size(); i++)
@@ -63,451 +348,174 @@ void Scene::load(std::string path, ECS* ecs, ECS::Entity parent)
             gltf.textures[material.pbrMetallicRoughness.baseColorTexture.index];
         textureIsLinear[baseColorTextureGLTF.sourceIndex] = false;
     }
-    std::vector<Texture::Handle> textures;
+    // not resized after this, jobs reference the elements
     std::vector<Texture::LoadInfo> loadInfos;
-    textures.resize(gltf.images.size());
     loadInfos.resize(gltf.images.size());
+    std::vector<std::future<Texture::LoadResult>> textureFutures;
+    textureFutures.reserve(gltf.images.size());
     for(int i = 0; i < gltf.images.size(); i++)
     {
+        const glTF::Image& image = gltf.images[i];
+        // embedded images still get a path, its used for the debug name and to pick the decoder
+        const std::string fileName =
+            asset.images[i].empty()
+                ? image.uri.value()
+                : "image" + std::to_string(i) + (image.mimeType == "image/jpeg" ? ".jpg" : ".png");
         loadInfos[i] = Texture::LoadInfo{
-            .path = (basePath / gltf.images[i].uri).generic_string(),
+            .path = (basePath / fileName).generic_string(),
+            .fileData = asset.images[i],
             .fileDataIsLinear = textureIsLinear[i],
             .mipLevels = Texture::MipLevels::All,
             .fillMipLevels = true,
             .allStates = ResourceState::SampleSource,
             .initialState = ResourceState::SampleSource,
         };
+        textureFutures.emplace_back(threadPool->queueJob(
+            [&loadInfo = loadInfos[i]](int threadIndex)
+            {
+                ZoneScopedN("Decode Texture");
+                Texture::LoadResult result = PathHelpers::extension(loadInfo.path) == ".hdr"
+                                                 ? Texture::loadHDR(loadInfo)
+                                                 : Texture::loadDefault(loadInfo);
+                result.first.debugName = PathHelpers::fileName(loadInfo.path);
+                return result;
+            }));
     }
-    textures = rm->createTextures(loadInfos);
-    TracyCZoneEnd(zoneTextures);
-
-    TracyCZoneN(zoneBuffers, "Loading Buffers", true);
-    // Load buffers (CPU)
-    std::vector<std::vector<char>> buffers;
-    buffers.resize(gltf.buffers.size());
-    for(int i = 0; i < gltf.buffers.size(); i++)
-    {
-        const auto& bufferInfo = gltf.buffers[i];
-        std::filesystem::path bufferPath = basePath / bufferInfo.uri;
 
-        std::ifstream file(bufferPath.c_str(), std::ios::ate | std::ios::binary);
-        if(!file.is_open())
-        {
-            assert(false); // TODO: error handling
-        }
-        std::vector<char>& buffer = buffers[i];
-        auto fileSize = (size_t)file.tellg();
-        assert(fileSize == bufferInfo.byteLength);
-        buffer.resize(fileSize);
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-        file.close();
-        file.seekg(0);
-    }
-    TracyCZoneEnd(zoneBuffers);
+    // ------------------------ 3. Commit meshes ------------------------
 
-    // Load/create Meshes
     TracyCZoneN(zoneMeshes, "Creating Meshes", true);
     std::vector<std::array<Mesh::Handle, Mesh::MAX_SUBMESHES>> meshes;
     meshes.resize(gltf.meshes.size(), FilledArray<Mesh::Handle, Mesh::MAX_SUBMESHES>(Mesh::Handle::Invalid()));
-    for(int i = 0; i < gltf.meshes.size(); i++)
+    for(PrimitiveJob& job : primitiveJobs)
     {
-        // not just using the bufferView/Accessors as defined by gltf
-        // instead transforming the data so everything fits a unified mesh layout
-
-        const glTF::Mesh& mesh = gltf.meshes[i];
-
-        if(mesh.primitives.size() > Mesh::MAX_SUBMESHES)
-        {
-            BREAKPOINT;
-            // TODO: warn more than max allowed submeshes
-        }
-
-        for(int prim = 0; prim < glm::min<int>(Mesh::MAX_SUBMESHES, mesh.primitives.size()); prim++)
-        {
-            const auto& primitive = mesh.primitives[prim];
-
-            const glTF::Accessor& positionAccessor = gltf.accessors[primitive.attributes.positionAccessor];
-            const glTF::Accessor& normalAccessor = gltf.accessors[primitive.attributes.normalAccessor];
-            const glTF::Accessor& uv0Accessor = gltf.accessors[primitive.attributes.uv0Accessor];
-            // todo: load vertex colors (if available)
-            const uint32_t vertexCount = positionAccessor.count;
-            assert(normalAccessor.count == vertexCount);
-            assert(uv0Accessor.count == vertexCount);
-            Mesh::VertexAttributeFormat attribFormat{.additionalUVCount = 0};
-            const glTF::Accessor* uv1Accessor = nullptr;
-            const glTF::Accessor* uv2Accessor = nullptr;
-            if(primitive.attributes.uv1Accessor.has_value())
-            {
-                attribFormat.additionalUVCount++;
-                uv1Accessor = &gltf.accessors[primitive.attributes.uv1Accessor.value()];
-            }
-            if(primitive.attributes.uv2Accessor.has_value())
-            {
-                attribFormat.additionalUVCount++;
-                uv2Accessor = &gltf.accessors[primitive.attributes.uv2Accessor.value()];
-            }
-
-            std::vector<Mesh::PositionType> vertexPositions;
-            vertexPositions.resize(vertexCount);
-            std::vector<std::byte> vertexAttributes;
-            size_t vertexAttributeSize = attribFormat.combinedSize();
-            vertexAttributes.resize(vertexCount * vertexAttributeSize);
-            const size_t attribStride = vertexAttributeSize;
-            const size_t normalOffset = attribFormat.normalOffset();
-            const size_t colorOffset = attribFormat.colorOffset();
-            const size_t uv0Offset = attribFormat.uvOffset(0);
-            const size_t uv1Offset = attribFormat.uvOffset(1);
-            const size_t uv2Offset = attribFormat.uvOffset(2);
-
-            // read positions
-            {
-                const glTF::BufferView& bufferView = gltf.bufferViews[positionAccessor.bufferViewIndex];
-                char* startAddress =
-                    &(buffers[bufferView.bufferIndex][bufferView.byteOffset + positionAccessor.byteOffset]);
-
-                // Position must be of type float3
-                assert(positionAccessor.componentType == glTF::Accessor::f32);
-                assert(positionAccessor.type == glTF::Accessor::vec3);
-                auto effectiveStride = bufferView.byteStride != 0 ? bufferView.byteStride : sizeof(float) * 3;
-
-                for(int j = 0; j < vertexCount; j++)
-                {
-                    vertexPositions[j] = *((glm::vec3*)(startAddress + static_cast<size_t>(j * effectiveStride)));
-                }
-            }
-
-            // read normals
-            {
-                const glTF::Accessor& accessor = normalAccessor;
-                const glTF::BufferView& bufferView = gltf.bufferViews[accessor.bufferViewIndex];
-                char* startAddress =
-                    &(buffers[bufferView.bufferIndex][bufferView.byteOffset + accessor.byteOffset]);
-
-                // normals must be of type float3
-                assert(accessor.componentType == glTF::Accessor::f32);
-                assert(accessor.type == glTF::Accessor::vec3);
-                auto effectiveStride = bufferView.byteStride != 0 ? bufferView.byteStride : sizeof(float) * 3;
-
-                for(int j = 0; j < vertexCount; j++)
-                {
-                    auto* targetAddr = (glm::vec3*)(&(vertexAttributes[j * attribStride + normalOffset]));
-                    *targetAddr = *((glm::vec3*)(startAddress + static_cast<size_t>(j * effectiveStride)));
-                }
-            }
-
-            // read uvs
-            // 0
-            {
-                const glTF::Accessor& accessor = uv0Accessor;
-                const glTF::BufferView& bufferView = gltf.bufferViews[accessor.bufferViewIndex];
-                char* startAddress =
-                    &(buffers[bufferView.bufferIndex][bufferView.byteOffset + accessor.byteOffset]);
-
-                // uvs must be of type float2
-                assert(accessor.componentType == glTF::Accessor::f32);
-                assert(accessor.type == glTF::Accessor::vec2);
-                auto effectiveStride = bufferView.byteStride != 0 ? bufferView.byteStride : sizeof(float) * 2;
-
-                for(int j = 0; j < vertexCount; j++)
-                {
-                    auto* targetAddr = (glm::vec2*)(&(vertexAttributes[j * attribStride + uv0Offset]));
-                    *targetAddr = *((glm::vec2*)(startAddress + static_cast<size_t>(j * effectiveStride)));
-                }
-            }
-            // 1
-            if(uv1Accessor != nullptr)
-            {
-                const glTF::Accessor& accessor = *uv1Accessor;
-                const glTF::BufferView& bufferView = gltf.bufferViews[accessor.bufferViewIndex];
-                char* startAddress =
-                    &(buffers[bufferView.bufferIndex][bufferView.byteOffset + accessor.byteOffset]);
-
-                // uvs must be of type float2
-                assert(accessor.componentType == glTF::Accessor::f32);
-                assert(accessor.type == glTF::Accessor::vec2);
-                auto effectiveStride = bufferView.byteStride != 0 ? bufferView.byteStride : sizeof(float) * 2;
-
-                for(int j = 0; j < vertexCount; j++)
-                {
-                    auto* targetAddr = (glm::vec2*)(&(vertexAttributes[j * attribStride + uv1Offset]));
-                    *targetAddr = *((glm::vec2*)(startAddress + static_cast<size_t>(j * effectiveStride)));
-                }
-            }
-            // 2
-            if(uv2Accessor != nullptr)
-            {
-                const glTF::Accessor& accessor = *uv2Accessor;
-                const glTF::BufferView& bufferView = gltf.bufferViews[accessor.bufferViewIndex];
-                char* startAddress =
-                    &(buffers[bufferView.bufferIndex][bufferView.byteOffset + accessor.byteOffset]);
-
-                // uvs must be of type float2
-                assert(accessor.componentType == glTF::Accessor::f32);
-                assert(accessor.type == glTF::Accessor::vec2);
-                auto effectiveStride = bufferView.byteStride != 0 ? bufferView.byteStride : sizeof(float) * 2;
-
-                for(int j = 0; j < vertexCount; j++)
-                {
-                    auto* targetAddr = (glm::vec2*)(&(vertexAttributes[j * attribStride + uv2Offset]));
-                    *targetAddr = *((glm::vec2*)(startAddress + static_cast<size_t>(j * effectiveStride)));
-                }
-            }
-
-            std::vector<uint32_t> indices;
-            if(primitive.indexAccessor.has_value())
-            {
-                const glTF::Accessor& accessor = gltf.accessors[primitive.indexAccessor.value()];
-                indices.resize(accessor.count);
-
-                const glTF::BufferView& bufferView = gltf.bufferViews[accessor.bufferViewIndex];
-                char* startAddress =
-                    &(buffers[bufferView.bufferIndex][bufferView.byteOffset + accessor.byteOffset]);
-
-                // indices must be scalar
-                assert(accessor.type == glTF::Accessor::scalar);
-                // for mesh attributes this should be != 0
-                //       todo: if some files *do* have stride == 0, need to lookup stride for tight packing from
-                //       size(componentType)*size(type)
-
-                uint32_t byteStride = bufferView.byteStride;
-                assert(byteStride == 0 && "TODO: if not 0");
-
-                if(accessor.componentType == glTF::Accessor::ComponentType::uint16)
-                {
-                    Span<uint16_t> data{(uint16_t*)startAddress, accessor.count};
-                    for(int j = 0; j < accessor.count; j++)
-                    {
-                        indices[j] = data[j];
-                    }
-                }
-                else if(accessor.componentType == glTF::Accessor::ComponentType::uint32)
-                {
-                    Span<uint32_t> data{(uint32_t*)startAddress, accessor.count};
-                    for(int j = 0; j < accessor.count; j++)
-                    {
-                        indices[j] = data[j];
-                    }
-                }
-                else
-                {
-                    assert(false && "TODO? does this even occur?");
-                }
-            }
-            else
-            {
-                indices.resize(vertexAttributes.size());
-                for(int j = 0; j < indices.size(); j++)
-                    indices[j] = j;
-            }
-
-            // Tangents are no longer loaded
-            // ...
-
-            Mesh::Handle newMesh = rm->createMesh(
-                vertexPositions,
-                vertexAttributes,
-                attribFormat,
-                indices,
-                mesh.name + "_sub" + std::to_string(prim));
-            meshes[i][prim] = newMesh;
-        }
+        PrimitiveData data = job.data.get();
+        const std::string name = gltf.meshes[job.mesh].name + "_sub" + std::to_string(job.primitive);
+        cacheWriter.addMesh(
+            job.mesh,
+            job.primitive,
+            data.vertexPositions,
+            data.vertexAttributes,
+            data.attribFormat,
+            data.indices,
+            data.meshlets.view(),
+            data.lods,
+            name);
+        meshes[job.mesh][job.primitive] = rm->createMesh(
+            data.vertexPositions,
+            data.vertexAttributes,
+            data.attribFormat,
+            data.indices,
+            name,
+            settings.vertexEncoding,
+            data.meshlets.view(),
+            data.lods);
     }
     TracyCZoneEnd(zoneMeshes);
 
-    // Create material instances (materials in glTF)
-    std::vector<MaterialInstance::Handle> materialInstances;
-    materialInstances.resize(gltf.materials.size());
-    auto basicPBRMaterial = rm->getMaterial("PBRBasic");
-    assert(rm->get<std::string>(basicPBRMaterial) != nullptr);
-    for(int i = 0; i < gltf.materials.size(); i++)
-    {
-        const glTF::Material& material = gltf.materials[i];
-        auto matInst = rm->createMaterialInstance(basicPBRMaterial);
-
-        const auto loadTextureOffsetScale =
-            [](const glTF::TextureParams& texParams) -> CTuple<glm::vec2, glm::vec2>
-        {
-            if(!texParams.extensions.has_value())
-                return {{0.f, 0.f}, {1.f, 1.f}};
-            const auto& extensions = texParams.extensions.value();
-            if(!extensions.transform.has_value())
-                return {{0.f, 0.f}, {1.f, 1.f}};
-            const auto& transform = extensions.transform.value();
-            return {transform.offset, transform.scale};
-        };
-
-        const glTF::Texture& baseColorTextureGLTF =
-            gltf.textures[material.pbrMetallicRoughness.baseColorTexture.index];
-        const Texture::Handle baseColorTextureHandle = textures[baseColorTextureGLTF.sourceIndex];
-        const Handle<Sampler> baseColorSamplerHandle = samplers[baseColorTextureGLTF.samplerIndex];
-        Sampler* baseColorSampler = rm->get(baseColorSamplerHandle);
-        MaterialInstance::setResource(
-            matInst, "baseColorTexture", *rm->get<ResourceIndex>(baseColorTextureHandle));
-        MaterialInstance::setValue<uint32_t>(
-            matInst, "baseColorUVSet", material.pbrMetallicRoughness.baseColorTexture.uvSet);
-        // MaterialInstance::setResource(matInst, "baseColorSampler", baseColorSampler->sampler.resourceIndex);
-        auto [bcOffset, bcScale] = loadTextureOffsetScale(material.pbrMetallicRoughness.baseColorTexture);
-        MaterialInstance::setValue<glm::vec4>(matInst, "baseColorTexOffsetScale", {bcOffset, bcScale});
-
-        if(material.normalTexture.has_value())
-        {
-            const glTF::Texture& normalTextureGLTF = gltf.textures[material.normalTexture.value().index];
-            const Texture::Handle normalTextureHandle = textures[normalTextureGLTF.sourceIndex];
-            const Handle<Sampler> normalSamplerHandle = samplers[normalTextureGLTF.samplerIndex];
-            Sampler* normalSampler = rm->get(normalSamplerHandle);
-            MaterialInstance::setResource(matInst, "normalTexture", *rm->get<ResourceIndex>(normalTextureHandle));
-            // MaterialInstance::setResource(matInst, "normalSampler", normalSampler->sampler.resourceIndex);
-            MaterialInstance::setValue<uint32_t>(matInst, "normalUVSet", material.normalTexture.value().uvSet);
-            auto [nrmOffset, nrmScale] = loadTextureOffsetScale(material.normalTexture.value());
-            MaterialInstance::setValue<glm::vec4>(matInst, "normalTexOffsetScale", {nrmOffset, nrmScale});
-        }
-        else
-        {
-            MaterialInstance::setResource(matInst, "normalTexture", 0xFFFFFFFF);
-            // MaterialInstance::setResource(matInst, "normalSampler", 0xFFFFFFFF);
-        }
-
-        MaterialInstance::setValue<float>(matInst, "metallicFactor", material.pbrMetallicRoughness.metallicFactor);
-        MaterialInstance::setValue<float>(
-            matInst, "roughnessFactor", material.pbrMetallicRoughness.roughnessFactor);
-
-        if(material.pbrMetallicRoughness.metallicRoughnessTexture.has_value())
-        {
-            const glTF::Texture& metalRoughTextureGLTF =
-                gltf.textures[material.pbrMetallicRoughness.metallicRoughnessTexture.value().index];
-            const Texture::Handle metalRoughTextureHandle = textures[metalRoughTextureGLTF.sourceIndex];
-            const Handle<Sampler> metalRoughSamplerHandle = samplers[metalRoughTextureGLTF.samplerIndex];
-            Sampler* metalRoughSampler = rm->get(metalRoughSamplerHandle);
-            MaterialInstance::setResource(
-                matInst, "metalRoughTexture", *rm->get<ResourceIndex>(metalRoughTextureHandle));
-            // MaterialInstance::setResource(matInst, "metalRoughSampler",
-            // metalRoughSampler->sampler.resourceIndex);
-            MaterialInstance::setValue<uint32_t>(
-                matInst, "metalRoughUVSet", material.pbrMetallicRoughness.metallicRoughnessTexture.value().uvSet);
-            auto [mrOffset, mrScale] =
-                loadTextureOffsetScale(material.pbrMetallicRoughness.metallicRoughnessTexture.value());
-            MaterialInstance::setValue<glm::vec4>(matInst, "metalRoughTexOffsetScale", {mrOffset, mrScale});
-        }
-        else
-        {
-            MaterialInstance::setResource(matInst, "metalRoughTexture", 0xFFFFFFFF);
-            // MaterialInstance::setResource(matInst, "metalRoughSampler", 0xFFFFFFFF);
-        }
-
-        if(material.occlusionTexture.has_value())
-        {
-            const glTF::Texture& occlusionTextureGLTF = gltf.textures[material.occlusionTexture.value().index];
-            const Texture::Handle occlusionTextureHandle = textures[occlusionTextureGLTF.sourceIndex];
-            const Handle<Sampler> occlusionSamplerHandle = samplers[occlusionTextureGLTF.samplerIndex];
-            Sampler* occlusionSampler = rm->get(occlusionSamplerHandle);
-            MaterialInstance::setResource(
-                matInst, "occlusionTexture", *rm->get<ResourceIndex>(occlusionTextureHandle));
-            // MaterialInstance::setResource(matInst, "occlusionSampler", occlusionSampler->sampler.resourceIndex);
-            MaterialInstance::setValue<uint32_t>(
-                matInst, "occlusionUVSet", material.occlusionTexture.value().uvSet);
-            auto [aoOffset, aoScale] = loadTextureOffsetScale(material.occlusionTexture.value());
-            MaterialInstance::setValue<glm::vec4>(matInst, "occlusionTexOffsetScale", {aoOffset, aoScale});
-        }
-        else
-        {
-            MaterialInstance::setResource(matInst, "occlusionTexture", 0xFFFFFFFF);
-            // MaterialInstance::setResource(matInst, "occlusionSampler", 0xFFFFFFFF);
-        }
+    // ------------------------ 4. Commit textures ------------------------
 
-        materialInstances[i] = matInst;
+    TracyCZoneN(zoneTextures, "Creating Textures", true);
+    std::vector<Texture::Handle> textures;
+    textures.resize(gltf.images.size());
+    for(int i = 0; i < textureFutures.size(); i++)
+    {
+        auto [createInfo, cleanup] = textureFutures[i].get();
+        cacheWriter.addTexture(createInfo);
+        textures[i] = rm->createTexture(std::move(createInfo));
+        cleanup();
     }
+    TracyCZoneEnd(zoneTextures);
 
-    std::vector<ECS::Entity> gltfNodes;
-    gltfNodes.reserve(gltf.nodes.size());
+    // ------------------------ 5. Material instances & nodes ------------------------
 
-    // Create all nodes
-    for(int i = 0; i < gltf.nodes.size(); i++)
+    // converted into the cache representation first, so both load paths share the instantiation
+    std::vector<SceneCache::Material> materials;
+    materials.reserve(gltf.materials.size());
+    for(const glTF::Material& material : gltf.materials)
     {
-        const glTF::Node& glTFNode = gltf.nodes[i];
-
-        ECS::Entity& nodeEntity = gltfNodes.emplace_back(ecs->createEntity());
-
-        auto* nodeTransform = nodeEntity.addComponent<Transform>();
-        nodeTransform->position = glTFNode.translation;
-        nodeTransform->orientation = glm::quat{
-            glTFNode.rotationAsVec.w,
-            glTFNode.rotationAsVec.x,
-            glTFNode.rotationAsVec.y,
-            glTFNode.rotationAsVec.z};
-        nodeTransform->scale = glTFNode.scale;
-        nodeTransform->calculateLocalTransformMatrix();
-
-        if(glTFNode.meshIndex.has_value())
+        const auto toSlot = [&](const glTF::TextureParams& texParams) -> SceneCache::TextureSlot
         {
-            auto* renderInfo = nodeEntity.addComponent<MeshRenderer>();
-            const glTF::Mesh& gltfMesh = gltf.meshes[glTFNode.meshIndex.value()];
-            renderInfo->subMeshes = meshes[glTFNode.meshIndex.value()];
-            for(int i = 0; i < gltfMesh.primitives.size(); i++)
+            const glTF::Texture& texture = gltf.textures[texParams.index];
+            SceneCache::TextureSlot slot{
+                .texture = texture.sourceIndex,
+                .sampler = texture.samplerIndex,
+                .uvSet = texParams.uvSet,
+            };
+            if(texParams.extensions.has_value() && texParams.extensions.value().transform.has_value())
             {
-                renderInfo->materialInstances[i] = materialInstances[gltfMesh.primitives[i].materialIndex];
+                const auto& transform = texParams.extensions.value().transform.value();
+                slot.offsetScale = {transform.offset, transform.scale};
             }
-        }
+            return slot;
+        };
 
-        auto* nodeHierarchy = nodeEntity.addComponent<Hierarchy>();
+        const glTF::PBRMetalRoughParams& pbr = material.pbrMetallicRoughness;
+        SceneCache::Material& cooked = materials.emplace_back(SceneCache::Material{
+            .baseColor = toSlot(pbr.baseColorTexture),
+            .metallicFactor = pbr.metallicFactor,
+            .roughnessFactor = pbr.roughnessFactor,
+        });
+        if(material.normalTexture.has_value())
+            cooked.normal = toSlot(material.normalTexture.value());
+        if(pbr.metallicRoughnessTexture.has_value())
+            cooked.metalRough = toSlot(pbr.metallicRoughnessTexture.value());
+        if(material.occlusionTexture.has_value())
+            cooked.occlusion = toSlot(material.occlusionTexture.value());
     }
-    assert(gltfNodes.size() == gltf.nodes.size());
 
-    // link up hierarchies
-    // From scene parents to nodes
-    std::vector<ECS::Entity> sceneRoots;
-    sceneRoots.reserve(gltf.scenes.size());
-    for(int i = 0; i < gltf.scenes.size(); i++)
+    /*
+        Flattened breadth first, starting with one root per glTF scene, so parents always come before
+        their children
+    */
+    std::vector<SceneCache::Node> nodes;
+    nodes.reserve(gltf.scenes.size() + gltf.nodes.size());
+    // (glTF node index, parent index in nodes)
+    std::vector<std::pair<int, uint32_t>> pending;
+    for(const glTF::Scene& scene : gltf.scenes)
     {
-        const glTF::Scene& scene = gltf.scenes[i];
-        ECS::Entity& sceneRoot = sceneRoots.emplace_back(ecs->createEntity());
-        sceneRoot.addComponent<Transform>();
-        auto* rootHierarchy = sceneRoot.addComponent<Hierarchy>();
-        rootHierarchy->parent = parent;
-        parent.getComponent<Hierarchy>()->children.push_back(sceneRoot);
-
+        const auto sceneRoot = uint32_t(nodes.size());
+        nodes.emplace_back();
         for(const int& child : scene.nodeIndices)
-        {
-            ECS::Entity childNode = gltfNodes[child];
-            rootHierarchy->children.push_back(childNode);
-            auto* childHierarchy = childNode.getComponent<Hierarchy>();
-            childHierarchy->parent = sceneRoot;
-        }
+            pending.emplace_back(child, sceneRoot);
     }
-    // From nodes to other nodes
-    for(int i = 0; i < gltf.nodes.size(); i++)
+    for(size_t next = 0; next < pending.size(); next++)
     {
-        const glTF::Node& gltfParent = gltf.nodes[i];
-        ECS::Entity& parentEntity = gltfNodes[i];
-        auto* parentHierarchy = parentEntity.getComponent<Hierarchy>();
-
-        if(gltfParent.childNodeIndices.has_value())
+        const auto [nodeIndex, parentIndex] = pending[next];
+        const glTF::Node& glTFNode = gltf.nodes[nodeIndex];
+
+        const auto cookedIndex = uint32_t(nodes.size());
+        SceneCache::Node& cooked = nodes.emplace_back(SceneCache::Node{
+            .translation = glTFNode.translation,
+            .orientation = glm::quat{
+                glTFNode.rotationAsVec.w,
+                glTFNode.rotationAsVec.x,
+                glTFNode.rotationAsVec.y,
+                glTFNode.rotationAsVec.z},
+            .scale = glTFNode.scale,
+            .parent = parentIndex,
+        });
+        if(glTFNode.meshIndex.has_value())
         {
-            for(const int& child : gltfParent.childNodeIndices.value())
-            {
-                ECS::Entity childEntity = gltfNodes[child];
-                parentHierarchy->children.push_back(childEntity);
-                auto* childHierarchy = childEntity.getComponent<Hierarchy>();
-                childHierarchy->parent = parentEntity;
-            }
+            cooked.mesh = glTFNode.meshIndex.value();
+            const glTF::Mesh& gltfMesh = gltf.meshes[cooked.mesh];
+            for(int i = 0; i < glm::min<int>(Mesh::MAX_SUBMESHES, gltfMesh.primitives.size()); i++)
+                cooked.materials[i] = gltfMesh.primitives[i].materialIndex;
+        }
+        if(glTFNode.childNodeIndices.has_value())
+        {
+            for(const int& child : glTFNode.childNodeIndices.value())
+                pending.emplace_back(child, cookedIndex);
         }
     }
 
-    updateTransformHierarchy(parent, glm::mat4{1.0f});
-    // BREAKPOINT;
-}
-
-void Scene::updateTransformHierarchy(ECS::Entity entity, glm::mat4 parentToWorld)
-{
-    ECS& ecs = *ECS::impl();
-
-    auto* transform = entity.getComponent<Transform>();
-    assert(transform);
-    transform->localToWorld = parentToWorld * transform->localTransform;
+    instantiate(materials, nodes, meshes, textures, ecs, parent);
 
-    auto* hierarchy = entity.getComponent<Hierarchy>();
-    for(ECS::Entity& child : hierarchy->children)
-    {
-        updateTransformHierarchy(child, transform->localToWorld);
-    }
-}
\ No newline at end of file
+    TracyCZoneN(zoneCache, "Writing Scene Cache", true);
+    for(const SceneCache::Material& material : materials)
+        cacheWriter.addMaterial(material);
+    for(const SceneCache::Node& node : nodes)
+        cacheWriter.addNode(node);
+    cacheWriter.finish(gltf.meshes.size());
+    TracyCZoneEnd(zoneCache);
+}
@@ -0,0 +1,154 @@
+#include "TransformHierarchy.hpp"
+#include "DefaultComponents.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <execution>
+#include <ranges>
+#include <tracy/Tracy.hpp>
+
+namespace
+{
+    // Below this amount of nodes in a level the overhead of going wide is larger than the work itself
+    constexpr uint32_t minNodesPerJob = 256;
+} // namespace
+
+void TransformHierarchy::rebuild(ECS::Entity root)
+{
+    ZoneScoped;
+
+    entities.clear();
+    parents.clear();
+    levelOffsets.clear();
+
+    entities.push_back(root);
+    parents.push_back(NoParent);
+    levelOffsets.push_back(0);
+
+    // breadth first, the arrays themselves are used as the queue
+    uint32_t levelBegin = 0;
+    while(levelBegin < entities.size())
+    {
+        const auto levelEnd = static_cast<uint32_t>(entities.size());
+        levelOffsets.push_back(levelEnd);
+        for(uint32_t node = levelBegin; node < levelEnd; node++)
+        {
+            auto* hierarchy = entities[node].getComponent<Hierarchy>();
+            if(hierarchy == nullptr)
+                continue;
+            for(ECS::Entity child : hierarchy->children)
+            {
+                entities.push_back(child);
+                parents.push_back(node);
+            }
+        }
+        levelBegin = levelEnd;
+    }
+
+    const uint32_t nodeCount = size();
+    localMatrices.resize(nodeCount);
+    worldMatrices.resize(nodeCount);
+    dirty.assign(nodeCount, 0);
+    changedNodes.clear();
+
+    for(uint32_t node = 0; node < nodeCount; node++)
+    {
+        auto* transform = entities[node].getComponent<Transform>();
+        assert(transform);
+        transform->hierarchy = this;
+        transform->hierarchyIndex = node;
+        // everything gets recomputed after a rebuild, local matrices are calculated in update()
+        transform->dirty = true;
+        changedNodes.push_back(node);
+    }
+}
+
+void TransformHierarchy::markLocalChanged(uint32_t node)
+{
+    assert(node < size());
+    changedNodes.push_back(node);
+}
+
+uint32_t TransformHierarchy::getLevel(uint32_t node) const
+{
+    // first offset thats larger than node is the start of the next level
+    const auto next = std::upper_bound(levelOffsets.begin(), levelOffsets.end(), node);
+    return static_cast<uint32_t>(std::distance(levelOffsets.begin(), next)) - 1;
+}
+
+void TransformHierarchy::updateRange(uint32_t begin, uint32_t end)
+{
+    for(uint32_t node = begin; node < end; node++)
+    {
+        const uint32_t parent = parents[node];
+        // parents level is already done, so its flag already contains the flags of all its ancestors
+        if(parent != NoParent && dirty[parent])
+            dirty[node] = 1;
+        if(!dirty[node])
+            continue;
+
+        worldMatrices[node] =
+            parent == NoParent ? localMatrices[node] : worldMatrices[parent] * localMatrices[node];
+        // getComponent only reads from the ECS, so this is fine to do from multiple threads
+        entities[node].getComponent<Transform>()->localToWorld = worldMatrices[node];
+        if(auto* meshRenderer = entities[node].getComponent<MeshRenderer>())
+            meshRenderer->updateWorldBounds(worldMatrices[node]);
+    }
+}
+
+void TransformHierarchy::update()
+{
+    ZoneScoped;
+    movedNodes.clear();
+    if(changedNodes.empty())
+        return;
+
+    // levels before this one dont contain any dirty nodes and can be skipped
+    uint32_t firstDirtyLevel = levelCount();
+    for(uint32_t node : changedNodes)
+    {
+        auto* transform = entities[node].getComponent<Transform>();
+        // Transform might not be part of the hierarchy anymore and got the index from an older rebuild
+        if(transform == nullptr || transform->hierarchyIndex != node || !transform->dirty)
+            continue;
+        localMatrices[node] = transform->calculateLocalTransform();
+        dirty[node] = 1;
+        firstDirtyLevel = std::min(firstDirtyLevel, getLevel(node));
+    }
+    changedNodes.clear();
+
+    for(uint32_t level = firstDirtyLevel; level < levelCount(); level++)
+    {
+        const uint32_t levelBegin = levelOffsets[level];
+        const uint32_t levelEnd = levelOffsets[level + 1];
+        const uint32_t levelSize = levelEnd - levelBegin;
+
+        if(levelSize < 2 * minNodesPerJob)
+        {
+            updateRange(levelBegin, levelEnd);
+            continue;
+        }
+
+        const uint32_t jobCount = (levelSize + minNodesPerJob - 1) / minNodesPerJob;
+        std::ranges::iota_view jobs(0u, jobCount);
+        std::for_each(
+            std::execution::par,
+            jobs.begin(),
+            jobs.end(),
+            [&](uint32_t job)
+            {
+                const uint32_t begin = levelBegin + job * minNodesPerJob;
+                updateRange(begin, std::min(begin + minNodesPerJob, levelEnd));
+            });
+    }
+
+    if(firstDirtyLevel < levelCount())
+    {
+        for(uint32_t node = levelOffsets[firstDirtyLevel]; node < size(); node++)
+        {
+            if(dirty[node])
+                movedNodes.push_back(node);
+        }
+        std::fill(dirty.begin() + levelOffsets[firstDirtyLevel], dirty.end(), 0);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Affine.hpp"
+
+#include <ECS/ECS.hpp>
+#include <glm/glm.hpp>
+#include <vector>
+
+/*
+    Flattened copy of the Hierarchy components, used to calculate the localToWorld matrices
+        - nodes are stored breadth first, so all nodes of one depth are next to each other and every parent
+          comes before its children
+        - world matrices are updated one level at a time, nodes inside a level are independent of each other
+          and get processed in parallel
+        - Transforms report changes through markLocalChanged(), only those nodes and their descendants are
+          recomputed and written back, levels above the highest changed node are skipped entirely
+    Any structural change (adding/removing entities, reparenting) requires a rebuild()!
+*/
+class TransformHierarchy
+{
+  public:
+    static constexpr uint32_t NoParent = 0xFFFFFFFF;
+
+    /*
+        Walks the Hierarchy components starting at root and creates the flat arrays
+        Links all reachable Transforms to this hierarchy and marks every node as changed
+    */
+    void rebuild(ECS::Entity root);
+
+    // Called by Transform when it becomes dirty, not thread safe
+    void markLocalChanged(uint32_t node);
+
+    /*
+        Recalculates the local matrices of all changed Transforms, then the world matrices of those nodes
+        and all their descendants, and writes the results back into the Transform components (and the world
+        bounds of MeshRenderers)
+    */
+    void update();
+
+    [[nodiscard]] const Affine3x4& getLocalMatrix(uint32_t node) const { return localMatrices[node]; }
+    [[nodiscard]] const Affine3x4& getWorldMatrix(uint32_t node) const { return worldMatrices[node]; }
+    [[nodiscard]] uint32_t getParent(uint32_t node) const { return parents[node]; }
+    [[nodiscard]] ECS::Entity getEntity(uint32_t node) const { return entities[node]; }
+    [[nodiscard]] uint32_t size() const { return static_cast<uint32_t>(parents.size()); }
+    [[nodiscard]] uint32_t levelCount() const { return static_cast<uint32_t>(levelOffsets.size()) - 1; }
+    // nodes whose world matrix got recomputed by the last update(), in breadth first order
+    [[nodiscard]] const std::vector<uint32_t>& getMovedNodes() const { return movedNodes; }
+
+  private:
+    uint32_t getLevel(uint32_t node) const;
+    void updateRange(uint32_t begin, uint32_t end);
+
+    std::vector<ECS::Entity> entities;
+    std::vector<uint32_t> parents;
+    std::vector<Affine3x4> localMatrices;
+    std::vector<Affine3x4> worldMatrices;
+    // bytes instead of a bitset, so threads can write flags of neighbouring nodes
+    std::vector<uint8_t> dirty;
+    // nodes of level i are [levelOffsets[i], levelOffsets[i+1])
+    std::vector<uint32_t> levelOffsets{0};
+
+    // nodes whose Transform changed since the last update()
+    std::vector<uint32_t> changedNodes;
+    // filled from the dirty flags at the end of update(), so the renderer knows which instances to upload
+    std::vector<uint32_t> movedNodes;
+};
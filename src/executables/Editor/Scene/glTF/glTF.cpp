@@ -1,6 +1,9 @@
 #include "glTFJSON.hpp"
+#include <Engine/Misc/Base64.hpp>
 #include <Engine/Misc/Macros.hpp>
-#include <daw/daw_read_file.h>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
 
 static_assert(glTF::Accessor::getComponentTypeSize(glTF::Accessor::ComponentType::sint8) == 1);
 static_assert(glTF::Accessor::getComponentTypeSize(glTF::Accessor::ComponentType::uint8) == 1);
@@ -9,17 +12,15 @@ static_assert(glTF::Accessor::getComponentTypeSize(glTF::Accessor::ComponentType
 static_assert(glTF::Accessor::getComponentTypeSize(glTF::Accessor::ComponentType::uint32) == 4);
 static_assert(glTF::Accessor::getComponentTypeSize(glTF::Accessor::ComponentType::f32) == 4);
 
-glTF::Main glTF::Main::load(std::string path)
+glTF::Main glTF::Main::parse(std::string_view json)
 {
-    const std::string data = *daw::read_file(path);
-
 #ifdef NDEBUG
-    return daw::json::from_json<glTF::Main>(std::string_view(data.data(), data.size()));
+    return daw::json::from_json<glTF::Main>(json);
 #else
     glTF::Main gltf;
     try
     {
-        gltf = daw::json::from_json<glTF::Main>(std::string_view(data.data(), data.size()));
+        gltf = daw::json::from_json<glTF::Main>(json);
     } catch(const daw::json::json_exception& ex)
     {
         std::string errorReason = ex.reason();
@@ -29,4 +30,158 @@ glTF::Main glTF::Main::load(std::string path)
     }
     return gltf;
 #endif
-}
\ No newline at end of file
+}
+
+namespace
+{
+    // see https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#glb-file-format-specification
+    constexpr uint32_t glbMagic = 0x46546C67;       // "glTF"
+    constexpr uint32_t glbChunkJSON = 0x4E4F534A;   // "JSON"
+    constexpr uint32_t glbChunkBIN = 0x004E4942;    // "BIN\0"
+    constexpr size_t glbHeaderSize = 12;
+    constexpr size_t glbChunkHeaderSize = 8;
+
+    uint32_t readU32(const std::byte* src)
+    {
+        uint32_t value;
+        std::memcpy(&value, src, sizeof(uint32_t));
+        return value;
+    }
+
+    struct GLBChunks
+    {
+        std::string_view json;
+        Span<const std::byte> bin;
+        bool valid = false;
+    };
+
+    // Only looks at the headers, both chunks point into file
+    GLBChunks parseGLB(Span<const std::byte> file)
+    {
+        GLBChunks chunks;
+        if(file.size() < glbHeaderSize + glbChunkHeaderSize)
+            return chunks;
+        const std::byte* data = file.data();
+        const uint32_t version = readU32(data + 4);
+        const uint32_t length = readU32(data + 8);
+        if(version != 2 || length > file.size())
+            return chunks;
+
+        // first chunk has to be the JSON, optionally followed by exactly one BIN chunk
+        size_t offset = glbHeaderSize;
+        const uint32_t jsonLength = readU32(data + offset);
+        if(readU32(data + offset + 4) != glbChunkJSON || offset + glbChunkHeaderSize + jsonLength > length)
+            return chunks;
+        offset += glbChunkHeaderSize;
+        chunks.json = {reinterpret_cast<const char*>(data + offset), jsonLength};
+        offset += jsonLength;
+
+        if(offset + glbChunkHeaderSize <= length)
+        {
+            const uint32_t binLength = readU32(data + offset);
+            if(readU32(data + offset + 4) == glbChunkBIN && offset + glbChunkHeaderSize + binLength <= length)
+                chunks.bin = {data + offset + glbChunkHeaderSize, binLength};
+        }
+        chunks.valid = true;
+        return chunks;
+    }
+
+    // payload of a "data:[<mediatype>];base64,<data>" URI, nullopt if uri is a regular path
+    std::optional<std::string_view> dataURIPayload(std::string_view uri)
+    {
+        if(!uri.starts_with("data:"))
+            return std::nullopt;
+        const size_t comma = uri.find(',');
+        // glTF only allows base64 data URIs
+        assert(comma != std::string_view::npos && uri.substr(0, comma).ends_with(";base64"));
+        return uri.substr(comma + 1);
+    }
+} // namespace
+
+glTF::Asset glTF::Asset::load(const std::string& path)
+{
+    Asset asset;
+    asset.file = MappedFile{path};
+    if(!asset.file.isOpen())
+    {
+        std::cout << "Failed to open glTF file: " << path << std::endl;
+        return asset;
+    }
+
+    // JSON is parsed straight out of the mapping, no matter if its .gltf or .glb
+    const Span<const std::byte> fileBytes = asset.file.bytes();
+    std::string_view json{reinterpret_cast<const char*>(fileBytes.data()), fileBytes.size()};
+    Span<const std::byte> binChunk;
+    if(fileBytes.size() >= sizeof(uint32_t) && readU32(fileBytes.data()) == glbMagic)
+    {
+        const GLBChunks chunks = parseGLB(fileBytes);
+        if(!chunks.valid)
+        {
+            std::cout << "Invalid .glb file: " << path << std::endl;
+            return asset;
+        }
+        json = chunks.json;
+        binChunk = chunks.bin;
+    }
+    asset.main = Main::parse(json);
+
+    const std::filesystem::path basePath = std::filesystem::path{path}.parent_path();
+    // the spans point into the decoded vectors heap memory, so growing decodedData doesnt invalidate them
+    const auto decodeDataURI = [&](std::string_view payload) -> Span<const std::byte>
+    {
+        std::vector<std::byte>& decoded = asset.decodedData.emplace_back();
+        if(!Base64::decode(payload, decoded))
+        {
+            std::cout << "Invalid base64 data in: " << path << std::endl;
+            BREAKPOINT;
+        }
+        return decoded;
+    };
+
+    asset.buffers.resize(asset.main.buffers.size());
+    for(int i = 0; i < asset.main.buffers.size(); i++)
+    {
+        const Buffer& buffer = asset.main.buffers[i];
+        if(!buffer.uri.has_value())
+        {
+            // the BIN chunk, can be padded to 4 bytes
+            assert(i == 0 && binChunk.size() >= buffer.byteLength);
+            asset.buffers[i] = {binChunk.data(), buffer.byteLength};
+        }
+        else if(auto payload = dataURIPayload(buffer.uri.value()))
+        {
+            asset.buffers[i] = decodeDataURI(payload.value());
+            assert(asset.buffers[i].size() >= buffer.byteLength);
+        }
+        else
+        {
+            // mappings dont move when the MappedFile does
+            const MappedFile& mapped = asset.bufferFiles.emplace_back((basePath / buffer.uri.value()).string());
+            if(!mapped.isOpen() || mapped.size() < buffer.byteLength)
+            {
+                std::cout << "Failed to open glTF buffer: " << buffer.uri.value() << std::endl;
+                return asset;
+            }
+            asset.buffers[i] = {mapped.data(), buffer.byteLength};
+        }
+    }
+
+    asset.images.resize(asset.main.images.size());
+    for(int i = 0; i < asset.main.images.size(); i++)
+    {
+        const Image& image = asset.main.images[i];
+        if(image.bufferViewIndex.has_value())
+        {
+            const BufferView& view = asset.main.bufferViews[image.bufferViewIndex.value()];
+            asset.images[i] = {asset.buffers[view.bufferIndex].data() + view.byteOffset, view.byteLength};
+        }
+        else if(auto payload = dataURIPayload(image.uri.value()))
+        {
+            asset.images[i] = decodeDataURI(payload.value());
+        }
+        // otherwise its an external file, stays empty
+    }
+
+    asset.valid = true;
+    return asset;
+}
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <Datastructures/Span.hpp>
+#include <Engine/Misc/MappedFile.hpp>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace glTF
@@ -28,6 +32,7 @@ namespace glTF
     struct Sampler;
     struct BufferView;
     struct Buffer;
+    struct Asset;
 } // namespace glTF
 
 struct glTF::AssetInfo
@@ -82,6 +87,8 @@ struct glTF::Accessor
     uint32_t componentType;
     uint32_t count;
     std::string type;
+    // only valid for integer component types, see KHR_mesh_quantization
+    std::optional<bool> normalized;
 
     enum ComponentType
     {
@@ -156,7 +163,10 @@ struct glTF::Texture
 
 struct glTF::Image
 {
-    std::string uri;
+    // either uri (file or data URI) or bufferView + mimeType are set
+    std::optional<std::string> uri;
+    std::optional<uint32_t> bufferViewIndex;
+    std::optional<std::string> mimeType;
 };
 
 struct glTF::Sampler
@@ -178,7 +188,8 @@ struct glTF::BufferView
 struct glTF::Buffer
 {
     uint32_t byteLength;
-    std::string uri;
+    // not set for the BIN chunk of a .glb
+    std::optional<std::string> uri;
 };
 
 struct glTF::Main
@@ -196,5 +207,30 @@ struct glTF::Main
     std::vector<BufferView> bufferViews;
     std::vector<Buffer> buffers;
 
-    static Main load(std::string path);
+    static Main parse(std::string_view json);
+};
+
+/*
+    A parsed .gltf or .glb file together with the memory backing its buffers
+    The file itself and external buffers are memory mapped. The JSON gets parsed directly from the mapping
+    and the BIN chunk of a .glb is used in place, only base64 data URIs are decoded into owned memory
+    Moving an Asset keeps all spans valid
+*/
+struct glTF::Asset
+{
+    Main main;
+    // one per main.buffers entry
+    std::vector<Span<const std::byte>> buffers;
+    // one per main.images entry, encoded image file contents. Empty if the image references an external file
+    std::vector<Span<const std::byte>> images;
+
+    // check isValid() afterwards
+    static Asset load(const std::string& path);
+    [[nodiscard]] bool isValid() const { return valid; }
+
+  private:
+    bool valid = false;
+    MappedFile file;
+    std::vector<MappedFile> bufferFiles;
+    std::vector<std::vector<std::byte>> decodedData;
 };
\ No newline at end of file
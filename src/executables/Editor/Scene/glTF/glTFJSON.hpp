@@ -109,7 +109,8 @@ JSONType(glTF::Accessor)
         json_number_or_default_int<"byteOffset", uint32_t, 0>, //
         json_number<"componentType", uint32_t>,                //
         json_number<"count", uint32_t>,                        //
-        json_string<"type">                                    //
+        json_string<"type">,                                   //
+        json_bool_null<"normalized", std::optional<bool>>      //
         >;
 };
 
@@ -166,8 +167,10 @@ JSONType(glTF::Texture)
 
 JSONType(glTF::Image)
 {
-    using type = json_member_list< //
-        json_string<"uri">         //
+    using type = json_member_list<                               //
+        json_string_null<"uri", std::optional<std::string>>,     //
+        json_number_null<"bufferView", std::optional<uint32_t>>, //
+        json_string_null<"mimeType", std::optional<std::string>> //
         >;
 };
 
@@ -193,9 +196,9 @@ JSONType(glTF::BufferView)
 
 JSONType(glTF::Buffer)
 {
-    using type = json_member_list<           //
-        json_number<"byteLength", uint32_t>, //
-        json_string<"uri">                   //
+    using type = json_member_list<                          //
+        json_number<"byteLength", uint32_t>,                //
+        json_string_null<"uri", std::optional<std::string>> //
         >;
 };
 
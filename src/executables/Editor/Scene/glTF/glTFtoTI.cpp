@@ -1,4 +1,5 @@
 #include "glTFtoTI.hpp"
+#include "glTF.hpp"
 #include <cassert>
 
 Sampler::Filter glTF::toEngine::magFilter(uint32_t magFilter)
@@ -59,3 +60,39 @@ Sampler::AddressMode glTF::toEngine::addressMode(uint32_t wrap)
         return Sampler::AddressMode::Repeat;
     }
 }
+
+AttributeDecode::ComponentType glTF::toEngine::componentType(uint32_t componentType)
+{
+    switch(componentType)
+    {
+    case Accessor::sint8:
+        return AttributeDecode::ComponentType::Int8;
+    case Accessor::uint8:
+        return AttributeDecode::ComponentType::UInt8;
+    case Accessor::sint16:
+        return AttributeDecode::ComponentType::Int16;
+    case Accessor::uint16:
+        return AttributeDecode::ComponentType::UInt16;
+    case Accessor::uint32:
+        return AttributeDecode::ComponentType::UInt32;
+    case Accessor::f32:
+        return AttributeDecode::ComponentType::Float32;
+    default:
+        assert(false);
+        return AttributeDecode::ComponentType::Float32;
+    }
+}
+
+uint32_t glTF::toEngine::componentCount(std::string_view accessorType)
+{
+    if(accessorType == Accessor::scalar)
+        return 1;
+    if(accessorType == Accessor::vec2)
+        return 2;
+    if(accessorType == Accessor::vec3)
+        return 3;
+    if(accessorType == Accessor::vec4)
+        return 4;
+    assert(false && "Matrix accessors are not supported");
+    return 0;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <Engine/Graphics/Mesh/AttributeDecode.hpp>
 #include <Engine/Graphics/Texture/Sampler.hpp>
+#include <string_view>
 
 namespace glTF::toEngine
 {
@@ -8,4 +10,7 @@ namespace glTF::toEngine
     ::Sampler::Filter minFilter(uint32_t minFilter);
     ::Sampler::Filter mipmapMode(uint32_t minFilter);
     ::Sampler::AddressMode addressMode(uint32_t wrap);
+
+    AttributeDecode::ComponentType componentType(uint32_t componentType);
+    uint32_t componentCount(std::string_view accessorType);
 } // namespace glTF::toEngine
\ No newline at end of file
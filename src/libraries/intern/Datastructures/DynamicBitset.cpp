@@ -1,8 +1,11 @@
+#include <algorithm>
 #include <bit>
 #include <cassert>
+#include <cstring>
 
 #include "Datastructures/DynamicBitset.hpp"
 #include "DynamicBitset.hpp"
+#include "DynamicBitsetKernels.hpp"
 
 DynamicBitset::DynamicBitset(uint32_t _size) : size(_size)
 {
@@ -12,55 +15,90 @@ DynamicBitset::DynamicBitset(uint32_t _size) : size(_size)
 
 DynamicBitset operator&(const DynamicBitset& lhs, const DynamicBitset& rhs)
 {
-    DynamicBitset ret = lhs;
+    DynamicBitset ret{0};
+    DynamicBitset::bitwiseAnd(ret, lhs, rhs);
+    return ret;
+}
 
-    if(ret.size < rhs.size)
-    {
-        ret.resize(rhs.size);
-        for(int i = 0; i < ret.internal.size(); i++)
-            ret.internal[i] &= rhs.internal[i];
-    }
-    else
-    {
-        if(ret.size > rhs.size)
-            ret.clear(rhs.size, ret.size - 1);
+DynamicBitset operator|(const DynamicBitset& lhs, const DynamicBitset& rhs)
+{
+    DynamicBitset ret{0};
+    DynamicBitset::bitwiseOr(ret, lhs, rhs);
+    return ret;
+}
 
-        for(int i = 0; i < rhs.internal.size(); i++)
-            ret.internal[i] &= rhs.internal[i];
-    }
+DynamicBitset& DynamicBitset::operator&=(const DynamicBitset& rhs)
+{
+    bitwiseAnd(*this, *this, rhs);
+    return *this;
+}
 
-    return ret;
+DynamicBitset& DynamicBitset::operator|=(const DynamicBitset& rhs)
+{
+    bitwiseOr(*this, *this, rhs);
+    return *this;
 }
 
-bool DynamicBitset::anyBitSet() const
+void DynamicBitset::bitwiseAnd(DynamicBitset& dst, const DynamicBitset& lhs, const DynamicBitset& rhs)
+{
+    const auto& kernels = BitsetKernels::get();
+    // need to query this before resizing, dst may be lhs or rhs
+    const auto commonWords = static_cast<uint32_t>(std::min(lhs.internal.size(), rhs.internal.size()));
+
+    dst.resize(std::max(lhs.size, rhs.size));
+    const auto dstWords = static_cast<uint32_t>(dst.internal.size());
+
+    // bits past "size" are always 0, so ANDing the common words keeps that invariant intact
+    kernels.andWords(dst.internal.data(), lhs.internal.data(), rhs.internal.data(), commonWords);
+    // anything outside of the smaller bitset counts as 0
+    kernels.fillWords(dst.internal.data() + commonWords, dstWords - commonWords, 0u);
+}
+
+void DynamicBitset::bitwiseOr(DynamicBitset& dst, const DynamicBitset& lhs, const DynamicBitset& rhs)
 {
-    for(auto i = 0; i < internal.size(); i++)
+    const auto& kernels = BitsetKernels::get();
+    const auto commonWords = static_cast<uint32_t>(std::min(lhs.internal.size(), rhs.internal.size()));
+    const DynamicBitset& larger = lhs.size >= rhs.size ? lhs : rhs;
+
+    dst.resize(larger.size);
+    const auto dstWords = static_cast<uint32_t>(dst.internal.size());
+
+    kernels.orWords(dst.internal.data(), lhs.internal.data(), rhs.internal.data(), commonWords);
+    if(&dst != &larger && dstWords > commonWords)
     {
-        if(internal[i] != 0u)
-        {
-            return true;
-        }
+        memcpy(
+            dst.internal.data() + commonWords,
+            larger.internal.data() + commonWords,
+            (dstWords - commonWords) * sizeof(uint32_t));
     }
-    return false;
+}
+
+bool DynamicBitset::anyBitSet() const
+{
+    const auto wordCount = static_cast<uint32_t>(internal.size());
+    return BitsetKernels::get().findFirstWordNotEqual(internal.data(), wordCount, 0u) != wordCount;
 }
 
 bool DynamicBitset::anyBitClear() const
 {
-    for(auto i = 0; i < internal.size() - 1; i++)
+    const uint32_t fullWords = size / 32u;
+    if(BitsetKernels::get().findFirstWordNotEqual(internal.data(), fullWords, ~0u) != fullWords)
     {
-        if(internal[i] != 0xFFFFFFFF)
-        {
-            return true;
-        }
+        return true;
     }
-    uint32_t lastInt = internal[internal.size() - 1];
-    const uint32_t ones = 0xFFFFFFFF;
     const uint32_t bitsInLastInt = size % 32u;
-    const uint32_t mask = ~(ones >> (32u - bitsInLastInt));
-    // set all bits in the last int beyond "size" to 1
-    lastInt |= mask;
-    // if the whole int is now 111....111 then there was also no 0 in the first part of the int
-    return !(lastInt == ones);
+    if(bitsInLastInt == 0u)
+    {
+        return false;
+    }
+    // bits beyond "size" are 0, so only need to check if the first bitsInLastInt are all ones
+    return static_cast<uint32_t>(std::countr_one(internal[fullWords])) < bitsInLastInt;
+}
+
+uint32_t DynamicBitset::popcount() const
+{
+    // relies on all bits past "size" being 0
+    return BitsetKernels::get().popcount(internal.data(), static_cast<uint32_t>(internal.size()));
 }
 
 void DynamicBitset::setBit(uint32_t index)
@@ -90,8 +128,7 @@ bool DynamicBitset::getBit(uint32_t index) const
 
 void DynamicBitset::clear()
 {
-    for(auto i = 0; i < internal.size(); i++)
-        internal[i] = 0u;
+    BitsetKernels::get().fillWords(internal.data(), static_cast<uint32_t>(internal.size()), 0u);
 }
 void DynamicBitset::clear(uint32_t firstBit, uint32_t lastBit)
 {
@@ -120,9 +157,9 @@ void DynamicBitset::clear(uint32_t firstBit, uint32_t lastBit)
     const int32_t firstFullint = UintDivAndCeil(firstBit, 32u);
     const int32_t lastFullint = (lastBit + 1u) / 32u - 1u;
 
-    for(int i = firstFullint; i <= lastFullint; i++)
+    if(lastFullint >= firstFullint)
     {
-        internal[i] = 0u;
+        BitsetKernels::get().fillWords(&internal[firstFullint], lastFullint - firstFullint + 1, 0u);
     }
 
     uint32_t clearBits = 0u;
@@ -142,8 +179,7 @@ void DynamicBitset::clear(uint32_t firstBit, uint32_t lastBit)
 }
 void DynamicBitset::fill()
 {
-    for(auto i = 0; i < internal.size(); i++)
-        internal[i] = ~0u;
+    BitsetKernels::get().fillWords(internal.data(), static_cast<uint32_t>(internal.size()), ~0u);
     fixLastInteger();
 }
 void DynamicBitset::fill(uint32_t firstBit, uint32_t lastBit)
@@ -172,9 +208,9 @@ void DynamicBitset::fill(uint32_t firstBit, uint32_t lastBit)
     const int32_t firstFullint = UintDivAndCeil(firstBit, 32u);
     const int32_t lastFullint = (lastBit + 1u) / 32u - 1u;
 
-    for(int i = firstFullint; i <= lastFullint; i++)
+    if(lastFullint >= firstFullint)
     {
-        internal[i] = 0xFFFFFFFF;
+        BitsetKernels::get().fillWords(&internal[firstFullint], lastFullint - firstFullint + 1, 0xFFFFFFFF);
     }
 
     uint32_t fillBits = 0u;
@@ -203,70 +239,59 @@ static_assert(getLastFull(64) == 1);
 
 uint32_t DynamicBitset::getFirstBitSet() const
 {
-    for(auto i = 0; i < internal.size() - 1; i++)
-    {
-        if(internal[i] != 0u)
-        {
-            return 32u * i + std::countr_zero(internal[i]);
-        }
-    }
-    if(internal[internal.size() - 1] == 0)
+    const auto wordCount = static_cast<uint32_t>(internal.size());
+    const uint32_t word = BitsetKernels::get().findFirstWordNotEqual(internal.data(), wordCount, 0u);
+    if(word == wordCount)
     {
         return 0xFFFFFFFF;
     }
-    return 32u * (internal.size() - 1) + std::countr_zero(internal[internal.size() - 1]);
+    return 32u * word + std::countr_zero(internal[word]);
 }
 
 uint32_t DynamicBitset::getFirstBitClear() const
 {
-    // todo: I feel like there must be simpler logic for this
-    for(auto i = 0; i < internal.size() - 1; i++)
+    // the last int may only be partially used, so only scan the full ones in bulk
+    const uint32_t fullWords = size / 32u;
+    const uint32_t word = BitsetKernels::get().findFirstWordNotEqual(internal.data(), fullWords, 0xFFFFFFFF);
+    if(word != fullWords)
     {
-        if(internal[i] != 0xFFFFFFFF)
-        {
-            return 32u * i + std::countr_one(internal[i]);
-        }
+        return 32u * word + std::countr_one(internal[word]);
     }
-    uint32_t consecOnesInLastInt = std::countr_one(internal[internal.size() - 1]);
-    if(size % 32u == 0u)
+    const uint32_t bitsInLastInt = size % 32u;
+    if(bitsInLastInt == 0u)
     {
-        return internal[internal.size() - 1] == 0xFFFFFFFF ? 0xFFFFFFFF
-                                                           : 32u * (internal.size() - 1) + consecOnesInLastInt;
+        return 0xFFFFFFFF;
     }
-    return (consecOnesInLastInt == size % 32u) ? 0xFFFFFFFF : 32u * (internal.size() - 1) + consecOnesInLastInt;
+    const uint32_t consecOnesInLastInt = std::countr_one(internal[fullWords]);
+    return consecOnesInLastInt >= bitsInLastInt ? 0xFFFFFFFF : 32u * fullWords + consecOnesInLastInt;
 }
 
 uint32_t DynamicBitset::getNextBitSet(uint32_t index) const
 {
-    const uint32_t startWordIndex = index / 32u;
-    const uint32_t startIndexInsideWord = index % 32u;
-
-    if(startWordIndex == internal.size() - 1)
+    if(index >= size || index + 1u == size)
     {
-        uint32_t lastBitsAfterIndex = internal[startWordIndex] >> (startIndexInsideWord + 1);
-        if(lastBitsAfterIndex == 0u)
-            return 0xFFFFFFFF;
-        return std::countr_zero(lastBitsAfterIndex) + index + 1;
+        return 0xFFFFFFFF;
     }
+    const uint32_t start = index + 1u;
+    const uint32_t startWordIndex = start / 32u;
 
     // check inside word of start index
-    uint32_t restBitsInStartWord = internal[startWordIndex] >> startIndexInsideWord;
-    restBitsInStartWord = restBitsInStartWord >> 1u;
-    if(restBitsInStartWord > 0u)
+    const uint32_t restBitsInStartWord = internal[startWordIndex] >> (start % 32u);
+    if(restBitsInStartWord != 0u)
     {
-        return std::countr_zero(restBitsInStartWord) + index + 1;
+        return start + std::countr_zero(restBitsInStartWord);
     }
 
-    for(uint32_t i = startWordIndex + 1; i < internal.size() - 1; i++)
+    const auto wordCount = static_cast<uint32_t>(internal.size());
+    const uint32_t firstWordToScan = startWordIndex + 1u;
+    const uint32_t word =
+        firstWordToScan +
+        BitsetKernels::get().findFirstWordNotEqual(internal.data() + firstWordToScan, wordCount - firstWordToScan, 0u);
+    if(word == wordCount)
     {
-        if(internal[i] > 0u)
-            return std::countr_zero(internal[i]) + i * 32;
-    }
-
-    if(internal[internal.size() - 1] == 0u)
         return 0xFFFFFFFF;
-
-    return std::countr_zero(internal[internal.size() - 1]) + (internal.size() - 1) * 32u;
+    }
+    return 32u * word + std::countr_zero(internal[word]);
 }
 
 uint32_t DynamicBitset::getSize() const { return size; }
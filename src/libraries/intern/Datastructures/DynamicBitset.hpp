@@ -16,6 +16,16 @@ class DynamicBitset
     explicit DynamicBitset(uint32_t _size);
 
     friend DynamicBitset operator&(const DynamicBitset& lhs, const DynamicBitset& rhs);
+    friend DynamicBitset operator|(const DynamicBitset& lhs, const DynamicBitset& rhs);
+    // resizes to max(size, rhs.size) like the binary operators, bits outside of a bitset count as 0
+    DynamicBitset& operator&=(const DynamicBitset& rhs);
+    DynamicBitset& operator|=(const DynamicBitset& rhs);
+    /*
+        Write lhs & rhs (or lhs | rhs) into dst without creating a temporary
+        dst is resized to max(lhs.size, rhs.size), may be the same object as lhs or rhs
+    */
+    static void bitwiseAnd(DynamicBitset& dst, const DynamicBitset& lhs, const DynamicBitset& rhs);
+    static void bitwiseOr(DynamicBitset& dst, const DynamicBitset& lhs, const DynamicBitset& rhs);
 
     void setBit(uint32_t index);
     void clearBit(uint32_t index);
@@ -29,6 +39,8 @@ class DynamicBitset
 
     bool anyBitClear() const;
     bool anyBitSet() const;
+    // amount of bits that are set
+    [[nodiscard]] uint32_t popcount() const;
     // returns 0xffffffff is no bit is set
     [[nodiscard]] uint32_t getFirstBitSet() const;
     // returns 0xffffffff is no bit is cleared
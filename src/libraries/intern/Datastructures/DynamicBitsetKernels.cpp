@@ -0,0 +1,293 @@
+#include "DynamicBitsetKernels.hpp"
+
+#include <bit>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define BITSET_KERNELS_X64
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        // MSVC allows using intrinsics of any instruction set without changing the compile flags
+        #define BITSET_TARGET_AVX2
+    #else
+        #define BITSET_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    #define BITSET_KERNELS_NEON
+    #include <arm_neon.h>
+#endif
+
+// ---------------------------- Scalar ------------------------------------------
+
+namespace
+{
+    void fillWordsScalar(uint32_t* dst, uint32_t count, uint32_t value)
+    {
+        for(uint32_t i = 0; i < count; i++)
+            dst[i] = value;
+    }
+
+    uint32_t popcountScalar(const uint32_t* words, uint32_t count)
+    {
+        uint32_t sum = 0;
+        for(uint32_t i = 0; i < count; i++)
+            sum += std::popcount(words[i]);
+        return sum;
+    }
+
+    uint32_t findFirstWordNotEqualScalar(const uint32_t* words, uint32_t count, uint32_t skipValue)
+    {
+        for(uint32_t i = 0; i < count; i++)
+        {
+            if(words[i] != skipValue)
+                return i;
+        }
+        return count;
+    }
+
+    void andWordsScalar(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs, uint32_t count)
+    {
+        for(uint32_t i = 0; i < count; i++)
+            dst[i] = lhs[i] & rhs[i];
+    }
+
+    void orWordsScalar(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs, uint32_t count)
+    {
+        for(uint32_t i = 0; i < count; i++)
+            dst[i] = lhs[i] | rhs[i];
+    }
+
+    const BitsetKernels::Table scalarTable{
+        .name = "Scalar",
+        .fillWords = fillWordsScalar,
+        .popcount = popcountScalar,
+        .findFirstWordNotEqual = findFirstWordNotEqualScalar,
+        .andWords = andWordsScalar,
+        .orWords = orWordsScalar,
+    };
+} // namespace
+
+// ---------------------------- AVX2 --------------------------------------------
+
+#ifdef BITSET_KERNELS_X64
+namespace
+{
+    BITSET_TARGET_AVX2 void fillWordsAVX2(uint32_t* dst, uint32_t count, uint32_t value)
+    {
+        const __m256i v = _mm256_set1_epi32(static_cast<int>(value));
+        uint32_t i = 0;
+        for(; i + 8 <= count; i += 8)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+        for(; i < count; i++)
+            dst[i] = value;
+    }
+
+    // Nibble lookup popcount, see "Faster Population Counts Using AVX2 Instructions" (Mula, Kurz, Lemire)
+    BITSET_TARGET_AVX2 uint32_t popcountAVX2(const uint32_t* words, uint32_t count)
+    {
+        const __m256i lookup = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, //
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowMask = _mm256_set1_epi8(0x0F);
+        __m256i acc = _mm256_setzero_si256();
+
+        uint32_t i = 0;
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+            const __m256i lo = _mm256_and_si256(v, lowMask);
+            const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+            const __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+            // horizontal byte sums into 4 uint64 lanes, no risk of overflowing the 8bit counts this way
+            acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+        }
+
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        auto sum = static_cast<uint32_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+
+        for(; i < count; i++)
+            sum += std::popcount(words[i]);
+        return sum;
+    }
+
+    BITSET_TARGET_AVX2 uint32_t findFirstWordNotEqualAVX2(const uint32_t* words, uint32_t count, uint32_t skipValue)
+    {
+        const __m256i skip = _mm256_set1_epi32(static_cast<int>(skipValue));
+        uint32_t i = 0;
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+            // one bit per 32bit lane, set if lane == skipValue
+            const auto equalMask =
+                static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, skip))));
+            if(equalMask != 0xFFu)
+                return i + std::countr_one(equalMask);
+        }
+        for(; i < count; i++)
+        {
+            if(words[i] != skipValue)
+                return i;
+        }
+        return count;
+    }
+
+    BITSET_TARGET_AVX2 void andWordsAVX2(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs, uint32_t count)
+    {
+        uint32_t i = 0;
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(a, b));
+        }
+        for(; i < count; i++)
+            dst[i] = lhs[i] & rhs[i];
+    }
+
+    BITSET_TARGET_AVX2 void orWordsAVX2(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs, uint32_t count)
+    {
+        uint32_t i = 0;
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(a, b));
+        }
+        for(; i < count; i++)
+            dst[i] = lhs[i] | rhs[i];
+    }
+
+    const BitsetKernels::Table avx2Table{
+        .name = "AVX2",
+        .fillWords = fillWordsAVX2,
+        .popcount = popcountAVX2,
+        .findFirstWordNotEqual = findFirstWordNotEqualAVX2,
+        .andWords = andWordsAVX2,
+        .orWords = orWordsAVX2,
+    };
+
+    bool cpuSupportsAVX2()
+    {
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if(info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        // OSXSAVE (bit 27) && AVX (bit 28), otherwise the OS might not save the ymm registers
+        const bool osUsesXSAVE = (info[2] & (1 << 27)) != 0;
+        const bool cpuHasAVX = (info[2] & (1 << 28)) != 0;
+        if(!osUsesXSAVE || !cpuHasAVX)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    #else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    #endif
+    }
+} // namespace
+#endif
+
+// ---------------------------- NEON --------------------------------------------
+
+#ifdef BITSET_KERNELS_NEON
+namespace
+{
+    void fillWordsNEON(uint32_t* dst, uint32_t count, uint32_t value)
+    {
+        const uint32x4_t v = vdupq_n_u32(value);
+        uint32_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            vst1q_u32(dst + i, v);
+        for(; i < count; i++)
+            dst[i] = value;
+    }
+
+    uint32_t popcountNEON(const uint32_t* words, uint32_t count)
+    {
+        uint32_t sum = 0;
+        uint32_t i = 0;
+        for(; i + 4 <= count; i += 4)
+        {
+            const uint8x16_t v = vreinterpretq_u8_u32(vld1q_u32(words + i));
+            // max 128 per iteration, fits into 16bit
+            sum += vaddlvq_u8(vcntq_u8(v));
+        }
+        for(; i < count; i++)
+            sum += std::popcount(words[i]);
+        return sum;
+    }
+
+    uint32_t findFirstWordNotEqualNEON(const uint32_t* words, uint32_t count, uint32_t skipValue)
+    {
+        const uint32x4_t skip = vdupq_n_u32(skipValue);
+        uint32_t i = 0;
+        for(; i + 4 <= count; i += 4)
+        {
+            const uint32x4_t equal = vceqq_u32(vld1q_u32(words + i), skip);
+            // all lanes equal -> min over lanes is still 0xFFFFFFFF
+            if(vminvq_u32(equal) != 0xFFFFFFFFu)
+                break;
+        }
+        for(; i < count; i++)
+        {
+            if(words[i] != skipValue)
+                return i;
+        }
+        return count;
+    }
+
+    void andWordsNEON(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs, uint32_t count)
+    {
+        uint32_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            vst1q_u32(dst + i, vandq_u32(vld1q_u32(lhs + i), vld1q_u32(rhs + i)));
+        for(; i < count; i++)
+            dst[i] = lhs[i] & rhs[i];
+    }
+
+    void orWordsNEON(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs, uint32_t count)
+    {
+        uint32_t i = 0;
+        for(; i + 4 <= count; i += 4)
+            vst1q_u32(dst + i, vorrq_u32(vld1q_u32(lhs + i), vld1q_u32(rhs + i)));
+        for(; i < count; i++)
+            dst[i] = lhs[i] | rhs[i];
+    }
+
+    const BitsetKernels::Table neonTable{
+        .name = "NEON",
+        .fillWords = fillWordsNEON,
+        .popcount = popcountNEON,
+        .findFirstWordNotEqual = findFirstWordNotEqualNEON,
+        .andWords = andWordsNEON,
+        .orWords = orWordsNEON,
+    };
+} // namespace
+#endif
+
+// ------------------------------------------------------------------------------
+
+namespace BitsetKernels
+{
+    const Table& get()
+    {
+        // function local static so the selection is thread safe and happens before any pool is used
+        static const Table& selected = []() -> const Table&
+        {
+#if defined(BITSET_KERNELS_X64)
+            if(cpuSupportsAVX2())
+                return avx2Table;
+#elif defined(BITSET_KERNELS_NEON)
+            return neonTable;
+#endif
+            return scalarTable;
+        }();
+        return selected;
+    }
+
+    const Table& scalar() { return scalarTable; }
+} // namespace BitsetKernels
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+    Word level kernels used by DynamicBitset
+    The implementation is picked once at runtime depending on what the CPU supports:
+        x64:     AVX2 if available, scalar otherwise
+        aarch64: NEON (always available)
+    All functions work on plain uint32_t arrays, so they can also be used on the result of
+    DynamicBitset::getInternal() directly
+*/
+namespace BitsetKernels
+{
+    struct Table
+    {
+        const char* name = "";
+
+        // dst[0..count) = value
+        void (*fillWords)(uint32_t* dst, uint32_t count, uint32_t value) = nullptr;
+        // returns the amount of set bits in words[0..count)
+        uint32_t (*popcount)(const uint32_t* words, uint32_t count) = nullptr;
+        // returns index of the first word that is != skipValue, count if there is none
+        uint32_t (*findFirstWordNotEqual)(const uint32_t* words, uint32_t count, uint32_t skipValue) = nullptr;
+        // dst[i] = lhs[i] & rhs[i], dst may alias lhs or rhs
+        void (*andWords)(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs, uint32_t count) = nullptr;
+        // dst[i] = lhs[i] | rhs[i], dst may alias lhs or rhs
+        void (*orWords)(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs, uint32_t count) = nullptr;
+    };
+
+    // Selected on first call, safe to call from multiple threads
+    const Table& get();
+
+    // Always available, mainly here so the vectorized versions can be tested against it
+    const Table& scalar();
+} // namespace BitsetKernels
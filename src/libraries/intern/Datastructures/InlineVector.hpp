@@ -0,0 +1,246 @@
+#pragma once
+
+#include "Span.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+    Vector that stores up to N elements inside the object itself and only goes to the heap once it grows larger
+        - meant for small temporaries and per-entity containers where std::vector would heap allocate for
+          just a handful of elements
+        - once spilled to the heap it stays there (clear() does not shrink back into the inline storage)
+        - converts implicitly to Span<T>/Span<const T>
+    Moving an InlineVector that still uses its inline storage moves the elements one by one, so
+    pointers/iterators into it are invalidated by moves (unlike std::vector)!
+*/
+template <typename T, uint32_t N>
+    requires(N > 0)
+class InlineVector
+{
+  public:
+    using value_type = T;
+    using size_type = uint32_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // Constructors ----------------------------
+
+    InlineVector() = default;
+
+    explicit InlineVector(size_type count)
+        requires std::is_default_constructible_v<T>
+    {
+        resize(count);
+    }
+
+    InlineVector(size_type count, const T& value) { resize(count, value); }
+
+    InlineVector(std::initializer_list<T> list) { append(list.begin(), list.end()); }
+
+    template <std::input_iterator It>
+    InlineVector(It first, It last)
+    {
+        append(first, last);
+    }
+
+    InlineVector(const InlineVector& other) { append(other.begin(), other.end()); }
+
+    InlineVector(InlineVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) { take(std::move(other)); }
+
+    InlineVector& operator=(const InlineVector& other)
+    {
+        if(this != &other)
+        {
+            clear();
+            append(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    InlineVector& operator=(InlineVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if(this != &other)
+        {
+            clear();
+            freeHeap();
+            take(std::move(other));
+        }
+        return *this;
+    }
+
+    ~InlineVector()
+    {
+        clear();
+        freeHeap();
+    }
+
+    // Member functions ----------------------------
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if(_size == _capacity)
+            grow(_capacity * 2);
+        T* element = std::construct_at(_data + _size, std::forward<Args>(args)...);
+        _size++;
+        return *element;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back()
+    {
+        assert(_size > 0);
+        _size--;
+        std::destroy_at(_data + _size);
+    }
+
+    // Removes the element at pos by moving all following elements one to the front, keeps the order
+    iterator erase(const_iterator pos)
+    {
+        assert(pos >= begin() && pos < end());
+        T* element = _data + (pos - _data);
+        std::move(element + 1, end(), element);
+        pop_back();
+        return element;
+    }
+
+    void clear()
+    {
+        std::destroy(_data, _data + _size);
+        _size = 0;
+    }
+
+    void reserve(size_type capacity)
+    {
+        if(capacity > _capacity)
+            grow(capacity);
+    }
+
+    void resize(size_type size)
+        requires std::is_default_constructible_v<T>
+    {
+        reserve(size);
+        for(size_type i = _size; i < size; i++)
+            std::construct_at(_data + i);
+        if(size < _size)
+            std::destroy(_data + size, _data + _size);
+        _size = size;
+    }
+
+    void resize(size_type size, const T& value)
+    {
+        reserve(size);
+        for(size_type i = _size; i < size; i++)
+            std::construct_at(_data + i, value);
+        if(size < _size)
+            std::destroy(_data + size, _data + _size);
+        _size = size;
+    }
+
+    T& operator[](size_type index)
+    {
+        assert(index < _size && "Accesing element outside of vector");
+        return _data[index]; // NOLINT
+    }
+
+    const T& operator[](size_type index) const
+    {
+        assert(index < _size && "Accesing element outside of vector");
+        return _data[index]; // NOLINT
+    }
+
+    T& back()
+    {
+        assert(_size > 0);
+        return _data[_size - 1];
+    }
+    const T& back() const
+    {
+        assert(_size > 0);
+        return _data[_size - 1];
+    }
+
+    [[nodiscard]] size_type size() const { return _size; }
+    [[nodiscard]] size_type capacity() const { return _capacity; }
+    [[nodiscard]] bool empty() const { return _size == 0; }
+    [[nodiscard]] bool isInline() const { return _data == inlineData(); }
+    static constexpr size_type inlineCapacity() { return N; }
+
+    T* data() { return _data; }
+    const T* data() const { return _data; }
+
+    iterator begin() { return _data; }
+    const_iterator begin() const { return _data; }
+    iterator end() { return _data + _size; }
+    const_iterator end() const { return _data + _size; }
+
+    operator Span<T>() { return {_data, _size}; }
+    operator Span<const T>() const { return {_data, _size}; }
+
+  private:
+    T* inlineData() { return std::launder(reinterpret_cast<T*>(&inlineStorage[0])); }
+    const T* inlineData() const { return std::launder(reinterpret_cast<const T*>(&inlineStorage[0])); }
+
+    template <typename It>
+    void append(It first, It last)
+    {
+        if constexpr(std::forward_iterator<It>)
+            reserve(_size + static_cast<size_type>(std::distance(first, last)));
+        for(; first != last; ++first)
+            emplace_back(*first);
+    }
+
+    void grow(size_type newCapacity)
+    {
+        assert(newCapacity > _capacity);
+        T* newData = std::allocator<T>{}.allocate(newCapacity);
+        std::uninitialized_move(_data, _data + _size, newData);
+        std::destroy(_data, _data + _size);
+        freeHeap();
+        _data = newData;
+        _capacity = newCapacity;
+    }
+
+    void freeHeap()
+    {
+        if(!isInline())
+            std::allocator<T>{}.deallocate(_data, _capacity);
+        _data = inlineData();
+        _capacity = N;
+    }
+
+    // expects this to be empty and using the inline storage
+    void take(InlineVector&& other)
+    {
+        if(other.isInline())
+        {
+            std::uninitialized_move(other.begin(), other.end(), _data);
+            _size = other._size;
+            other.clear();
+            return;
+        }
+        // steal heap allocation
+        _data = other._data;
+        _size = other._size;
+        _capacity = other._capacity;
+        other._data = other.inlineData();
+        other._size = 0;
+        other._capacity = N;
+    }
+
+    alignas(T) std::byte inlineStorage[N * sizeof(T)];
+    T* _data = inlineData();
+    size_type _size = 0;
+    size_type _capacity = N;
+};
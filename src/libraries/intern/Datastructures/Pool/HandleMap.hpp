@@ -0,0 +1,167 @@
+#pragma once
+
+#include "../DynamicBitset.hpp"
+#include "../Span.hpp"
+#include "Handle.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <vector>
+
+/*
+    Attaches additional data to handles of an existing Pool/MultiPool without touching the pool itself
+        - values are stored at the index of the handle, so lookups are just an array access + generation check
+        - since pools hand out the lowest free index first, the storage stays about as dense as the pool
+        - an entry only matches the exact handle it was inserted with, stale handles (same index, older/newer
+          generation) are treated as not contained
+    Growing moves all values into a larger array, so pointers are invalidated by insert()!
+*/
+template <typename H, typename V>
+    requires std::is_default_constructible_v<V> && std::is_move_assignable_v<V>
+class HandleMap
+{
+  public:
+    HandleMap() = default;
+
+    explicit HandleMap(uint32_t initialCapacity) { reserve(initialCapacity); }
+
+    void reserve(uint32_t capacity)
+    {
+        if(capacity <= values.size())
+            return;
+        values.resize(capacity);
+        generations.resize(capacity, 0u);
+        occupied.resize(capacity);
+    }
+
+    /*
+        Constructs a new value for handle, replacing anything that was stored at the handles index before
+        (including values belonging to older generations of that index)
+    */
+    template <typename... Args>
+        requires std::is_constructible_v<V, Args...>
+    V* insert(H handle, Args&&... args)
+    {
+        assert(handle.isNonNull());
+        const uint32_t index = handle.getIndex();
+        if(index >= values.size())
+        {
+            // growing factor
+            reserve(std::max<uint32_t>(index + 1u, 2u * static_cast<uint32_t>(values.size())));
+        }
+
+        if(!occupied.getBit(index))
+        {
+            occupied.setBit(index);
+            count++;
+        }
+        generations[index] = handle.getGeneration();
+        values[index] = V(std::forward<Args>(args)...);
+        return &values[index];
+    }
+
+    [[nodiscard]] bool contains(H handle) const
+    {
+        const uint32_t index = handle.getIndex();
+        return index < values.size() && occupied.getBit(index) && generations[index] == handle.getGeneration();
+    }
+
+    inline V* get(H handle)
+    {
+        if(!contains(handle))
+            return nullptr;
+        return &values[handle.getIndex()];
+    }
+
+    inline const V* get(H handle) const
+    {
+        if(!contains(handle))
+            return nullptr;
+        return &values[handle.getIndex()];
+    }
+
+    bool remove(H handle)
+    {
+        if(!contains(handle))
+            return false;
+        const uint32_t index = handle.getIndex();
+        occupied.clearBit(index);
+        values[index] = V{};
+        count--;
+        return true;
+    }
+
+    void clear()
+    {
+        std::fill(values.begin(), values.end(), V{});
+        occupied.clear();
+        count = 0;
+    }
+
+    [[nodiscard]] uint32_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+    [[nodiscard]] uint32_t capacity() const { return static_cast<uint32_t>(values.size()); }
+
+    /*
+        Raw storage indexed by handle index, for eg. uploading side data to the GPU in one go
+        Contains default constructed values in slots that are not occupied
+    */
+    Span<V> getValues() { return {values.data(), values.size()}; }
+    Span<const V> getValues() const { return {values.data(), values.size()}; }
+
+    template <bool isConst = true>
+    struct Iterator
+    {
+        using iterator_type = std::forward_iterator_tag;
+        using difference_type = uint32_t;
+
+        using Vptr = std::conditional<isConst, const V*, V*>::type;
+        using Map = std::conditional<isConst, const HandleMap<H, V>, HandleMap<H, V>>::type;
+
+        Iterator(uint32_t start, Map* owner) : map(owner), index(start) {}
+
+        Vptr operator*() const { return &map->values[index]; }
+        H asHandle() const { return {index, map->generations[index]}; }
+
+        Iterator& operator++()
+        {
+            index = map->occupied.getNextBitSet(index);
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b)
+        {
+            return a.map == b.map && a.index == b.index;
+        }
+        friend bool operator!=(const Iterator& a, const Iterator& b)
+        {
+            return a.map != b.map || a.index != b.index;
+        }
+
+      private:
+        uint32_t index;
+        Map* map;
+    };
+
+    Iterator<true> cbegin() const { return {occupied.getFirstBitSet(), this}; }
+    Iterator<true> begin() const { return cbegin(); }
+    Iterator<false> begin() { return {occupied.getFirstBitSet(), this}; }
+    Iterator<true> cend() const { return {0xFFFFFFFF, this}; }
+    Iterator<true> end() const { return cend(); }
+    Iterator<false> end() { return {0xFFFFFFFF, this}; }
+
+  private:
+    std::vector<V> values;
+    // Handles only store 16bit generations
+    std::vector<uint16_t> generations;
+    DynamicBitset occupied{0};
+    uint32_t count = 0;
+};
@@ -4,6 +4,7 @@
 #include "Handle.hpp"
 #include "PoolHelpers.hpp"
 
+#include <bit>
 #include <cassert>
 #include <functional>
 #include <type_traits>
@@ -146,6 +147,12 @@ class PoolImpl
     // Basic pointer to enable iterating over elements
     // iterate directly over the elements inside the storage array
     //   TODO: could have another iterator that uses Handles which would be a bit more robust in some cases I think
+    /*
+        The remaining bits of the current inUseMask word are cached inside the iterator, so incrementing only
+        touches the bitset again once a word is exhausted.
+        Removing the element the iterator currently points to is fine, but insertions/removals of *other*
+        elements in the same 32 element block are not seen by an iterator that already passed into that block!
+    */
     template <bool isConst = true>
     struct DirectIterator
     {
@@ -157,7 +164,7 @@ class PoolImpl
 
         using Pool = std::conditional<isConst, const PoolImpl<limit, T>, PoolImpl<limit, T>>::type;
 
-        DirectIterator(uint32_t start, Pool* owner) : pool(owner), index(start) {}
+        DirectIterator(uint32_t start, Pool* owner) : pool(owner), index(start) { cacheWord(); }
 
         // would auto here automatically make the return type either T* or const T* ?
         Tptr operator*() const { return &pool->storage[index]; };
@@ -167,12 +174,17 @@ class PoolImpl
 
         DirectIterator& operator++()
         {
-            // TODO: test if its faster to just for loop over all bits and get them here
-            //       maybe with caching the current word
-            // TODO: implement alternative iterator that caches full words of the freeLists bitmask?
-            //       would be invalidated by insertions and removals (since cached mask != actual free mask), but
-            //       faster
+            if(cachedWord != 0u)
+            {
+                const uint32_t skip = std::countr_zero(cachedWord);
+                index += skip + 1u;
+                // two shifts, since shifting by 32 would be UB
+                cachedWord = (cachedWord >> skip) >> 1u;
+                return *this;
+            }
+            // rest of the word is empty, let the bitset scan for the next used word
             index = pool->inUseMask.getNextBitSet(index);
+            cacheWord();
             return *this;
         }
 
@@ -193,7 +205,19 @@ class PoolImpl
         }
 
       private:
+        // stores all bits *after* index inside of index's word
+        void cacheWord()
+        {
+            if(index == 0xFFFFFFFF)
+            {
+                cachedWord = 0u;
+                return;
+            }
+            cachedWord = (pool->inUseMask.getInternal()[index / 32u] >> (index % 32u)) >> 1u;
+        }
+
         uint32_t index;
+        uint32_t cachedWord = 0u;
         Pool* pool;
     };
 
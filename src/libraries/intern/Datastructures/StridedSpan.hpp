@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Span.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*
+    Non owning view of count elements of type T that are byteStride bytes apart, like an interleaved vertex
+    attribute inside a buffer
+    Elements are read with memcpy, so the underlying data doesnt need to be aligned to alignof(T)
+*/
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+class StridedSpan
+{
+  public:
+    using Byte = std::conditional_t<std::is_const_v<T>, const std::byte, std::byte>;
+    using value_type = std::remove_const_t<T>;
+
+    StridedSpan() = default;
+
+    // byteStride of 0 means tightly packed
+    StridedSpan(Byte* data, size_t count, size_t byteStride = 0)
+        : _data(data), _count(count), _stride(byteStride == 0 ? sizeof(T) : byteStride)
+    {
+        assert(_stride >= sizeof(T));
+    }
+
+    value_type operator[](size_t index) const
+    {
+        assert(_data != nullptr && index < _count && "Accesing element outside of span");
+        value_type value;
+        std::memcpy(&value, _data + index * _stride, sizeof(T));
+        return value;
+    }
+
+    void set(size_t index, const value_type& value)
+        requires(!std::is_const_v<T>)
+    {
+        assert(_data != nullptr && index < _count && "Accesing element outside of span");
+        std::memcpy(_data + index * _stride, &value, sizeof(T));
+    }
+
+    [[nodiscard]] size_t size() const { return _count; }
+    [[nodiscard]] bool empty() const { return _count == 0; }
+    [[nodiscard]] size_t stride() const { return _stride; }
+    [[nodiscard]] Byte* bytes() const { return _data; }
+
+    [[nodiscard]] bool isTightlyPacked() const { return _stride == sizeof(T); }
+
+    // tightly packed and aligned for T, so the data can be accessed as a regular Span
+    [[nodiscard]] bool isContiguous() const
+    {
+        return isTightlyPacked() && reinterpret_cast<uintptr_t>(_data) % alignof(T) == 0;
+    }
+
+    /*
+        Only valid if isContiguous()
+        Allows handing the data on without copying it first
+    */
+    Span<T> asSpan() const
+    {
+        assert(isContiguous());
+        return {reinterpret_cast<T*>(_data), _count};
+    }
+
+  private:
+    Byte* _data = nullptr;
+    size_t _count = 0;
+    size_t _stride = sizeof(T);
+};
@@ -1,4 +1,5 @@
 #include <Datastructures/DynamicBitset.hpp>
+#include <Datastructures/DynamicBitsetKernels.hpp>
 #include <bitset>
 #include <cassert>
 #include <iostream>
@@ -222,4 +223,71 @@ int main()
         assert(bitset.getNextBitSet(96) == 108);
         assert(bitset.getNextBitSet(108) == 0xFFFFFFFF);
     }
+
+    // bigger sizes, so the vectorized kernels actually run over multiple registers
+    {
+        DynamicBitset bitset{4096};
+        assert(bitset.popcount() == 0);
+        assert(bitset.getFirstBitSet() == 0xFFFFFFFF);
+        bitset.fill();
+        assert(bitset.popcount() == 4096);
+        assert(!bitset.anyBitClear());
+        bitset.clearBit(3001);
+        assert(bitset.getFirstBitClear() == 3001);
+        bitset.clear(17, 2900);
+        assert(bitset.popcount() == 4096 - (2900 - 17 + 1) - 1);
+        assert(bitset.getFirstBitClear() == 17);
+        assert(bitset.getNextBitSet(16) == 2901);
+        bitset.clear();
+        bitset.setBit(4095);
+        assert(bitset.getFirstBitSet() == 4095);
+        assert(bitset.getNextBitSet(31) == 4095);
+        assert(bitset.getNextBitSet(4095) == 0xFFFFFFFF);
+    }
+    {
+        DynamicBitset a{1000};
+        DynamicBitset b{1337};
+        a.fill(100, 899);
+        b.fill(500, 1300);
+        DynamicBitset c = a & b;
+        assert(c.getSize() == 1337);
+        assert(c.popcount() == 400);
+        assert(c.getFirstBitSet() == 500);
+        DynamicBitset d = a | b;
+        assert(d.getSize() == 1337);
+        assert(d.popcount() == 1201);
+        assert(d.getFirstBitSet() == 100);
+
+        DynamicBitset::bitwiseAnd(a, a, b);
+        assert(a.getSize() == 1337);
+        assert(a.popcount() == 400);
+        b |= DynamicBitset{2000};
+        assert(b.getSize() == 2000);
+        assert(b.popcount() == 801);
+        assert(!b.getBit(1999));
+    }
+    {
+        // compare selected kernels against the scalar fallback
+        const auto& kernels = BitsetKernels::get();
+        const auto& scalar = BitsetKernels::scalar();
+        std::vector<uint32_t> words(131);
+        uint32_t state = 0x12345678u;
+        for(auto& word : words)
+        {
+            state = state * 1664525u + 1013904223u;
+            word = state;
+        }
+        for(uint32_t count = 0; count < words.size(); count++)
+        {
+            assert(kernels.popcount(words.data(), count) == scalar.popcount(words.data(), count));
+        }
+        std::vector<uint32_t> zeros(131, 0u);
+        for(uint32_t i = 0; i < zeros.size(); i++)
+        {
+            zeros[i] = 1u;
+            assert(kernels.findFirstWordNotEqual(zeros.data(), zeros.size(), 0u) == i);
+            zeros[i] = 0u;
+        }
+        assert(kernels.findFirstWordNotEqual(zeros.data(), zeros.size(), 0u) == zeros.size());
+    }
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <Datastructures/Pool/HandleMap.hpp>
+#include <Datastructures/Pool/Pool.hpp>
+
+#include <cassert>
+#include <string>
+
+int main()
+{
+    {
+        Pool<float> pool{4};
+        HandleMap<Handle<float>, std::string> names;
+        assert(names.empty());
+
+        auto handle0 = pool.insert(0.0f);
+        auto handle1 = pool.insert(1.0f);
+        auto handle2 = pool.insert(2.0f);
+
+        names.insert(handle0, "zero");
+        names.insert(handle2, "two");
+        assert(names.size() == 2);
+        assert(names.contains(handle0));
+        assert(!names.contains(handle1));
+        assert(*names.get(handle2) == "two");
+        assert(names.get(handle1) == nullptr);
+
+        // a new handle in the same slot must not see the old value
+        pool.remove(handle2);
+        auto handle3 = pool.insert(3.0f);
+        assert(handle3.getIndex() == handle2.getIndex());
+        assert(!names.contains(handle3));
+        assert(names.get(handle3) == nullptr);
+        names.insert(handle3, "three");
+        assert(names.size() == 2);
+        assert(!names.contains(handle2));
+        assert(*names.get(handle3) == "three");
+
+        assert(names.remove(handle0));
+        assert(!names.remove(handle0));
+        assert(names.size() == 1);
+    }
+
+    // growing + iteration
+    {
+        Pool<int> pool{2};
+        HandleMap<Handle<int>, uint32_t> map;
+        std::vector<Handle<int>> handles;
+        for(int i = 0; i < 100; i++)
+        {
+            handles.push_back(pool.insert(i));
+        }
+        for(int i = 0; i < 100; i += 2)
+        {
+            map.insert(handles[i], uint32_t(i * 10));
+        }
+        assert(map.size() == 50);
+        assert(map.capacity() >= 99);
+
+        uint32_t visited = 0;
+        for(auto iter = map.begin(); iter != map.end(); iter++)
+        {
+            assert(**iter == *pool.get(iter.asHandle()) * 10);
+            visited++;
+        }
+        assert(visited == 50);
+
+        map.clear();
+        assert(map.empty());
+        assert(map.begin() == map.end());
+        assert(map.getValues()[10] == 0);
+    }
+
+    return 0;
+}
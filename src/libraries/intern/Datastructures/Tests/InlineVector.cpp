@@ -0,0 +1,89 @@
+#include <Datastructures/InlineVector.hpp>
+#include <Datastructures/Span.hpp>
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+static int sum(Span<const int> span)
+{
+    int result = 0;
+    for(int i : span)
+        result += i;
+    return result;
+}
+
+int main()
+{
+    {
+        InlineVector<int, 4> vec;
+        assert(vec.empty());
+        assert(vec.isInline());
+        for(int i = 0; i < 4; i++)
+            vec.push_back(i);
+        assert(vec.size() == 4);
+        assert(vec.isInline());
+        assert(sum(vec) == 0 + 1 + 2 + 3);
+
+        // spill to heap
+        vec.push_back(4);
+        assert(!vec.isInline());
+        assert(vec.capacity() >= 5);
+        for(int i = 0; i < 5; i++)
+            assert(vec[i] == i);
+
+        vec.erase(vec.begin() + 1);
+        assert(vec.size() == 4);
+        assert(vec[0] == 0 && vec[1] == 2 && vec[2] == 3 && vec[3] == 4);
+
+        Span<int> span = vec;
+        span[0] = 10;
+        assert(vec[0] == 10);
+    }
+    {
+        // non trivial types, copy and move in both storage modes
+        InlineVector<std::string, 2> small{"a", "b"};
+        InlineVector<std::string, 2> copy = small;
+        assert(copy.isInline() && copy.size() == 2 && copy[1] == "b");
+        InlineVector<std::string, 2> moved = std::move(small);
+        assert(moved.isInline() && moved.size() == 2 && moved[0] == "a");
+        assert(small.empty()); // NOLINT
+
+        InlineVector<std::string, 2> large{"a", "b", "c"};
+        assert(!large.isInline());
+        const std::string* heapData = large.data();
+        InlineVector<std::string, 2> stolen = std::move(large);
+        assert(stolen.data() == heapData);
+        assert(large.empty() && large.isInline()); // NOLINT
+
+        copy = stolen;
+        assert(copy.size() == 3 && copy[2] == "c");
+        copy = InlineVector<std::string, 2>{"x"};
+        assert(copy.size() == 1 && copy.back() == "x");
+        copy.pop_back();
+        assert(copy.empty());
+    }
+    {
+        std::vector<int> source{1, 2, 3};
+        InlineVector<int, 8> fromRange{source.begin(), source.end()};
+        assert(fromRange.size() == 3 && fromRange.isInline());
+        fromRange.resize(6, 7);
+        assert(fromRange.size() == 6 && fromRange[5] == 7);
+        fromRange.resize(2);
+        assert(fromRange.size() == 2 && fromRange[1] == 2);
+    }
+    {
+        // elements must be destroyed exactly once
+        auto counter = std::make_shared<int>(0);
+        {
+            InlineVector<std::shared_ptr<int>, 2> ptrs;
+            for(int i = 0; i < 5; i++)
+                ptrs.push_back(counter);
+            assert(counter.use_count() == 6);
+            InlineVector<std::shared_ptr<int>, 2> other = std::move(ptrs);
+            assert(counter.use_count() == 6);
+        }
+        assert(counter.use_count() == 1);
+    }
+}
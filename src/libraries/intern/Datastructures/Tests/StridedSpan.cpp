@@ -0,0 +1,61 @@
+#include <Datastructures/StridedSpan.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+struct Vertex
+{
+    float position[3];
+    float uv[2];
+};
+
+int main()
+{
+    std::vector<Vertex> vertices{
+        {{0.0f, 1.0f, 2.0f}, {0.5f, 0.25f}},
+        {{3.0f, 4.0f, 5.0f}, {0.75f, 1.0f}},
+        {{6.0f, 7.0f, 8.0f}, {0.0f, 0.0f}},
+    };
+    struct Float2
+    {
+        float x, y;
+    };
+
+    {
+        // interleaved
+        StridedSpan<const Float2> uvs{
+            reinterpret_cast<const std::byte*>(vertices.data()) + offsetof(Vertex, uv),
+            vertices.size(),
+            sizeof(Vertex)};
+        assert(uvs.size() == 3);
+        assert(!uvs.isTightlyPacked());
+        assert(uvs[1].x == 0.75f && uvs[1].y == 1.0f);
+        assert(uvs[2].x == 0.0f);
+    }
+    {
+        // writing
+        StridedSpan<Float2> uvs{
+            reinterpret_cast<std::byte*>(vertices.data()) + offsetof(Vertex, uv), vertices.size(), sizeof(Vertex)};
+        uvs.set(2, {9.0f, 10.0f});
+        assert(vertices[2].uv[0] == 9.0f && vertices[2].uv[1] == 10.0f);
+        assert(vertices[2].position[2] == 8.0f);
+    }
+    {
+        // tightly packed, stride 0 means sizeof(T)
+        std::vector<uint32_t> indices{0, 1, 2, 2, 1, 3};
+        StridedSpan<const uint32_t> view{reinterpret_cast<const std::byte*>(indices.data()), indices.size()};
+        assert(view.isTightlyPacked());
+        assert(view.isContiguous());
+        assert(view.stride() == sizeof(uint32_t));
+        Span<const uint32_t> span = view.asSpan();
+        assert(span.data() == indices.data());
+        assert(span.size() == indices.size());
+        assert(view[5] == 3);
+
+        // packed but misaligned, still readable element wise
+        StridedSpan<const uint32_t> shifted{reinterpret_cast<const std::byte*>(indices.data()) + 2, 2};
+        assert(shifted.isTightlyPacked());
+        assert(!shifted.isContiguous());
+    }
+}
@@ -1,13 +1,17 @@
+#pragma once
+
 /*
     based on:
         https://stackoverflow.com/a/32593825
 */
 
+#include <algorithm>
 #include <condition_variable>
 #include <functional>
 #include <future>
 #include <mutex>
 #include <queue>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -44,6 +48,12 @@ class ThreadPool
 
     inline uint32_t amountOfThreads() const { return threads.size(); }
 
+    /*
+        std::thread::hardware_concurrency(), but at least 2 (main thread + one pool thread)
+        hardware_concurrency() returns 0 if it cant tell, so use this to size anything per thread
+    */
+    static uint32_t hardwareThreadCount() { return std::max(2u, std::thread::hardware_concurrency()); }
+
     int getThreadPoolThreadIndex();
 
     /*
@@ -5,7 +5,7 @@ Application::Application(CreateInfo&& info)
 {
     // ensure global services are initialized in correct order
 
-    gfxDevice.init(mainWindow.glfwWindow);
+    gfxDevice.init(mainWindow.glfwWindow, info.deviceConfig);
 
     resourceManager.init();
 }
@@ -16,6 +16,7 @@ class Application
         int windowWidth = 1280;
         int windowHeight = 720;
         Span<const Window::WindowHint> windowHints = {};
+        VulkanDevice::Config deviceConfig = {};
     };
     explicit Application(CreateInfo&& info);
     virtual ~Application();
@@ -0,0 +1,164 @@
+#include <Engine/Graphics/Mesh/AttributeDecode.hpp>
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/*
+    Compares the selected kernels against the scalar reference on a large mesh
+    (interleaved positions, octahedral-style snorm16 normals, unorm16 uvs and uint16 indices
+    like KHR_mesh_quantization produces), prints the timings and checks that both produce the same output
+    Not registered with ctest, build and run the EngineBenchmarkAttributeDecode target by hand
+*/
+
+using namespace AttributeDecode;
+
+namespace
+{
+    constexpr size_t vertexCount = 2'000'000;
+    constexpr size_t indexCount = vertexCount * 3;
+    constexpr int iterations = 5;
+
+    struct QuantizedVertex
+    {
+        float position[3];
+        int16_t normal[4];
+        uint16_t uv[2];
+    };
+
+    // same layout as Mesh::BasicVertexAttributes<0>
+    struct Attributes
+    {
+        float normal[3];
+        float color[3];
+        float uv[2];
+    };
+
+    struct Result
+    {
+        double positions = 0.0;
+        double normals = 0.0;
+        double uvs = 0.0;
+        double indices = 0.0;
+    };
+
+    template <typename F>
+    double measure(F&& func)
+    {
+        double best = 1e30;
+        for(int i = 0; i < iterations; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            func();
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+
+    Result run(
+        const Table& table,
+        const std::vector<QuantizedVertex>& vertices,
+        const std::vector<uint16_t>& indices,
+        std::vector<float>& positions,
+        std::vector<Attributes>& attributes,
+        std::vector<uint32_t>& widened)
+    {
+        const auto* vertexBytes = reinterpret_cast<const std::byte*>(vertices.data());
+        Result result;
+        result.positions = measure(
+            [&]()
+            {
+                table.copyStrided(
+                    reinterpret_cast<std::byte*>(positions.data()),
+                    sizeof(float) * 3,
+                    vertexBytes + offsetof(QuantizedVertex, position),
+                    sizeof(QuantizedVertex),
+                    sizeof(float) * 3,
+                    vertices.size());
+            });
+        result.normals = measure(
+            [&]()
+            {
+                table.toFloat(
+                    attributes[0].normal,
+                    sizeof(Attributes),
+                    Source{
+                        .data = vertexBytes + offsetof(QuantizedVertex, normal),
+                        .stride = sizeof(QuantizedVertex),
+                        .count = vertices.size(),
+                        .componentType = ComponentType::Int16,
+                        .componentCount = 3,
+                        .normalized = true});
+            });
+        result.uvs = measure(
+            [&]()
+            {
+                table.toFloat(
+                    attributes[0].uv,
+                    sizeof(Attributes),
+                    Source{
+                        .data = vertexBytes + offsetof(QuantizedVertex, uv),
+                        .stride = sizeof(QuantizedVertex),
+                        .count = vertices.size(),
+                        .componentType = ComponentType::UInt16,
+                        .componentCount = 2,
+                        .normalized = true});
+            });
+        result.indices = measure(
+            [&]()
+            {
+                table.widenIndices(
+                    widened.data(),
+                    reinterpret_cast<const std::byte*>(indices.data()),
+                    ComponentType::UInt16,
+                    indices.size());
+            });
+        return result;
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 rng{42};
+    std::vector<QuantizedVertex> vertices(vertexCount);
+    for(auto& v : vertices)
+    {
+        for(float& p : v.position)
+            p = static_cast<float>(rng() % 10000) * 0.01f;
+        for(int16_t& n : v.normal)
+            n = static_cast<int16_t>(rng());
+        for(uint16_t& uv : v.uv)
+            uv = static_cast<uint16_t>(rng());
+    }
+    std::vector<uint16_t> indices(indexCount);
+    for(auto& i : indices)
+        i = static_cast<uint16_t>(rng());
+
+    std::vector<float> positionsRef(vertexCount * 3);
+    std::vector<float> positions(vertexCount * 3);
+    std::vector<Attributes> attributesRef(vertexCount);
+    std::vector<Attributes> attributes(vertexCount);
+    std::vector<uint32_t> indicesRef(indexCount);
+    std::vector<uint32_t> widened(indexCount);
+
+    const Result ref = run(scalar(), vertices, indices, positionsRef, attributesRef, widened);
+    indicesRef = widened;
+    const Result fast = run(get(), vertices, indices, positions, attributes, widened);
+
+    assert(positionsRef == positions);
+    assert(std::memcmp(attributesRef.data(), attributes.data(), attributes.size() * sizeof(Attributes)) == 0);
+    assert(indicesRef == widened);
+
+    printf("%zu vertices, %zu indices, best of %d runs\n", vertexCount, indexCount, iterations);
+    printf("%-24s %10s %10s %8s\n", "", scalar().name, get().name, "speedup");
+    const auto print = [](const char* name, double a, double b)
+    { printf("%-24s %8.2fms %8.2fms %7.2fx\n", name, a, b, a / b); };
+    print("positions (gather)", ref.positions, fast.positions);
+    print("normals (snorm16x3)", ref.normals, fast.normals);
+    print("uvs (unorm16x2)", ref.uvs, fast.uvs);
+    print("indices (uint16)", ref.indices, fast.indices);
+}
@@ -187,6 +187,11 @@ float Camera::getAspect() const
     return aspect;
 }
 
+float Camera::getFov() const
+{
+    return fov;
+}
+
 float Camera::getNear() const
 {
     return cam_near;
@@ -46,6 +46,8 @@ class Camera
     const std::array<glm::mat4, 6>& getMatrices();
 
     float getAspect() const;
+    // vertical, in radians
+    float getFov() const;
     float getNear() const;
     float getFar() const;
     Mode getMode() const;
@@ -0,0 +1,607 @@
+#include "BVH.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <execution>
+#include <numeric>
+#include <ranges>
+
+namespace
+{
+    constexpr uint32_t NoParent = 0xFFFFFFFF;
+    constexpr uint32_t binCount = 12;
+    // nodes with fewer items get built as independent subtrees, in parallel
+    constexpr uint32_t subtreeSize = 8192;
+    // Below this amount of items per job the overhead of going wide is larger than the work itself
+    constexpr uint32_t itemsPerJob = 16384;
+    // SAH cost of visiting a node, relative to testing one item
+    constexpr float traversalCost = 1.0f;
+
+    float surfaceArea(const Bounds::AABB& box)
+    {
+        if(box.isEmpty())
+            return 0.0f;
+        const float dx = box.max[0] - box.min[0];
+        const float dy = box.max[1] - box.min[1];
+        const float dz = box.max[2] - box.min[2];
+        return 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+
+    bool overlaps(const Bounds::AABB& a, const Bounds::AABB& b)
+    {
+        for(int c = 0; c < 3; c++)
+        {
+            if(a.max[c] < b.min[c] || a.min[c] > b.max[c])
+                return false;
+        }
+        return true;
+    }
+
+    bool overlapsSphere(const Bounds::AABB& box, const float center[3], float radius)
+    {
+        if(box.isEmpty())
+            return false;
+        float distanceSq = 0.0f;
+        for(int c = 0; c < 3; c++)
+        {
+            const float d = center[c] - std::clamp(center[c], box.min[c], box.max[c]);
+            distanceSq += d * d;
+        }
+        return distanceSq <= radius * radius;
+    }
+
+    // entry distance of the ray into the box, infinity on a miss
+    float rayEntry(
+        const Bounds::AABB& box, const float origin[3], const float inverseDirection[3], float maxDistance)
+    {
+        float tMin = 0.0f;
+        float tMax = maxDistance;
+        for(int c = 0; c < 3; c++)
+        {
+            // fmin/fmax drop the NaNs of 0 * inf when the origin is on a slab with a parallel direction
+            const float t1 = (box.min[c] - origin[c]) * inverseDirection[c];
+            const float t2 = (box.max[c] - origin[c]) * inverseDirection[c];
+            tMin = std::fmax(tMin, std::fmin(t1, t2));
+            tMax = std::fmin(tMax, std::fmax(t1, t2));
+        }
+        return tMin <= tMax ? tMin : std::numeric_limits<float>::infinity();
+    }
+
+    // node against the planes still set in planeMask: -1 outside, otherwise the planes it still intersects
+    int frustumMask(const Culling::Frustum& frustum, const Bounds::AABB& box, int planeMask)
+    {
+        float center[3];
+        float extent[3];
+        for(int c = 0; c < 3; c++)
+        {
+            center[c] = (box.min[c] + box.max[c]) * 0.5f;
+            extent[c] = (box.max[c] - box.min[c]) * 0.5f;
+        }
+        int result = 0;
+        for(int p = 0; p < 6; p++)
+        {
+            if((planeMask & (1 << p)) == 0)
+                continue;
+            const float* plane = frustum.planes[p];
+            const float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+            const float radius = std::abs(plane[0]) * extent[0] + std::abs(plane[1]) * extent[1] +
+                                 std::abs(plane[2]) * extent[2];
+            if(distance + radius < 0.0f)
+                return -1;
+            if(distance - radius < 0.0f)
+                result |= 1 << p;
+        }
+        return result;
+    }
+
+    struct Bin
+    {
+        Bounds::AABB bounds;
+        uint32_t count = 0;
+    };
+
+    // node bounds and the bounds of the item centroids
+    struct RangeBounds
+    {
+        Bounds::AABB bounds;
+        Bounds::AABB centroidBounds;
+
+        void merge(const RangeBounds& other)
+        {
+            bounds.merge(other.bounds);
+            centroidBounds.merge(other.centroidBounds);
+        }
+    };
+
+    template <typename Result, typename ChunkFunc>
+    Result reduceChunks(uint32_t count, bool parallel, ChunkFunc&& chunkFunc)
+    {
+        const uint32_t jobCount = parallel ? (count + itemsPerJob - 1) / itemsPerJob : 1;
+        if(jobCount < 2)
+            return chunkFunc(0, count);
+        std::vector<Result> results(jobCount);
+        std::ranges::iota_view jobs(0u, jobCount);
+        std::for_each(
+            std::execution::par,
+            jobs.begin(),
+            jobs.end(),
+            [&](uint32_t job)
+            {
+                const uint32_t begin = job * itemsPerJob;
+                results[job] = chunkFunc(begin, std::min(begin + itemsPerJob, count));
+            });
+        for(uint32_t job = 1; job < jobCount; job++)
+            results[0].merge(results[job]);
+        return results[0];
+    }
+} // namespace
+
+struct BVH::BuildTask
+{
+    uint32_t node;
+    uint32_t first;
+    uint32_t count;
+};
+
+void BVH::clear()
+{
+    nodes.clear();
+    items.clear();
+    itemBounds.clear();
+    itemSlots.clear();
+    itemLeaves.clear();
+    parents.clear();
+    itemDirty.clear();
+    nodeDirty.clear();
+}
+
+uint32_t BVH::splitNode(Node& node, uint32_t first, uint32_t count, bool parallelBinning)
+{
+    const auto centroid = [&](uint32_t item, int axis) { return centroids[item * 3 + axis]; };
+
+    const RangeBounds range = reduceChunks<RangeBounds>(
+        count,
+        parallelBinning,
+        [&](uint32_t begin, uint32_t end)
+        {
+            RangeBounds result;
+            for(uint32_t i = first + begin; i < first + end; i++)
+            {
+                const uint32_t item = items[i];
+                result.bounds.merge(itemBounds[item]);
+                const float c[3] = {centroid(item, 0), centroid(item, 1), centroid(item, 2)};
+                result.centroidBounds.merge({.min = {c[0], c[1], c[2]}, .max = {c[0], c[1], c[2]}});
+            }
+            return result;
+        });
+    node.bounds = range.bounds;
+    if(count <= 1)
+        return 0;
+
+    const Bounds::AABB& centroidBounds = range.centroidBounds;
+    int axis = 0;
+    for(int c = 1; c < 3; c++)
+    {
+        if(centroidBounds.max[c] - centroidBounds.min[c] > centroidBounds.max[axis] - centroidBounds.min[axis])
+            axis = c;
+    }
+    const float axisMin = centroidBounds.min[axis];
+    const float axisExtent = centroidBounds.max[axis] - axisMin;
+
+    const auto medianSplit = [&]()
+    {
+        const uint32_t half = count / 2;
+        std::nth_element(
+            items.begin() + first,
+            items.begin() + first + half,
+            items.begin() + first + count,
+            [&](uint32_t a, uint32_t b) { return centroid(a, axis) < centroid(b, axis); });
+        return half;
+    };
+
+    // all centroids in one spot, binning cant separate them
+    if(!(axisExtent > 0.0f))
+        return count <= maxLeafSize ? 0 : medianSplit();
+
+    const float binScale = float(binCount) / axisExtent;
+    const auto binOf = [&](uint32_t item)
+    { return std::min(uint32_t((centroid(item, axis) - axisMin) * binScale), binCount - 1); };
+
+    struct Bins
+    {
+        Bin bins[binCount];
+
+        void merge(const Bins& other)
+        {
+            for(uint32_t b = 0; b < binCount; b++)
+            {
+                bins[b].bounds.merge(other.bins[b].bounds);
+                bins[b].count += other.bins[b].count;
+            }
+        }
+    };
+    const Bins bins = reduceChunks<Bins>(
+        count,
+        parallelBinning,
+        [&](uint32_t begin, uint32_t end)
+        {
+            Bins result;
+            for(uint32_t i = first + begin; i < first + end; i++)
+            {
+                Bin& bin = result.bins[binOf(items[i])];
+                bin.bounds.merge(itemBounds[items[i]]);
+                bin.count++;
+            }
+            return result;
+        });
+
+    // sweep from the right to get the costs of all right sides, then from the left to find the best split
+    float rightCosts[binCount];
+    Bounds::AABB accumulated;
+    uint32_t accumulatedCount = 0;
+    for(uint32_t b = binCount - 1; b > 0; b--)
+    {
+        accumulated.merge(bins.bins[b].bounds);
+        accumulatedCount += bins.bins[b].count;
+        rightCosts[b] = surfaceArea(accumulated) * float(accumulatedCount);
+    }
+    float bestCost = std::numeric_limits<float>::max();
+    uint32_t bestSplit = 0;
+    accumulated = {};
+    accumulatedCount = 0;
+    for(uint32_t split = 1; split < binCount; split++)
+    {
+        accumulated.merge(bins.bins[split - 1].bounds);
+        accumulatedCount += bins.bins[split - 1].count;
+        const float cost = surfaceArea(accumulated) * float(accumulatedCount) + rightCosts[split];
+        if(accumulatedCount > 0 && accumulatedCount < count && cost < bestCost)
+        {
+            bestCost = cost;
+            bestSplit = split;
+        }
+    }
+
+    const float nodeArea = surfaceArea(node.bounds);
+    const float leafCost = float(count);
+    const float splitCost = nodeArea > 0.0f ? traversalCost + bestCost / nodeArea : traversalCost;
+    if(count <= maxLeafSize && (bestSplit == 0 || splitCost >= leafCost))
+        return 0;
+    if(bestSplit == 0)
+        return medianSplit();
+
+    const auto middle = std::partition(
+        items.begin() + first,
+        items.begin() + first + count,
+        [&](uint32_t item) { return binOf(item) < bestSplit; });
+    return static_cast<uint32_t>(std::distance(items.begin() + first, middle));
+}
+
+void BVH::buildSubtree(std::vector<Node>& subtreeNodes, uint32_t first, uint32_t count)
+{
+    subtreeNodes.emplace_back();
+    std::vector<BuildTask> stack{{.node = 0, .first = first, .count = count}};
+    while(!stack.empty())
+    {
+        const BuildTask task = stack.back();
+        stack.pop_back();
+        const uint32_t leftCount = splitNode(subtreeNodes[task.node], task.first, task.count, false);
+        if(leftCount == 0)
+        {
+            subtreeNodes[task.node].firstOrChild = task.first;
+            subtreeNodes[task.node].itemCount = task.count;
+            continue;
+        }
+        const auto child = static_cast<uint32_t>(subtreeNodes.size());
+        subtreeNodes[task.node].firstOrChild = child;
+        subtreeNodes.resize(subtreeNodes.size() + 2);
+        stack.push_back({.node = child, .first = task.first, .count = leftCount});
+        stack.push_back({.node = child + 1, .first = task.first + leftCount, .count = task.count - leftCount});
+    }
+}
+
+void BVH::build(Span<const Bounds::AABB> inputBounds)
+{
+    clear();
+    const auto itemCount = static_cast<uint32_t>(inputBounds.size());
+    if(itemCount == 0)
+        return;
+
+    // indexed by item during the build, sorted into leaf order at the end
+    itemBounds.assign(inputBounds.begin(), inputBounds.end());
+    items.resize(itemCount);
+    std::iota(items.begin(), items.end(), 0);
+    centroids.resize(size_t(itemCount) * 3);
+    for(uint32_t item = 0; item < itemCount; item++)
+    {
+        const Bounds::AABB& box = itemBounds[item];
+        for(int c = 0; c < 3; c++)
+            centroids[item * 3 + c] = box.isEmpty() ? 0.0f : (box.min[c] + box.max[c]) * 0.5f;
+    }
+
+    // top of the tree, until the remaining nodes are small enough to be built independently
+    nodes.emplace_back();
+    std::vector<BuildTask> stack{{.node = 0, .first = 0, .count = itemCount}};
+    std::vector<BuildTask> subtrees;
+    while(!stack.empty())
+    {
+        const BuildTask task = stack.back();
+        stack.pop_back();
+        if(task.count <= subtreeSize)
+        {
+            subtrees.push_back(task);
+            continue;
+        }
+        const uint32_t leftCount = splitNode(nodes[task.node], task.first, task.count, true);
+        // large nodes always get split, see splitNode
+        assert(leftCount > 0);
+        const auto child = static_cast<uint32_t>(nodes.size());
+        nodes[task.node].firstOrChild = child;
+        nodes.resize(nodes.size() + 2);
+        stack.push_back({.node = child, .first = task.first, .count = leftCount});
+        stack.push_back({.node = child + 1, .first = task.first + leftCount, .count = task.count - leftCount});
+    }
+
+    std::vector<std::vector<Node>> subtreeNodes(subtrees.size());
+    std::ranges::iota_view jobs(0u, static_cast<uint32_t>(subtrees.size()));
+    std::for_each(
+        std::execution::par,
+        jobs.begin(),
+        jobs.end(),
+        [&](uint32_t job) { buildSubtree(subtreeNodes[job], subtrees[job].first, subtrees[job].count); });
+
+    // subtree roots replace their placeholders, all other nodes get appended
+    for(uint32_t job = 0; job < subtrees.size(); job++)
+    {
+        const std::vector<Node>& subtree = subtreeNodes[job];
+        const auto base = static_cast<uint32_t>(nodes.size());
+        const auto remap = [base](Node node)
+        {
+            if(!node.isLeaf())
+                node.firstOrChild = base + node.firstOrChild - 1;
+            return node;
+        };
+        nodes[subtrees[job].node] = remap(subtree[0]);
+        for(size_t i = 1; i < subtree.size(); i++)
+            nodes.push_back(remap(subtree[i]));
+    }
+    centroids.clear();
+
+    parents.assign(nodes.size(), NoParent);
+    itemSlots.resize(itemCount);
+    itemLeaves.resize(itemCount);
+    std::vector<Bounds::AABB> slotBounds(itemCount);
+    for(uint32_t node = 0; node < nodes.size(); node++)
+    {
+        const Node& n = nodes[node];
+        if(!n.isLeaf())
+        {
+            parents[n.firstOrChild] = node;
+            parents[n.firstOrChild + 1] = node;
+            continue;
+        }
+        assert(n.itemCount <= maxLeafSize);
+        for(uint32_t slot = n.firstOrChild; slot < n.firstOrChild + n.itemCount; slot++)
+        {
+            itemSlots[items[slot]] = slot;
+            itemLeaves[items[slot]] = node;
+            slotBounds[slot] = itemBounds[items[slot]];
+        }
+    }
+    itemBounds = std::move(slotBounds);
+    itemDirty.assign(itemCount, 0);
+    nodeDirty.assign(nodes.size(), 0);
+}
+
+void BVH::updateItem(uint32_t item, const Bounds::AABB& bounds)
+{
+    assert(item < itemSlots.size());
+    itemBounds[itemSlots[item]] = bounds;
+    itemDirty[item] = 1;
+}
+
+void BVH::refit()
+{
+    // marking is cheap compared to walking the tree, only the marked paths get recomputed
+    dirtyNodes.clear();
+    for(uint32_t item = 0; item < itemDirty.size(); item++)
+    {
+        if(!itemDirty[item])
+            continue;
+        itemDirty[item] = 0;
+        for(uint32_t node = itemLeaves[item]; node != NoParent && !nodeDirty[node]; node = parents[node])
+        {
+            nodeDirty[node] = 1;
+            dirtyNodes.push_back(node);
+        }
+    }
+    // children come after their parents, so going backwards updates them first
+    std::sort(dirtyNodes.begin(), dirtyNodes.end(), std::greater<>());
+    for(const uint32_t node : dirtyNodes)
+    {
+        Node& n = nodes[node];
+        n.bounds = {};
+        if(n.isLeaf())
+        {
+            for(uint32_t slot = n.firstOrChild; slot < n.firstOrChild + n.itemCount; slot++)
+                n.bounds.merge(itemBounds[slot]);
+        }
+        else
+        {
+            n.bounds.merge(nodes[n.firstOrChild].bounds);
+            n.bounds.merge(nodes[n.firstOrChild + 1].bounds);
+        }
+        nodeDirty[node] = 0;
+    }
+}
+
+void BVH::collectItems(uint32_t node, std::vector<uint32_t>& result) const
+{
+    std::vector<uint32_t> stack{node};
+    while(!stack.empty())
+    {
+        const Node& n = nodes[stack.back()];
+        stack.pop_back();
+        if(!n.isLeaf())
+        {
+            stack.push_back(n.firstOrChild + 1);
+            stack.push_back(n.firstOrChild);
+            continue;
+        }
+        for(uint32_t slot = n.firstOrChild; slot < n.firstOrChild + n.itemCount; slot++)
+        {
+            if(!itemBounds[slot].isEmpty())
+                result.push_back(items[slot]);
+        }
+    }
+}
+
+void BVH::queryFrustum(const Culling::Frustum& frustum, std::vector<uint32_t>& result) const
+{
+    if(nodes.empty())
+        return;
+    struct Entry
+    {
+        uint32_t node;
+        int planeMask;
+    };
+    std::vector<Entry> stack{{.node = 0, .planeMask = 0b111111}};
+    while(!stack.empty())
+    {
+        const Entry entry = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[entry.node];
+        const int planeMask = frustumMask(frustum, node.bounds, entry.planeMask);
+        if(planeMask < 0)
+            continue;
+        // completely inside, nothing below needs to be tested anymore
+        if(planeMask == 0)
+        {
+            collectItems(entry.node, result);
+            continue;
+        }
+        if(!node.isLeaf())
+        {
+            stack.push_back({.node = node.firstOrChild + 1, .planeMask = planeMask});
+            stack.push_back({.node = node.firstOrChild, .planeMask = planeMask});
+            continue;
+        }
+        uint32_t visibleSlots[maxLeafSize];
+        const uint32_t visibleCount = Culling::cullAABBs(
+            frustum, {&itemBounds[node.firstOrChild], node.itemCount}, node.firstOrChild, visibleSlots);
+        for(uint32_t i = 0; i < visibleCount; i++)
+            result.push_back(items[visibleSlots[i]]);
+    }
+}
+
+void BVH::queryAABB(const Bounds::AABB& box, std::vector<uint32_t>& result) const
+{
+    if(nodes.empty() || box.isEmpty())
+        return;
+    std::vector<uint32_t> stack{0};
+    while(!stack.empty())
+    {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if(node.bounds.isEmpty() || !overlaps(node.bounds, box))
+            continue;
+        if(!node.isLeaf())
+        {
+            stack.push_back(node.firstOrChild + 1);
+            stack.push_back(node.firstOrChild);
+            continue;
+        }
+        for(uint32_t slot = node.firstOrChild; slot < node.firstOrChild + node.itemCount; slot++)
+        {
+            if(!itemBounds[slot].isEmpty() && overlaps(itemBounds[slot], box))
+                result.push_back(items[slot]);
+        }
+    }
+}
+
+void BVH::querySphere(const float center[3], float radius, std::vector<uint32_t>& result) const
+{
+    if(nodes.empty())
+        return;
+    std::vector<uint32_t> stack{0};
+    while(!stack.empty())
+    {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if(!overlapsSphere(node.bounds, center, radius))
+            continue;
+        if(!node.isLeaf())
+        {
+            stack.push_back(node.firstOrChild + 1);
+            stack.push_back(node.firstOrChild);
+            continue;
+        }
+        for(uint32_t slot = node.firstOrChild; slot < node.firstOrChild + node.itemCount; slot++)
+        {
+            if(overlapsSphere(itemBounds[slot], center, radius))
+                result.push_back(items[slot]);
+        }
+    }
+}
+
+BVH::RayHit BVH::raycast(
+    const float origin[3],
+    const float direction[3],
+    float maxDistance,
+    const std::function<float(uint32_t item)>& intersectItem) const
+{
+    RayHit hit;
+    if(nodes.empty())
+        return hit;
+    const float inverseDirection[3] = {1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2]};
+    const auto entry = [&](const Bounds::AABB& box)
+    {
+        return box.isEmpty() ? std::numeric_limits<float>::infinity()
+                             : rayEntry(box, origin, inverseDirection, maxDistance);
+    };
+
+    struct Entry
+    {
+        uint32_t node;
+        float distance;
+    };
+    std::vector<Entry> stack;
+    const float rootDistance = entry(nodes[0].bounds);
+    if(rootDistance <= maxDistance)
+        stack.push_back({.node = 0, .distance = rootDistance});
+    while(!stack.empty())
+    {
+        const Entry current = stack.back();
+        stack.pop_back();
+        // something closer got hit since this was pushed
+        if(current.distance >= hit.distance)
+            continue;
+        const Node& node = nodes[current.node];
+        if(node.isLeaf())
+        {
+            for(uint32_t slot = node.firstOrChild; slot < node.firstOrChild + node.itemCount; slot++)
+            {
+                float distance = entry(itemBounds[slot]);
+                if(distance >= hit.distance)
+                    continue;
+                if(intersectItem)
+                    distance = intersectItem(items[slot]);
+                if(distance < hit.distance && distance <= maxDistance)
+                    hit = {.item = items[slot], .distance = distance};
+            }
+            continue;
+        }
+        // closer child gets popped first
+        Entry children[2] = {
+            {.node = node.firstOrChild, .distance = entry(nodes[node.firstOrChild].bounds)},
+            {.node = node.firstOrChild + 1, .distance = entry(nodes[node.firstOrChild + 1].bounds)}};
+        if(children[0].distance < children[1].distance)
+            std::swap(children[0], children[1]);
+        for(const Entry& child : children)
+        {
+            if(child.distance < hit.distance)
+                stack.push_back(child);
+        }
+    }
+    return hit;
+}
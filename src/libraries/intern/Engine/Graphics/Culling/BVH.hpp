@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Frustum.hpp"
+
+#include <Datastructures/Span.hpp>
+#include <Engine/Graphics/Mesh/Bounds.hpp>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+/*
+    Bounding volume hierarchy over the world space bounds of items (scene instances), for culling, picking
+    and range queries without touching every item
+        - build() uses binned SAH splits. The top of the tree gets split serially (with the binning of large
+          nodes going wide), the remaining subtrees are independent and get built in parallel
+        - updateItem() only stores the new bounds and marks the item, refit() then recomputes just the leaves
+          of marked items and their ancestors. The topology stays the same, so after a lot of movement the
+          tree gets worse and should be rebuilt
+        - Nodes are stored depth first, children always come after their parent and siblings are next to
+          each other
+    Items are identified by their index in the bounds passed to build()
+*/
+class BVH
+{
+  public:
+    static constexpr uint32_t NoItem = 0xFFFFFFFF;
+    static constexpr uint32_t maxLeafSize = 4;
+
+    struct Node
+    {
+        Bounds::AABB bounds;
+        // leaf: first entry in the item order, otherwise index of the left child (right one is next to it)
+        uint32_t firstOrChild = 0;
+        // 0 for inner nodes
+        uint32_t itemCount = 0;
+
+        [[nodiscard]] bool isLeaf() const { return itemCount > 0; }
+    };
+
+    void build(Span<const Bounds::AABB> itemBounds);
+    void clear();
+
+    /*
+        Thread safe as long as every thread updates different items, so it can be called from inside
+        the parallel transform update. Takes effect with the next refit()
+    */
+    void updateItem(uint32_t item, const Bounds::AABB& bounds);
+    void refit();
+
+    // Appends all items whose bounds are (conservatively) visible, see Culling::cullAABBs
+    void queryFrustum(const Culling::Frustum& frustum, std::vector<uint32_t>& result) const;
+    // Appends all items whose bounds overlap the box
+    void queryAABB(const Bounds::AABB& box, std::vector<uint32_t>& result) const;
+    // Appends all items whose bounds overlap the sphere
+    void querySphere(const float center[3], float radius, std::vector<uint32_t>& result) const;
+
+    struct RayHit
+    {
+        uint32_t item = NoItem;
+        float distance = std::numeric_limits<float>::infinity();
+    };
+    /*
+        Closest item along the ray, direction doesnt have to be normalized (distances are in units of it)
+        intersectItem can refine the hit with the actual geometry: it gets called for every item whose bounds
+        get hit before the closest hit so far and returns the hit distance, or infinity for a miss
+        Without it, the entry distance into the items bounds is used
+    */
+    RayHit raycast(
+        const float origin[3],
+        const float direction[3],
+        float maxDistance = std::numeric_limits<float>::infinity(),
+        const std::function<float(uint32_t item)>& intersectItem = {}) const;
+
+    [[nodiscard]] Span<const Node> getNodes() const { return nodes; }
+    [[nodiscard]] uint32_t itemCount() const { return static_cast<uint32_t>(items.size()); }
+    [[nodiscard]] const Bounds::AABB& getItemBounds(uint32_t item) const { return itemBounds[itemSlots[item]]; }
+
+  private:
+    struct BuildTask;
+    void buildSubtree(std::vector<Node>& subtreeNodes, uint32_t first, uint32_t count);
+    uint32_t splitNode(Node& node, uint32_t first, uint32_t count, bool parallelBinning);
+    void collectItems(uint32_t node, std::vector<uint32_t>& result) const;
+
+    std::vector<Node> nodes;
+    // item order of the leaves, and the item bounds in that same order so leaves are contiguous
+    std::vector<uint32_t> items;
+    std::vector<Bounds::AABB> itemBounds;
+    // where each item ended up in items, and the leaf containing it
+    std::vector<uint32_t> itemSlots;
+    std::vector<uint32_t> itemLeaves;
+    std::vector<uint32_t> parents;
+
+    // bytes instead of a bitset, so threads can write flags of neighbouring items
+    std::vector<uint8_t> itemDirty;
+    std::vector<uint8_t> nodeDirty;
+    std::vector<uint32_t> dirtyNodes;
+    // only used during build()
+    std::vector<float> centroids;
+};
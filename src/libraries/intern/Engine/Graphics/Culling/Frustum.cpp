@@ -0,0 +1,159 @@
+#include "Frustum.hpp"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define CULLING_SSE2
+    #include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    #define CULLING_NEON
+    #include <arm_neon.h>
+#endif
+
+/*
+    Boxes are tested as center +- extent: a box is outside of a plane if even its corner furthest along
+    the plane normal is behind it, that is if dot(n, center) + w + dot(abs(n), extent) < 0
+*/
+
+namespace Culling
+{
+    Frustum extractFrustum(const float* projView)
+    {
+        // row i of the matrix, column major storage
+        const auto row = [projView](int i, int c) { return projView[c * 4 + i]; };
+
+        Frustum frustum;
+        for(int c = 0; c < 4; c++)
+        {
+            // -w <= x <= w, -w <= y <= w, 0 <= z <= w
+            frustum.planes[0][c] = row(3, c) + row(0, c);
+            frustum.planes[1][c] = row(3, c) - row(0, c);
+            frustum.planes[2][c] = row(3, c) + row(1, c);
+            frustum.planes[3][c] = row(3, c) - row(1, c);
+            frustum.planes[4][c] = row(2, c);
+            frustum.planes[5][c] = row(3, c) - row(2, c);
+        }
+        for(float* plane : frustum.planes)
+        {
+            const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            for(int c = 0; c < 4; c++)
+                plane[c] /= length;
+        }
+        return frustum;
+    }
+
+    bool isVisible(const Frustum& frustum, const Bounds::AABB& aabb)
+    {
+        float center[3];
+        float extent[3];
+        for(int c = 0; c < 3; c++)
+        {
+            center[c] = (aabb.min[c] + aabb.max[c]) * 0.5f;
+            extent[c] = (aabb.max[c] - aabb.min[c]) * 0.5f;
+            if(extent[c] < 0.0f)
+                return false;
+        }
+        for(const float* plane : frustum.planes)
+        {
+            const float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+            const float radius = std::abs(plane[0]) * extent[0] + std::abs(plane[1]) * extent[1] +
+                                 std::abs(plane[2]) * extent[2];
+            if(distance + radius < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    uint32_t cullAABBs(
+        const Frustum& frustum, Span<const Bounds::AABB> aabbs, uint32_t indexOffset, uint32_t* visible)
+    {
+        uint32_t visibleCount = 0;
+        size_t i = 0;
+
+#if defined(CULLING_SSE2)
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        // clears the sign bit
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        for(; i + 4 <= aabbs.size(); i += 4)
+        {
+            const Bounds::AABB* box = &aabbs[i];
+            // one box per lane
+            __m128 center[3];
+            __m128 extent[3];
+            __m128 outside = zero;
+            for(int c = 0; c < 3; c++)
+            {
+                const __m128 min = _mm_setr_ps(box[0].min[c], box[1].min[c], box[2].min[c], box[3].min[c]);
+                const __m128 max = _mm_setr_ps(box[0].max[c], box[1].max[c], box[2].max[c], box[3].max[c]);
+                center[c] = _mm_mul_ps(_mm_add_ps(min, max), half);
+                extent[c] = _mm_mul_ps(_mm_sub_ps(max, min), half);
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(extent[c], zero));
+            }
+            for(const float* plane : frustum.planes)
+            {
+                __m128 distance = _mm_set1_ps(plane[3]);
+                __m128 radius = zero;
+                for(int c = 0; c < 3; c++)
+                {
+                    distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane[c]), center[c]));
+                    radius = _mm_add_ps(radius, _mm_mul_ps(_mm_and_ps(_mm_set1_ps(plane[c]), absMask), extent[c]));
+                }
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+            }
+            const int visibleMask = ~_mm_movemask_ps(outside) & 0xF;
+            for(uint32_t lane = 0; lane < 4; lane++)
+            {
+                // branchless, the index gets overwritten by the next one if this box isnt visible
+                visible[visibleCount] = indexOffset + uint32_t(i) + lane;
+                visibleCount += (visibleMask >> lane) & 1;
+            }
+        }
+#elif defined(CULLING_NEON)
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        for(; i + 4 <= aabbs.size(); i += 4)
+        {
+            const Bounds::AABB* box = &aabbs[i];
+            float32x4_t center[3];
+            float32x4_t extent[3];
+            uint32x4_t outside = vdupq_n_u32(0);
+            for(int c = 0; c < 3; c++)
+            {
+                const float minValues[4] = {box[0].min[c], box[1].min[c], box[2].min[c], box[3].min[c]};
+                const float maxValues[4] = {box[0].max[c], box[1].max[c], box[2].max[c], box[3].max[c]};
+                const float32x4_t min = vld1q_f32(minValues);
+                const float32x4_t max = vld1q_f32(maxValues);
+                center[c] = vmulq_f32(vaddq_f32(min, max), half);
+                extent[c] = vmulq_f32(vsubq_f32(max, min), half);
+                outside = vorrq_u32(outside, vcltq_f32(extent[c], zero));
+            }
+            for(const float* plane : frustum.planes)
+            {
+                float32x4_t distance = vdupq_n_f32(plane[3]);
+                float32x4_t radius = zero;
+                for(int c = 0; c < 3; c++)
+                {
+                    distance = vmlaq_n_f32(distance, center[c], plane[c]);
+                    radius = vmlaq_n_f32(radius, extent[c], std::abs(plane[c]));
+                }
+                outside = vorrq_u32(outside, vcltq_f32(vaddq_f32(distance, radius), zero));
+            }
+            uint32_t outsideLanes[4];
+            vst1q_u32(outsideLanes, outside);
+            for(uint32_t lane = 0; lane < 4; lane++)
+            {
+                visible[visibleCount] = indexOffset + uint32_t(i) + lane;
+                visibleCount += outsideLanes[lane] == 0 ? 1 : 0;
+            }
+        }
+#endif
+
+        for(; i < aabbs.size(); i++)
+        {
+            if(isVisible(frustum, aabbs[i]))
+                visible[visibleCount++] = indexOffset + uint32_t(i);
+        }
+        return visibleCount;
+    }
+} // namespace Culling
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Datastructures/Span.hpp>
+#include <Engine/Graphics/Mesh/Bounds.hpp>
+#include <cstdint>
+
+/*
+    View frustum culling of world space bounds on the CPU
+    The planes get extracted from the combined projection * view matrix (Gribb & Hartmann), the boxes are
+    tested 4 at a time with SSE2/NEON where available
+    Conservative: boxes that intersect the frustum are never culled, but boxes near its corners can be kept
+    even though they are outside
+*/
+namespace Culling
+{
+    struct Frustum
+    {
+        // left, right, bottom, top, near, far
+        // normalized, a point p is on the inner side if dot(plane.xyz, p) + plane.w >= 0
+        float planes[6][4];
+    };
+
+    // projView: column major (glm::mat4 layout), clip space depth in [0, 1] like Vulkan
+    Frustum extractFrustum(const float* projView);
+
+    // scalar version of cullAABBs
+    bool isVisible(const Frustum& frustum, const Bounds::AABB& aabb);
+
+    /*
+        Writes the indices of all visible aabbs into visible (which needs room for aabbs.size() indices), with
+        indexOffset added to each one. Returns the amount written, the order is kept
+        Empty aabbs are never visible
+    */
+    uint32_t cullAABBs(
+        const Frustum& frustum, Span<const Bounds::AABB> aabbs, uint32_t indexOffset, uint32_t* visible);
+} // namespace Culling
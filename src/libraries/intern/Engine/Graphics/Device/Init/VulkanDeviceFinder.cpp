@@ -74,21 +74,26 @@ VkDevice VulkanDeviceFinder::createLogicalDevice()
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures{};
-
-    // TODO: if the amount of requested core features grows, switch to
-    //   https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPhysicalDeviceVulkan13Features.html
-    //   and similar Vulkan11-/Vulkan12Features instead of using all these individual structs
+    VkPhysicalDeviceFeatures deviceFeatures{
+        // GPU driven rendering, culled draws are written by a compute shader and reference their instances
+        // through firstInstance
+        .multiDrawIndirect = VK_TRUE,
+        .drawIndirectFirstInstance = VK_TRUE,
+    };
 
-    VkPhysicalDeviceScalarBlockLayoutFeatures scalarBlockLayoutFeatures{
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES,
+    // The individual feature structs of all these got promoted to the core ones, so they cant be mixed
+    VkPhysicalDeviceVulkan13Features vulkan13Features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
         .pNext = nullptr,
-        .scalarBlockLayout = VK_TRUE,
+        .synchronization2 = VK_TRUE,
+        .dynamicRendering = VK_TRUE,
+        .maintenance4 = VK_TRUE,
     };
 
-    VkPhysicalDeviceDescriptorIndexingFeatures descIndexingFeatures = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
-        .pNext = &scalarBlockLayoutFeatures,
+    VkPhysicalDeviceVulkan12Features vulkan12Features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = &vulkan13Features,
+        .drawIndirectCount = VK_TRUE,
         .shaderInputAttachmentArrayDynamicIndexing = VK_FALSE,
         .shaderUniformTexelBufferArrayDynamicIndexing = VK_TRUE,
         .shaderStorageTexelBufferArrayDynamicIndexing = VK_TRUE,
@@ -109,35 +114,18 @@ VkDevice VulkanDeviceFinder::createLogicalDevice()
         .descriptorBindingPartiallyBound = VK_TRUE,
         .descriptorBindingVariableDescriptorCount = VK_TRUE,
         .runtimeDescriptorArray = VK_TRUE,
+        .scalarBlockLayout = VK_TRUE,
     };
 
-    VkPhysicalDeviceSynchronization2Features synch2Features = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES,
-        .pNext = &descIndexingFeatures,
-        .synchronization2 = VK_TRUE,
-    };
-
-    VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES,
-        .pNext = &synch2Features,
-        .dynamicRendering = VK_TRUE,
-    };
-
-    VkPhysicalDeviceShaderDrawParametersFeatures shaderDrawParamFeatures = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DRAW_PARAMETER_FEATURES,
-        .pNext = &dynamicRenderingFeatures,
+    VkPhysicalDeviceVulkan11Features vulkan11Features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
+        .pNext = &vulkan12Features,
         .shaderDrawParameters = VK_TRUE,
     };
 
-    VkPhysicalDeviceMaintenance4Features maint4Features = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_4_FEATURES,
-        .pNext = &shaderDrawParamFeatures,
-        .maintenance4 = VK_TRUE,
-    };
-
     VkDeviceCreateInfo createInfo{
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-        .pNext = &maint4Features,
+        .pNext = &vulkan11Features,
     };
     createInfo.queueCreateInfoCount = (uint32_t)queueCreateInfos.size();
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -176,57 +164,54 @@ bool VulkanDeviceFinder::isDeviceSuitable(VkPhysicalDevice device)
 
     bool featuresSupported = true;
     {
-        VkPhysicalDeviceScalarBlockLayoutFeatures scalarBlockLayoutFeatures{
-            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES,
+        VkPhysicalDeviceVulkan13Features vulkan13Features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
             .pNext = nullptr,
         };
-        VkPhysicalDeviceDescriptorIndexingFeatures descIndexingFeatures = {
-            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
-            .pNext = &scalarBlockLayoutFeatures,
-        };
-        VkPhysicalDeviceSynchronization2Features synch2Features = {
-            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES,
-            .pNext = &descIndexingFeatures,
-        };
-        VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures = {
-            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES,
-            .pNext = &synch2Features,
+        VkPhysicalDeviceVulkan12Features vulkan12Features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            .pNext = &vulkan13Features,
         };
-        VkPhysicalDeviceShaderDrawParametersFeatures shaderDrawParamFeatures = {
-            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_DRAW_PARAMETER_FEATURES,
-            .pNext = &dynamicRenderingFeatures,
+        VkPhysicalDeviceVulkan11Features vulkan11Features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
+            .pNext = &vulkan12Features,
         };
         //--
         VkPhysicalDeviceFeatures2 deviceFeatures{
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
-            .pNext = &shaderDrawParamFeatures,
+            .pNext = &vulkan11Features,
         };
         vkGetPhysicalDeviceFeatures2(device, &deviceFeatures);
-        featuresSupported &= scalarBlockLayoutFeatures.scalarBlockLayout;
-
-        featuresSupported &= descIndexingFeatures.shaderUniformTexelBufferArrayDynamicIndexing;
-        featuresSupported &= descIndexingFeatures.shaderStorageTexelBufferArrayDynamicIndexing;
-        featuresSupported &= descIndexingFeatures.shaderUniformBufferArrayNonUniformIndexing;
-        featuresSupported &= descIndexingFeatures.shaderSampledImageArrayNonUniformIndexing;
-        featuresSupported &= descIndexingFeatures.shaderStorageBufferArrayNonUniformIndexing;
-        featuresSupported &= descIndexingFeatures.shaderStorageImageArrayNonUniformIndexing;
-        featuresSupported &= descIndexingFeatures.shaderUniformTexelBufferArrayNonUniformIndexing;
-        featuresSupported &= descIndexingFeatures.shaderStorageTexelBufferArrayNonUniformIndexing;
-        featuresSupported &= descIndexingFeatures.descriptorBindingUniformBufferUpdateAfterBind;
-        featuresSupported &= descIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind;
-        featuresSupported &= descIndexingFeatures.descriptorBindingStorageImageUpdateAfterBind;
-        featuresSupported &= descIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind;
-        featuresSupported &= descIndexingFeatures.descriptorBindingUniformTexelBufferUpdateAfterBind;
-        featuresSupported &= descIndexingFeatures.descriptorBindingStorageTexelBufferUpdateAfterBind;
-        featuresSupported &= descIndexingFeatures.descriptorBindingUpdateUnusedWhilePending;
-        featuresSupported &= descIndexingFeatures.descriptorBindingPartiallyBound;
-        featuresSupported &= descIndexingFeatures.descriptorBindingVariableDescriptorCount;
-        featuresSupported &= descIndexingFeatures.runtimeDescriptorArray;
-
-        featuresSupported &= synch2Features.synchronization2;
-
-        featuresSupported &= dynamicRenderingFeatures.dynamicRendering;
-        featuresSupported &= shaderDrawParamFeatures.shaderDrawParameters;
+        featuresSupported &= deviceFeatures.features.multiDrawIndirect;
+        featuresSupported &= deviceFeatures.features.drawIndirectFirstInstance;
+
+        featuresSupported &= vulkan11Features.shaderDrawParameters;
+
+        featuresSupported &= vulkan12Features.drawIndirectCount;
+        featuresSupported &= vulkan12Features.scalarBlockLayout;
+
+        featuresSupported &= vulkan12Features.shaderUniformTexelBufferArrayDynamicIndexing;
+        featuresSupported &= vulkan12Features.shaderStorageTexelBufferArrayDynamicIndexing;
+        featuresSupported &= vulkan12Features.shaderUniformBufferArrayNonUniformIndexing;
+        featuresSupported &= vulkan12Features.shaderSampledImageArrayNonUniformIndexing;
+        featuresSupported &= vulkan12Features.shaderStorageBufferArrayNonUniformIndexing;
+        featuresSupported &= vulkan12Features.shaderStorageImageArrayNonUniformIndexing;
+        featuresSupported &= vulkan12Features.shaderUniformTexelBufferArrayNonUniformIndexing;
+        featuresSupported &= vulkan12Features.shaderStorageTexelBufferArrayNonUniformIndexing;
+        featuresSupported &= vulkan12Features.descriptorBindingUniformBufferUpdateAfterBind;
+        featuresSupported &= vulkan12Features.descriptorBindingSampledImageUpdateAfterBind;
+        featuresSupported &= vulkan12Features.descriptorBindingStorageImageUpdateAfterBind;
+        featuresSupported &= vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind;
+        featuresSupported &= vulkan12Features.descriptorBindingUniformTexelBufferUpdateAfterBind;
+        featuresSupported &= vulkan12Features.descriptorBindingStorageTexelBufferUpdateAfterBind;
+        featuresSupported &= vulkan12Features.descriptorBindingUpdateUnusedWhilePending;
+        featuresSupported &= vulkan12Features.descriptorBindingPartiallyBound;
+        featuresSupported &= vulkan12Features.descriptorBindingVariableDescriptorCount;
+        featuresSupported &= vulkan12Features.runtimeDescriptorArray;
+
+        featuresSupported &= vulkan13Features.synchronization2;
+        featuresSupported &= vulkan13Features.dynamicRendering;
+        featuresSupported &= vulkan13Features.maintenance4;
     }
 
     bool extensionsSupported = checkDeviceExtensionSupport(device);
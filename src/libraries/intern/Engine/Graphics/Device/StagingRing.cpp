@@ -0,0 +1,42 @@
+#include "StagingRing.hpp"
+
+#include <bit>
+#include <cassert>
+
+void StagingRing::init(size_t newCapacity)
+{
+    assert(newCapacity > 0 && newCapacity % maxAlignment == 0);
+    capacity = newCapacity;
+    head = 0;
+    tail = 0;
+}
+
+size_t StagingRing::allocate(size_t size, size_t alignment)
+{
+    assert(std::has_single_bit(alignment) && alignment <= maxAlignment);
+    assert(capacity > 0 && "not initialized");
+    if(size > capacity)
+        return NoSpace;
+
+    uint64_t current = head.load(std::memory_order_relaxed);
+    while(true)
+    {
+        uint64_t start = (current + alignment - 1) & ~uint64_t(alignment - 1);
+        // skip to the start of the buffer, the capacity is a multiple of the alignment so it stays aligned
+        if(start % capacity + size > capacity)
+            start = (current + capacity - 1) / capacity * capacity;
+        const uint64_t end = start + size;
+        // the tail only grows, so an outdated value is just more conservative
+        if(end - tail.load(std::memory_order_acquire) > capacity)
+            return NoSpace;
+        if(head.compare_exchange_weak(current, end, std::memory_order_relaxed))
+            return size_t(start % capacity);
+    }
+}
+
+void StagingRing::release(uint64_t position)
+{
+    assert(position >= tail.load(std::memory_order_relaxed));
+    assert(position <= head.load(std::memory_order_relaxed));
+    tail.store(position, std::memory_order_release);
+}
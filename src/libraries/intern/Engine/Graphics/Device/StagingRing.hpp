@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Sub-allocates a persistent staging buffer as a ring that is shared by all frames in flight
+    Positions only ever grow, the offset into the buffer is position % capacity. Allocations never wrap around the
+    end of the buffer, the rest of it gets skipped instead
+    allocate() is lock-free and can be called from any thread. The owner remembers getHead() when submitting a
+    frame and calls release() with it once the frames fence got signaled
+*/
+class StagingRing
+{
+  public:
+    static constexpr size_t NoSpace = ~size_t(0);
+    // the capacity has to be a multiple of this
+    static constexpr size_t maxAlignment = 256;
+
+    void init(size_t capacity);
+    inline size_t getCapacity() const { return capacity; }
+
+    /*
+        Returns the offset into the buffer, or NoSpace if the request is larger than the ring or the GPU is still
+        using too much of it
+        alignment has to be a power of 2, at most maxAlignment
+    */
+    size_t allocate(size_t size, size_t alignment);
+
+    // everything allocated so far lies before this position
+    inline uint64_t getHead() const { return head.load(std::memory_order_relaxed); }
+    // Frees everything before position, positions have to increase from call to call. Not thread safe
+    void release(uint64_t position);
+    // includes the parts skipped at the end of the buffer
+    inline size_t getUsedSize() const
+    {
+        return size_t(head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed));
+    }
+
+  private:
+    size_t capacity = 0;
+    std::atomic<uint64_t> head = 0;
+    std::atomic<uint64_t> tail = 0;
+};
@@ -8,6 +8,8 @@
 #include "VulkanDebug.hpp"
 
 #include <Datastructures/ArrayHelpers.hpp>
+#include <Datastructures/InlineVector.hpp>
+#include <Datastructures/ThreadPool.hpp>
 
 #include <GLFW/glfw3.h>
 #include <ImGui/imgui.h>
@@ -23,7 +25,7 @@
 PFN_vkCmdBeginDebugUtilsLabelEXT pfnCmdBeginDebugUtilsLabelEXT;
 PFN_vkCmdEndDebugUtilsLabelEXT pfnCmdEndDebugUtilsLabelEXT;
 
-void VulkanDevice::init(GLFWwindow* window)
+void VulkanDevice::init(GLFWwindow* window, const Config& config)
 {
     INIT_STATIC_GETTER();
     mainWindow = window;
@@ -40,7 +42,7 @@ void VulkanDevice::init(GLFWwindow* window)
     initSwapchain();
     initCommands();
     initSyncStructures();
-    initAllocators();
+    initAllocators(config);
 
     // TODO: where to put this?
     initBindless();
@@ -210,19 +212,19 @@ void VulkanDevice::initCommands()
         .queueFamilyIndex = graphicsAndComputeQueueFamily,
     };
 
-    uint32_t threadCount = std::thread::hardware_concurrency();
-    assert(threadCount > 0);
+    // same count the Editor starts its ThreadPool with, so every pool thread index has a command pool
+    const uint32_t threadCount = ThreadPool::hardwareThreadCount();
     for(int i = 0; i < FRAMES_IN_FLIGHT; i++)
     {
         PerFrameData& frameData = perFrameData[i];
         frameData.commandPools.resize(threadCount);
-        frameData.usedCommandBuffersPerPool.resize(threadCount);
         for(int t = 0; t < threadCount; t++)
         {
             assertVkResult(
-                vkCreateCommandPool(device, &commandPoolCrInfo, nullptr, &perFrameData[i].commandPools[t]));
+                vkCreateCommandPool(device, &commandPoolCrInfo, nullptr, &perFrameData[i].commandPools[t].pool));
 
-            deleteQueue.pushBack([=, pool = perFrameData[i].commandPools[t]]()
+            // destroying the pool frees its command buffers as well
+            deleteQueue.pushBack([=, pool = perFrameData[i].commandPools[t].pool]()
                                  { vkDestroyCommandPool(device, pool, nullptr); });
 
             // Per frame upload stuff
@@ -320,24 +322,20 @@ void VulkanDevice::initSyncStructures()
     deleteQueue.pushBack([=]() { vkDestroyFence(device, uploadContext.uploadFence, nullptr); });
 }
 
-#define MB(x) ((size_t)(x) << 20)
-
-void VulkanDevice::initAllocators()
+void VulkanDevice::initAllocators(const Config& config)
 {
-    for(int i = 0; i < FRAMES_IN_FLIGHT; i++)
-    {
-        auto& frameData = perFrameData[i];
-        constexpr size_t stagingBufferSize = MB(50);
-        frameData.stagingAllocator.buffer = createBuffer(Buffer::CreateInfo{
-            .debugName = "StagingBuffer" + std::to_string(i),
-            .size = stagingBufferSize,
-            .memoryType = Buffer::MemoryType::CPU,
-            .allStates = ResourceState::TransferSrc,
-            .initialState = ResourceState::TransferSrc,
-        });
-        frameData.stagingAllocator.capacity = stagingBufferSize;
-        frameData.stagingAllocator.ptr = static_cast<uint8_t*>(*get<void*>(frameData.stagingAllocator.buffer));
-    }
+    // one ring for all frames in flight, each frame releases what it used once its fence got signaled
+    constexpr size_t alignment = StagingRing::maxAlignment;
+    const size_t stagingRingSize = (config.stagingRingSize + alignment - 1) / alignment * alignment;
+    stagingBuffer = createBuffer(Buffer::CreateInfo{
+        .debugName = "StagingRing",
+        .size = stagingRingSize,
+        .memoryType = Buffer::MemoryType::CPU,
+        .allStates = ResourceState::TransferSrc,
+        .initialState = ResourceState::TransferSrc,
+    });
+    stagingBufferPtr = static_cast<uint8_t*>(*get<void*>(stagingBuffer));
+    stagingRing.init(stagingRingSize);
 }
 
 void VulkanDevice::initBindless()
@@ -521,7 +519,8 @@ Buffer::Handle VulkanDevice::createBuffer(Buffer::CreateInfo&& createInfo)
         VkBufferCopy copy{
             .srcOffset = stagingAlloc.offset,
             .dstOffset = 0,
-            .size = createInfo.size,
+            // only the initial data is in the staging allocation, not the whole size of the buffer
+            .size = createInfo.initialData.size(),
         };
         vkCmdCopyBuffer(
             getCurrentFrameData().uploadCommandBuffer, *get<VkBuffer>(stagingAlloc.buffer), vkBuffer, 1, &copy);
@@ -1148,7 +1147,7 @@ VkPipeline VulkanDevice::createGraphicsPipeline(const PipelineCreateInfo& create
         .pDynamicStates = &dynamicStates[0],
     };
 
-    std::vector<VkFormat> colorFormats{createInfo.colorFormats.size()};
+    InlineVector<VkFormat, 8> colorFormats{static_cast<uint32_t>(createInfo.colorFormats.size())};
     for(int i = 0; i < colorFormats.size(); i++)
     {
         colorFormats[i] = toVkFormat(createInfo.colorFormats[i]);
@@ -1256,10 +1255,40 @@ void VulkanDevice::destroy(VkPipeline pipeline)
     }
 }
 
-GPUAllocation VulkanDevice::allocateStagingData(size_t size)
+GPUAllocation VulkanDevice::allocateStagingData(size_t size, size_t alignment)
 {
-    auto& currentFrameData = getCurrentFrameData();
-    return currentFrameData.stagingAllocator.allocate(size);
+    // Large requests would block most of the ring until the GPU is done with them, so they get their own buffer
+    // right away, just like everything that doesnt fit anymore
+    const size_t offset =
+        size <= stagingRing.getCapacity() / 4 ? stagingRing.allocate(size, alignment) : StagingRing::NoSpace;
+    if(offset != StagingRing::NoSpace)
+    {
+        return GPUAllocation{
+            .buffer = stagingBuffer, .offset = offset, .size = size, .ptr = stagingBufferPtr + offset};
+    }
+
+    // starts at offset 0, VMA aligns buffer allocations enough for any copy
+    Buffer::Handle buffer = createBuffer(Buffer::CreateInfo{
+        .debugName = "DedicatedStagingBuffer",
+        .size = size,
+        .memoryType = Buffer::MemoryType::CPU,
+        .allStates = ResourceState::TransferSrc,
+        .initialState = ResourceState::TransferSrc,
+    });
+    getCurrentFrameData().dedicatedStagingBuffers.push_back(buffer);
+    return GPUAllocation{.buffer = buffer, .offset = 0, .size = size, .ptr = *get<void*>(buffer)};
+}
+
+void VulkanDevice::releaseStagingData(PerFrameData& frameData)
+{
+    stagingRing.release(frameData.stagingRingEnd);
+    // the GPU is done with them, so they dont have to go through the delete queue
+    for(Buffer::Handle buffer : frameData.dedicatedStagingBuffers)
+    {
+        vmaDestroyBuffer(allocator, *get<VkBuffer>(buffer), get<Buffer::Allocation>(buffer)->allocation);
+        bufferPool.remove(buffer);
+    }
+    frameData.dedicatedStagingBuffers.clear();
 }
 
 void VulkanDevice::startInitializationWork()
@@ -1268,7 +1297,7 @@ void VulkanDevice::startInitializationWork()
 
     assertVkResult(vkWaitForFences(device, 1, &curFrameData.commandsDone, true, UINT64_MAX));
     assertVkResult(vkResetFences(device, 1, &curFrameData.commandsDone));
-    curFrameData.stagingAllocator.reset();
+    releaseStagingData(curFrameData);
 
     // no commmand buffers / pools to clear / reset yet
 
@@ -1293,9 +1322,12 @@ void VulkanDevice::submitInitializationWork(Span<const VkCommandBuffer> cmdBuffe
     auto& curFrameData = getCurrentFrameData();
 
     vkEndCommandBuffer(curFrameData.uploadCommandBuffer);
-    std::vector<VkCommandBuffer> buffers{cmdBuffersToSubmit.size() + 1};
-    std::copy(cmdBuffersToSubmit.begin(), cmdBuffersToSubmit.end(), ++buffers.begin());
-    buffers[0] = curFrameData.uploadCommandBuffer;
+    curFrameData.stagingRingEnd = stagingRing.getHead();
+    InlineVector<VkCommandBuffer, 16> buffers;
+    buffers.reserve(static_cast<uint32_t>(cmdBuffersToSubmit.size()) + 1);
+    buffers.push_back(curFrameData.uploadCommandBuffer);
+    for(VkCommandBuffer cmd : cmdBuffersToSubmit)
+        buffers.push_back(cmd);
 
     VkSubmitInfo submitInfo{
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
@@ -1322,7 +1354,7 @@ void VulkanDevice::startNextFrame()
 
     assertVkResult(vkWaitForFences(device, 1, &curFrameData.commandsDone, true, UINT64_MAX));
     assertVkResult(vkResetFences(device, 1, &curFrameData.commandsDone));
-    curFrameData.stagingAllocator.reset();
+    releaseStagingData(curFrameData);
 
     assertVkResult(vkAcquireNextImageKHR(
         device,
@@ -1332,24 +1364,14 @@ void VulkanDevice::startNextFrame()
         nullptr,
         &currentSwapchainImageIndex));
 
-    // TODO: not sure if I really want to free them all, could keep them around
-    //       would then also not have to allocate new ones every frame!
-    for(int i = 0; i < curFrameData.usedCommandBuffersPerPool.size(); i++)
+    // Resetting the pool puts all of its command buffers back into the initial state, so they can be handed out
+    // again instead of being freed and allocated every frame
+    for(PerFrameData::CommandPool& cmdPool : curFrameData.commandPools)
     {
-        if(!curFrameData.usedCommandBuffersPerPool[i].empty())
-        {
-            // Free command buffers that were used
-            vkFreeCommandBuffers(
-                device,
-                curFrameData.commandPools[i],
-                curFrameData.usedCommandBuffersPerPool[i].size(),
-                curFrameData.usedCommandBuffersPerPool[i].data());
-            curFrameData.usedCommandBuffersPerPool[i].clear();
-        }
-    }
-    for(VkCommandPool cmdPool : curFrameData.commandPools)
-    {
-        assertVkResult(vkResetCommandPool(device, cmdPool, 0));
+        if(cmdPool.usedCount == 0)
+            continue;
+        assertVkResult(vkResetCommandPool(device, cmdPool.pool, 0));
+        cmdPool.usedCount = 0;
     }
     assertVkResult(vkResetCommandPool(device, curFrameData.uploadCommandPool, 0));
 
@@ -1367,20 +1389,26 @@ void VulkanDevice::startNextFrame()
     }
 }
 
-VkCommandBuffer VulkanDevice::beginCommandBuffer(uint32_t threadIndex)
+VkCommandBuffer VulkanDevice::beginCommandBuffer(uint32_t threadIndex, BindPoints bindPoints)
 {
     auto& curFrameData = getCurrentFrameData();
+    assert(threadIndex < curFrameData.commandPools.size());
+    PerFrameData::CommandPool& cmdPool = curFrameData.commandPools[threadIndex];
 
-    VkCommandBuffer cmdBuffer;
-    VkCommandBufferAllocateInfo cmdBuffAllocInfo{
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .pNext = nullptr,
-        .commandPool = curFrameData.commandPools[threadIndex],
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = 1,
-    };
-    vkAllocateCommandBuffers(device, &cmdBuffAllocInfo, &cmdBuffer);
-    curFrameData.usedCommandBuffersPerPool[threadIndex].push_back(cmdBuffer);
+    if(cmdPool.usedCount == cmdPool.commandBuffers.size())
+    {
+        VkCommandBuffer newCmdBuffer;
+        VkCommandBufferAllocateInfo cmdBuffAllocInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .commandPool = cmdPool.pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        assertVkResult(vkAllocateCommandBuffers(device, &cmdBuffAllocInfo, &newCmdBuffer));
+        cmdPool.commandBuffers.push_back(newCmdBuffer);
+    }
+    VkCommandBuffer cmdBuffer = cmdPool.commandBuffers[cmdPool.usedCount++];
 
     VkCommandBufferBeginInfo cmdBeginInfo{
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
@@ -1393,25 +1421,22 @@ VkCommandBuffer VulkanDevice::beginCommandBuffer(uint32_t threadIndex)
     assertVkResult(vkBeginCommandBuffer(cmdBuffer, &cmdBeginInfo));
 
     // Bind the bindless descriptor sets once per cmdbuffer
-    // TODO: overkill always binding both, parameterize
-    vkCmdBindDescriptorSets(
-        cmdBuffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        bindlessPipelineLayout,
-        0,
-        bindlessManager.getDescriptorSetsCount(),
-        bindlessManager.getDescriptorSets(),
-        0,
-        nullptr);
-    vkCmdBindDescriptorSets(
-        cmdBuffer,
-        VK_PIPELINE_BIND_POINT_COMPUTE,
-        bindlessPipelineLayout,
-        0,
-        bindlessManager.getDescriptorSetsCount(),
-        bindlessManager.getDescriptorSets(),
-        0,
-        nullptr);
+    const auto bindDescriptorSets = [&](VkPipelineBindPoint bindPoint)
+    {
+        vkCmdBindDescriptorSets(
+            cmdBuffer,
+            bindPoint,
+            bindlessPipelineLayout,
+            0,
+            bindlessManager.getDescriptorSetsCount(),
+            bindlessManager.getDescriptorSets(),
+            0,
+            nullptr);
+    };
+    if(bindPoints != BindPoints::Compute)
+        bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS);
+    if(bindPoints != BindPoints::Graphics)
+        bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE);
 
     return cmdBuffer;
 }
@@ -1443,9 +1468,12 @@ void VulkanDevice::submitCommandBuffers(Span<const VkCommandBuffer> cmdBuffers)
     auto& curFrameData = getCurrentFrameData();
 
     vkEndCommandBuffer(curFrameData.uploadCommandBuffer);
-    std::vector<VkCommandBuffer> buffers{cmdBuffers.size() + 1};
-    std::copy(cmdBuffers.begin(), cmdBuffers.end(), ++buffers.begin());
-    buffers[0] = curFrameData.uploadCommandBuffer;
+    curFrameData.stagingRingEnd = stagingRing.getHead();
+    InlineVector<VkCommandBuffer, 16> buffers;
+    buffers.reserve(static_cast<uint32_t>(cmdBuffers.size()) + 1);
+    buffers.push_back(curFrameData.uploadCommandBuffer);
+    for(VkCommandBuffer cmd : cmdBuffers)
+        buffers.push_back(cmd);
 
     VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     VkSubmitInfo submitInfo{
@@ -1506,6 +1534,13 @@ void VulkanDevice::copyBuffer(
     };
     vkCmdCopyBuffer(cmd, *get<VkBuffer>(src), *get<VkBuffer>(dest), 1, &copyRegion);
 }
+void VulkanDevice::copyBuffer(
+    VkCommandBuffer cmd, Buffer::Handle src, Buffer::Handle dest, Span<const VkBufferCopy> regions)
+{
+    assert(regions.size() > 0);
+    vkCmdCopyBuffer(
+        cmd, *get<VkBuffer>(src), *get<VkBuffer>(dest), static_cast<uint32_t>(regions.size()), regions.data());
+}
 
 void VulkanDevice::dispatchCompute(VkCommandBuffer cmd, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
 {
@@ -1553,13 +1588,16 @@ void VulkanDevice::insertSwapchainImageBarrier(
 
 // TODO: overload to just not take a depth target, instead of having to pass null inside render target?
 void VulkanDevice::beginRendering(
-    VkCommandBuffer cmd, Span<const ColorTarget>&& colorTargets, const DepthTarget&& depthTarget)
+    VkCommandBuffer cmd,
+    Span<const ColorTarget>&& colorTargets,
+    const DepthTarget&& depthTarget,
+    RenderingSplit split)
 {
     VkClearValue clearValue{.color = {1.0f, 1.0f, 1.0f, 1.0f}};
     VkClearValue depthStencilClear{.depthStencil = {.depth = 1.0f, .stencil = 0u}};
 
-    std::vector<VkRenderingAttachmentInfo> colorAttachmentInfos;
-    colorAttachmentInfos.reserve(colorTargets.size());
+    InlineVector<VkRenderingAttachmentInfo, 8> colorAttachmentInfos;
+    colorAttachmentInfos.reserve(static_cast<uint32_t>(colorTargets.size()));
     for(const auto& target : colorTargets)
     {
         const VkImageView view = std::holds_alternative<Texture::Handle>(target.texture)
@@ -1589,9 +1627,16 @@ void VulkanDevice::beginRendering(
             .clearValue = depthStencilClear,
         };
 
+    VkRenderingFlags flags = 0;
+    if(split == RenderingSplit::Suspend || split == RenderingSplit::ResumeAndSuspend)
+        flags |= VK_RENDERING_SUSPENDING_BIT;
+    if(split == RenderingSplit::Resume || split == RenderingSplit::ResumeAndSuspend)
+        flags |= VK_RENDERING_RESUMING_BIT;
+
     VkRenderingInfo renderingInfo{
         .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
         .pNext = nullptr,
+        .flags = flags,
         .renderArea =
             {
                 .offset = {.x = 0, .y = 0},
@@ -1623,8 +1668,8 @@ void VulkanDevice::endRendering(VkCommandBuffer cmd) { vkCmdEndRendering(cmd); }
 
 void VulkanDevice::insertBarriers(VkCommandBuffer cmd, Span<const Barrier> barriers)
 {
-    std::vector<VkImageMemoryBarrier2> imageBarriers;
-    std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+    InlineVector<VkImageMemoryBarrier2, 16> imageBarriers;
+    InlineVector<VkBufferMemoryBarrier2, 16> bufferBarriers;
 
     for(const auto& barrier : barriers)
     {
@@ -1722,9 +1767,6 @@ void VulkanDevice::insertBarriers(VkCommandBuffer cmd, Span<const Barrier> barri
     };
 
     vkCmdPipelineBarrier2(cmd, &dependencyInfo);
-
-    bufferBarriers.clear();
-    imageBarriers.clear();
 }
 
 void VulkanDevice::setGraphicsPipelineState(VkCommandBuffer cmd, VkPipeline pipe)
@@ -1786,6 +1828,31 @@ void VulkanDevice::drawIndexed(
     vkCmdDrawIndexed(cmd, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
 
+void VulkanDevice::drawIndirect(
+    VkCommandBuffer cmd, Buffer::Handle argumentBuffer, size_t offset, uint32_t drawCount, uint32_t stride)
+{
+    vkCmdDrawIndirect(cmd, *get<VkBuffer>(argumentBuffer), offset, drawCount, stride);
+}
+
+void VulkanDevice::drawIndirectCount(
+    VkCommandBuffer cmd,
+    Buffer::Handle argumentBuffer,
+    size_t offset,
+    Buffer::Handle countBuffer,
+    size_t countOffset,
+    uint32_t maxDrawCount,
+    uint32_t stride)
+{
+    vkCmdDrawIndirectCount(
+        cmd,
+        *get<VkBuffer>(argumentBuffer),
+        offset,
+        *get<VkBuffer>(countBuffer),
+        countOffset,
+        maxDrawCount,
+        stride);
+}
+
 void VulkanDevice::drawImGui(VkCommandBuffer cmd) { ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd); }
 
 void VulkanDevice::disableValidationErrorBreakpoint() { breakOnValidationError = false; }
@@ -2009,37 +2076,4 @@ void VulkanDevice::immediateSubmit(std::function<void(VkCommandBuffer cmd)>&& fu
     vkResetFences(device, 1, &uploadContext.uploadFence);
 
     vkResetCommandPool(device, uploadContext.commandPool, 0);
-}
-
-void VulkanDevice::LinearAllocator::reset() { offset = 0; }
-GPUAllocation VulkanDevice::LinearAllocator::allocate(size_t size)
-{
-    if(offset + size > capacity)
-    {
-        // TODO: could handle special cases where the requested size is like >=80% of the staging buffer capacity!
-        //       in that case, could just return a dedicated allocation for just that request instead of using the
-        //       normal allocation mechanism
-
-        // enqueue current buffer for deletion
-        VulkanDevice::impl()->destroy(this->buffer);
-
-        // create new buffer
-
-        // TODO: be smarter?
-        size_t newSize = std::max(this->capacity, size);
-
-        this->buffer = VulkanDevice::impl()->createBuffer(Buffer::CreateInfo{
-            .debugName = "StagingBufferReplacement",
-            .size = newSize,
-            .memoryType = Buffer::MemoryType::CPU,
-            .allStates = ResourceState::TransferSrc,
-            .initialState = ResourceState::TransferSrc,
-        });
-        this->capacity = newSize;
-        this->offset = 0;
-        this->ptr = static_cast<uint8_t*>(*VulkanDevice::impl()->get<void*>(this->buffer));
-    }
-    // TODO: alignment?
-    size_t oldOffset = offset.fetch_add(size);
-    return GPUAllocation{.buffer = buffer, .offset = oldOffset, .size = size, .ptr = &(ptr[oldOffset])};
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "../RenderTargets.hpp"
 #include "BindlessManager.hpp"
 #include "HelperTypes.hpp"
+#include "StagingRing.hpp"
 #include "VulkanConversions.hpp"
 #include <Engine/Graphics/Graphics.hpp>
 #include <Engine/Misc/Macros.hpp>
@@ -39,7 +40,12 @@ class VulkanDevice
     // ---------
 
   public:
-    void init(GLFWwindow* window);
+    struct Config
+    {
+        // persistent staging memory shared by all frames in flight, see allocateStagingData()
+        size_t stagingRingSize = size_t(128) << 20;
+    };
+    void init(GLFWwindow* window, const Config& config = {});
     void cleanup();
     void destroyResources();
 
@@ -90,10 +96,14 @@ class VulkanDevice
 
     /*
         Allocates CPU but GPU visible memory intended for subsequent copies on the GPU
-        Assume that this is only alive for the duration of the frame
-        ! NOT THREAD SAFE IF BUFFER RUNS OUT OF MEMORY !
+        Assume that this is only alive for the duration of the frame, it gets reused once the GPU is done with it
+        Comes out of the staging ring, requests that are too large for it (or dont fit anymore) get a dedicated
+        buffer that is destroyed after the frame instead
+        Only the ring part is lock-free, the fallback goes through createBuffer, so just like that this has to
+        be called from the thread that owns the device
+        alignment has to be a power of 2, at most StagingRing::maxAlignment
     */
-    GPUAllocation allocateStagingData(size_t size);
+    GPUAllocation allocateStagingData(size_t size, size_t alignment = 16);
 
     //-----------------------------------
 
@@ -105,7 +115,16 @@ class VulkanDevice
     // Dont really like these functions, but have to do for now until a framegraph is implemented
     void startNextFrame();
 
-    VkCommandBuffer beginCommandBuffer(uint32_t threadIndex = 0);
+    // Which bind points beginCommandBuffer binds the bindless descriptor sets to
+    enum struct BindPoints
+    {
+        Graphics,
+        Compute,
+        GraphicsAndCompute,
+    };
+    // Command buffers are only valid for the current frame, the ones of a thread get reused in later frames
+    VkCommandBuffer
+    beginCommandBuffer(uint32_t threadIndex = 0, BindPoints bindPoints = BindPoints::GraphicsAndCompute);
     void endCommandBuffer(VkCommandBuffer cmd);
 
     /*
@@ -131,11 +150,17 @@ class VulkanDevice
         Buffer::Handle dest,
         size_t destOffset,
         size_t size);
+    // all regions with a single vkCmdCopyBuffer
+    void copyBuffer(
+        VkCommandBuffer cmd, Buffer::Handle src, Buffer::Handle dest, Span<const VkBufferCopy> regions);
 
     void dispatchCompute(VkCommandBuffer cmd, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ);
 
-    void
-    beginRendering(VkCommandBuffer cmd, Span<const ColorTarget>&& colorTargets, const DepthTarget&& depthTarget);
+    void beginRendering(
+        VkCommandBuffer cmd,
+        Span<const ColorTarget>&& colorTargets,
+        const DepthTarget&& depthTarget,
+        RenderingSplit split = RenderingSplit::None);
     void endRendering(VkCommandBuffer cmd);
 
     void insertSwapchainImageBarrier(VkCommandBuffer cmd, ResourceState currentState, ResourceState targetState);
@@ -165,6 +190,22 @@ class VulkanDevice
         uint32_t firstIndex,
         uint32_t vertexOffset,
         uint32_t firstInstance);
+    // argumentBuffer holds VkDrawIndirectCommands and has to be in the IndirectArgument state
+    void drawIndirect(
+        VkCommandBuffer cmd,
+        Buffer::Handle argumentBuffer,
+        size_t offset,
+        uint32_t drawCount,
+        uint32_t stride = sizeof(VkDrawIndirectCommand));
+    // Like drawIndirect, but the draw count is read from countBuffer (uint32_t at countOffset), up to maxDrawCount
+    void drawIndirectCount(
+        VkCommandBuffer cmd,
+        Buffer::Handle argumentBuffer,
+        size_t offset,
+        Buffer::Handle countBuffer,
+        size_t countOffset,
+        uint32_t maxDrawCount,
+        uint32_t stride = sizeof(VkDrawIndirectCommand));
     void drawImGui(VkCommandBuffer cmd);
 
     void presentSwapchain();
@@ -189,26 +230,28 @@ class VulkanDevice
     static constexpr int FRAMES_IN_FLIGHT = 2;
 
   private:
-    struct LinearAllocator
-    {
-        Buffer::Handle buffer;
-        size_t capacity = 0;
-        std::atomic<size_t> offset = 0;
-        uint8_t* ptr = nullptr;
-
-        void reset();
-        GPUAllocation allocate(size_t size);
-    };
+    StagingRing stagingRing;
+    Buffer::Handle stagingBuffer;
+    uint8_t* stagingBufferPtr = nullptr;
 
     struct PerFrameData
     {
         VkSemaphore swapchainImageAvailable = VK_NULL_HANDLE;
         VkSemaphore swapchainImageRenderFinished = VK_NULL_HANDLE;
         VkFence commandsDone = VK_NULL_HANDLE;
-        std::vector<VkCommandPool> commandPools{};
-        std::vector<std::vector<VkCommandBuffer>> usedCommandBuffersPerPool{};
+        // one per thread
+        struct CommandPool
+        {
+            VkCommandPool pool = VK_NULL_HANDLE;
+            // allocated on demand and reset together with the pool, the first usedCount are in use this frame
+            std::vector<VkCommandBuffer> commandBuffers{};
+            uint32_t usedCount = 0;
+        };
+        std::vector<CommandPool> commandPools{};
 
-        LinearAllocator stagingAllocator;
+        // staging ring position at the submit, everything before it can be reused once commandsDone is signaled
+        uint64_t stagingRingEnd = 0;
+        std::vector<Buffer::Handle> dedicatedStagingBuffers;
         VkCommandPool uploadCommandPool;
         VkCommandBuffer uploadCommandBuffer;
     };
@@ -282,7 +325,9 @@ class VulkanDevice
     void initSwapchain();
     void initCommands();
     void initSyncStructures();
-    void initAllocators();
+    void initAllocators(const Config& config);
+    // after waiting on the frames fence
+    void releaseStagingData(PerFrameData& frameData);
     void initBindless();
     void initPipelineCache();
     void initImGui();
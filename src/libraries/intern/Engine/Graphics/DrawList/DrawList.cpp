@@ -0,0 +1,145 @@
+#include "DrawList.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <execution>
+#include <ranges>
+
+namespace
+{
+    constexpr uint32_t radixBits = 8;
+    constexpr uint32_t bucketCount = 1u << radixBits;
+    constexpr uint32_t digitCount = 64 / radixBits;
+    // Below this amount of packets per job the overhead of going wide is larger than the work itself
+    constexpr uint32_t packetsPerJob = 16384;
+
+    using Histogram = std::array<uint32_t, bucketCount>;
+
+    uint32_t digit(uint64_t key, uint32_t pass) { return uint32_t(key >> (pass * radixBits)) & (bucketCount - 1); }
+
+    template <typename Func>
+    void forEachJob(uint32_t jobCount, Func&& func)
+    {
+        if(jobCount < 2)
+        {
+            for(uint32_t job = 0; job < jobCount; job++)
+                func(job);
+            return;
+        }
+        std::ranges::iota_view jobs(0u, jobCount);
+        std::for_each(std::execution::par, jobs.begin(), jobs.end(), func);
+    }
+} // namespace
+
+namespace DrawList
+{
+    uint64_t makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth)
+    {
+        // positive floats sort like their bit patterns, the upper bits are sign (always 0), exponent and the
+        // start of the mantissa, so the precision is relative to the depth itself
+        const uint32_t depthKey = std::bit_cast<uint32_t>(std::max(depth, 0.0f)) >> (32 - depthBits);
+        const auto field = [](uint32_t value, uint32_t bits) { return uint64_t(value & ((1u << bits) - 1u)); };
+        return field(pass, passBits) << passShift | field(pipeline, pipelineBits) << pipelineShift |
+               field(material, materialBits) << materialShift | field(mesh, meshBits) << meshShift |
+               field(depthKey, depthBits) << depthShift;
+    }
+
+    void sort(std::vector<Packet>& packets, std::vector<Packet>& scratch)
+    {
+        const auto count = static_cast<uint32_t>(packets.size());
+        if(count < 2)
+            return;
+        scratch.resize(count);
+        const uint32_t jobCount = (count + packetsPerJob - 1) / packetsPerJob;
+        const auto jobRange = [count](uint32_t job)
+        { return std::pair{job * packetsPerJob, std::min((job + 1) * packetsPerJob, count)}; };
+
+        // Digits that are the same for every key dont change the order, usually the pass and the upper
+        // pipeline/material/mesh bits. One read for all of them, the position of a key doesnt matter here
+        struct JobBits
+        {
+            uint64_t firstKey;
+            // bits that differ from firstKey in any key of the job
+            uint64_t differing;
+        };
+        std::vector<JobBits> jobBits(jobCount);
+        forEachJob(
+            jobCount,
+            [&](uint32_t job)
+            {
+                const auto [begin, end] = jobRange(job);
+                uint64_t differing = 0;
+                for(uint32_t i = begin; i < end; i++)
+                    differing |= packets[i].key ^ packets[begin].key;
+                jobBits[job] = {.firstKey = packets[begin].key, .differing = differing};
+            });
+        uint64_t differingBits = 0;
+        for(const JobBits& bits : jobBits)
+            differingBits |= bits.differing | (bits.firstKey ^ jobBits[0].firstKey);
+
+        std::vector<Histogram> histograms(jobCount);
+        Packet* source = packets.data();
+        Packet* destination = scratch.data();
+        for(uint32_t pass = 0; pass < digitCount; pass++)
+        {
+            if(digit(differingBits, pass) == 0)
+                continue;
+
+            forEachJob(
+                jobCount,
+                [&](uint32_t job)
+                {
+                    const auto [begin, end] = jobRange(job);
+                    Histogram& histogram = histograms[job];
+                    histogram.fill(0);
+                    for(uint32_t i = begin; i < end; i++)
+                        histogram[digit(source[i].key, pass)]++;
+                });
+
+            // exclusive prefix sum, ordered by bucket first and job second so the sort stays stable
+            uint32_t offset = 0;
+            for(uint32_t bucket = 0; bucket < bucketCount; bucket++)
+            {
+                for(Histogram& histogram : histograms)
+                {
+                    const uint32_t bucketSize = histogram[bucket];
+                    histogram[bucket] = offset;
+                    offset += bucketSize;
+                }
+            }
+            assert(offset == count);
+
+            forEachJob(
+                jobCount,
+                [&](uint32_t job)
+                {
+                    const auto [begin, end] = jobRange(job);
+                    Histogram& offsets = histograms[job];
+                    for(uint32_t i = begin; i < end; i++)
+                        destination[offsets[digit(source[i].key, pass)]++] = source[i];
+                });
+            std::swap(source, destination);
+        }
+
+        if(source != packets.data())
+            packets.swap(scratch);
+    }
+
+    StateChanges countStateChanges(Span<const Packet> packets)
+    {
+        StateChanges changes;
+        for(size_t i = 0; i < packets.size(); i++)
+        {
+            const uint64_t key = packets[i].key;
+            // everything starts out unbound
+            const uint64_t changed = i == 0 ? ~0ull : key ^ packets[i - 1].key;
+            changes.passes += (changed >> passShift) != 0 ? 1 : 0;
+            changes.pipelines += (changed >> pipelineShift) != 0 ? 1 : 0;
+            changes.materials += (changed >> materialShift) != 0 ? 1 : 0;
+            changes.meshes += (changed >> meshShift) != 0 ? 1 : 0;
+        }
+        return changes;
+    }
+} // namespace DrawList
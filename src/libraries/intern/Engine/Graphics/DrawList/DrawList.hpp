@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Datastructures/Span.hpp>
+#include <cstdint>
+#include <vector>
+
+/*
+    Draws get recorded as packets of a 64 bit sort key and the index of the actual draw data (which stays with
+    the caller), sorting the packets orders the draws so that the most expensive state changes happen the least
+    Key layout, most significant first:
+        pass (4) | pipeline (12) | material instance (16) | mesh (16) | depth (16)
+    Everything except depth is just an id, only equality matters. Depth sorts front to back, which is what
+    opaque passes want, transparent ones would need to invert it
+    Sorting is a stable LSD radix sort over bytes, going wide for large lists
+*/
+namespace DrawList
+{
+    struct Packet
+    {
+        uint64_t key;
+        // into the callers draw data
+        uint32_t draw;
+    };
+
+    constexpr uint32_t passBits = 4;
+    constexpr uint32_t pipelineBits = 12;
+    constexpr uint32_t materialBits = 16;
+    constexpr uint32_t meshBits = 16;
+    constexpr uint32_t depthBits = 16;
+    static_assert(passBits + pipelineBits + materialBits + meshBits + depthBits == 64);
+
+    constexpr uint32_t depthShift = 0;
+    constexpr uint32_t meshShift = depthShift + depthBits;
+    constexpr uint32_t materialShift = meshShift + meshBits;
+    constexpr uint32_t pipelineShift = materialShift + materialBits;
+    constexpr uint32_t passShift = pipelineShift + pipelineBits;
+
+    // ids get truncated to their bit count, negative depths count as 0
+    uint64_t makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+
+    inline uint32_t keyField(uint64_t key, uint32_t shift, uint32_t bits)
+    {
+        return uint32_t(key >> shift) & ((1u << bits) - 1u);
+    }
+
+    /*
+        Sorts packets by key, packets with the same key keep their order
+        scratch is used as the second buffer, both keep their allocations for the next frame
+    */
+    void sort(std::vector<Packet>& packets, std::vector<Packet>& scratch);
+
+    /*
+        How often each part of the key changes between consecutive packets, the first packet counts as a change
+        A change of a more significant part counts for all less significant ones as well, a new pipeline for
+        example needs the material state set up again too
+    */
+    struct StateChanges
+    {
+        uint32_t passes = 0;
+        uint32_t pipelines = 0;
+        uint32_t materials = 0;
+        uint32_t meshes = 0;
+    };
+    StateChanges countStateChanges(Span<const Packet> packets);
+
+    // A run of sorted packets that can be issued as a single instanced draw
+    struct Batch
+    {
+        uint32_t firstPacket;
+        uint32_t packetCount;
+    };
+    /*
+        Merges consecutive packets whose keys only differ in depth, and for which canMerge(drawA, drawB) also
+        returns true (when they use different LODs of the same mesh for example), into one batch
+        Sorting puts all instances of a pass/pipeline/material/mesh combination next to each other, so each of
+        those ends up as a single batch as long as canMerge agrees
+    */
+    template <typename CanMerge>
+    void buildBatches(Span<const Packet> packets, CanMerge&& canMerge, std::vector<Batch>& batches)
+    {
+        constexpr uint64_t mergeMask = ~uint64_t(0) << meshShift;
+        for(uint32_t i = 0; i < packets.size(); i++)
+        {
+            if(i > 0)
+            {
+                const Packet& last = packets[batches.back().firstPacket];
+                if(((last.key ^ packets[i].key) & mergeMask) == 0 && canMerge(last.draw, packets[i].draw))
+                {
+                    batches.back().packetCount++;
+                    continue;
+                }
+            }
+            batches.push_back({.firstPacket = i, .packetCount = 1});
+        }
+    }
+} // namespace DrawList
@@ -3,6 +3,7 @@
 #include "../Buffer/Buffer.hpp"
 #include "../Graphics.hpp"
 #include "../Texture/Texture.hpp"
+#include <Datastructures/InlineVector.hpp>
 #include <Datastructures/Pool/Handle.hpp>
 #include <Datastructures/Pool/PoolHelpers.hpp>
 #include <Datastructures/StringMap.hpp>
@@ -66,7 +67,7 @@ namespace Material
     {
         std::string vertexSource;
         std::string fragmentSource;
-        std::vector<Texture::Format> colorFormats;
+        InlineVector<Texture::Format, 4> colorFormats;
         Texture::Format depthFormat = Texture::Format::UNDEFINED;
         Texture::Format stencilFormat = Texture::Format::UNDEFINED;
     };
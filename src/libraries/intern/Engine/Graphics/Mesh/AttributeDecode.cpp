@@ -0,0 +1,564 @@
+#include "AttributeDecode.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define DECODE_KERNELS_SSE2
+    #include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    #define DECODE_KERNELS_NEON
+    #include <arm_neon.h>
+#endif
+
+using namespace AttributeDecode;
+
+namespace
+{
+    // glTF spec: f = max(c / (2^(b-1) - 1), -1) for signed, f = c / (2^b - 1) for unsigned
+    constexpr float normalizeScale(ComponentType type)
+    {
+        switch(type)
+        {
+        case ComponentType::Int8:
+            return 1.0f / 127.0f;
+        case ComponentType::UInt8:
+            return 1.0f / 255.0f;
+        case ComponentType::Int16:
+            return 1.0f / 32767.0f;
+        case ComponentType::UInt16:
+            return 1.0f / 65535.0f;
+        default:
+            return 1.0f;
+        }
+    }
+
+    constexpr bool isSigned(ComponentType type)
+    {
+        return type == ComponentType::Int8 || type == ComponentType::Int16;
+    }
+
+    template <typename T>
+    T read(const std::byte* src)
+    {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        return value;
+    }
+
+    // Fixed size copies, these compile down to one or two (vector) moves instead of a memcpy call
+    template <size_t N>
+    void copyElement(std::byte* dst, const std::byte* src)
+    {
+        std::memcpy(dst, src, N);
+    }
+
+    template <size_t N>
+    void copyStridedFixed(std::byte* dst, size_t dstStride, const std::byte* src, size_t srcStride, size_t count)
+    {
+        for(size_t i = 0; i < count; i++)
+            copyElement<N>(dst + i * dstStride, src + i * srcStride);
+    }
+
+    template <size_t N>
+    void gatherIndexedFixed(
+        std::byte* dst,
+        size_t dstStride,
+        const std::byte* src,
+        const int32_t* indices,
+        size_t indexStride,
+        size_t count)
+    {
+        const auto* indexBytes = reinterpret_cast<const std::byte*>(indices);
+        for(size_t i = 0; i < count; i++)
+        {
+            const auto index = read<int32_t>(indexBytes + i * indexStride);
+            if(index < 0)
+                std::memset(dst + i * dstStride, 0, N);
+            else
+                copyElement<N>(dst + i * dstStride, src + static_cast<size_t>(index) * N);
+        }
+    }
+} // namespace
+
+// ---------------------------- Scalar ------------------------------------------
+
+namespace
+{
+    void copyStridedScalar(
+        std::byte* dst, size_t dstStride, const std::byte* src, size_t srcStride, size_t elementSize, size_t count)
+    {
+        for(size_t i = 0; i < count; i++)
+            std::memcpy(dst + i * dstStride, src + i * srcStride, elementSize);
+    }
+
+    void gatherIndexedScalar(
+        std::byte* dst,
+        size_t dstStride,
+        const std::byte* src,
+        size_t elementSize,
+        const int32_t* indices,
+        size_t indexStride,
+        size_t count)
+    {
+        const auto* indexBytes = reinterpret_cast<const std::byte*>(indices);
+        for(size_t i = 0; i < count; i++)
+        {
+            const auto index = read<int32_t>(indexBytes + i * indexStride);
+            if(index < 0)
+                std::memset(dst + i * dstStride, 0, elementSize);
+            else
+                std::memcpy(dst + i * dstStride, src + static_cast<size_t>(index) * elementSize, elementSize);
+        }
+    }
+
+    float convertComponent(const std::byte* src, ComponentType type, bool normalized)
+    {
+        float value = 0.0f;
+        switch(type)
+        {
+        case ComponentType::Int8:
+            value = static_cast<float>(read<int8_t>(src));
+            break;
+        case ComponentType::UInt8:
+            value = static_cast<float>(read<uint8_t>(src));
+            break;
+        case ComponentType::Int16:
+            value = static_cast<float>(read<int16_t>(src));
+            break;
+        case ComponentType::UInt16:
+            value = static_cast<float>(read<uint16_t>(src));
+            break;
+        case ComponentType::UInt32:
+            assert(!normalized && "Normalized uint32 isnt a valid attribute format");
+            return static_cast<float>(read<uint32_t>(src));
+        case ComponentType::Float32:
+            return read<float>(src);
+        }
+        if(!normalized)
+            return value;
+        value *= normalizeScale(type);
+        return isSigned(type) ? std::max(value, -1.0f) : value;
+    }
+
+    void toFloatScalar(float* dst, size_t dstStride, const Source& source)
+    {
+        auto* dstBytes = reinterpret_cast<std::byte*>(dst);
+        const size_t srcStride = source.effectiveStride();
+        const size_t compSize = componentSize(source.componentType);
+        for(size_t i = 0; i < source.count; i++)
+        {
+            const std::byte* element = source.data + i * srcStride;
+            for(uint32_t c = 0; c < source.componentCount; c++)
+            {
+                const float value =
+                    convertComponent(element + c * compSize, source.componentType, source.normalized);
+                std::memcpy(dstBytes + i * dstStride + c * sizeof(float), &value, sizeof(float));
+            }
+        }
+    }
+
+    void widenIndicesScalar(uint32_t* dst, const std::byte* src, ComponentType type, size_t count)
+    {
+        switch(type)
+        {
+        case ComponentType::UInt8:
+            for(size_t i = 0; i < count; i++)
+                dst[i] = read<uint8_t>(src + i);
+            break;
+        case ComponentType::UInt16:
+            for(size_t i = 0; i < count; i++)
+                dst[i] = read<uint16_t>(src + i * sizeof(uint16_t));
+            break;
+        case ComponentType::UInt32:
+            std::memcpy(dst, src, count * sizeof(uint32_t));
+            break;
+        default:
+            assert(false && "Indices have to be unsigned integers");
+        }
+    }
+
+    const AttributeDecode::Table scalarTable{
+        .name = "Scalar",
+        .copyStrided = copyStridedScalar,
+        .gatherIndexed = gatherIndexedScalar,
+        .toFloat = toFloatScalar,
+        .widenIndices = widenIndicesScalar,
+    };
+} // namespace
+
+// ---------------------------- Shared by the vectorized tables -------------------
+
+#if defined(DECODE_KERNELS_SSE2) || defined(DECODE_KERNELS_NEON)
+namespace
+{
+    void copyStridedFast(
+        std::byte* dst, size_t dstStride, const std::byte* src, size_t srcStride, size_t elementSize, size_t count)
+    {
+        if(dstStride == elementSize && srcStride == elementSize)
+        {
+            std::memcpy(dst, src, elementSize * count);
+            return;
+        }
+        switch(elementSize)
+        {
+        case 4:
+            return copyStridedFixed<4>(dst, dstStride, src, srcStride, count);
+        case 8:
+            return copyStridedFixed<8>(dst, dstStride, src, srcStride, count);
+        case 12:
+            return copyStridedFixed<12>(dst, dstStride, src, srcStride, count);
+        case 16:
+            return copyStridedFixed<16>(dst, dstStride, src, srcStride, count);
+        default:
+            return copyStridedScalar(dst, dstStride, src, srcStride, elementSize, count);
+        }
+    }
+
+    void gatherIndexedFast(
+        std::byte* dst,
+        size_t dstStride,
+        const std::byte* src,
+        size_t elementSize,
+        const int32_t* indices,
+        size_t indexStride,
+        size_t count)
+    {
+        switch(elementSize)
+        {
+        case 4:
+            return gatherIndexedFixed<4>(dst, dstStride, src, indices, indexStride, count);
+        case 8:
+            return gatherIndexedFixed<8>(dst, dstStride, src, indices, indexStride, count);
+        case 12:
+            return gatherIndexedFixed<12>(dst, dstStride, src, indices, indexStride, count);
+        case 16:
+            return gatherIndexedFixed<16>(dst, dstStride, src, indices, indexStride, count);
+        default:
+            return gatherIndexedScalar(dst, dstStride, src, elementSize, indices, indexStride, count);
+        }
+    }
+
+    /*
+        Reads N <= 8 bytes into the low bytes of an uint64_t (little endian)
+        Odd sizes are assembled from two loads, a memcpy into a stack variable would cause a store forwarding stall
+    */
+    template <size_t N>
+    uint64_t loadBits(const std::byte* src)
+    {
+        if constexpr(N == 1)
+            return read<uint8_t>(src);
+        else if constexpr(N == 2)
+            return read<uint16_t>(src);
+        else if constexpr(N == 3)
+            return read<uint16_t>(src) | (uint64_t(read<uint8_t>(src + 2)) << 16);
+        else if constexpr(N == 4)
+            return read<uint32_t>(src);
+        else if constexpr(N == 6)
+            return read<uint32_t>(src) | (uint64_t(read<uint16_t>(src + 4)) << 32);
+        else
+            return read<uint64_t>(src);
+    }
+
+    /*
+        Widen<type>(bits) returns the components packed in the low bytes of bits as 4 float lanes
+        (already normalized if requested), Store<N> writes the first N lanes
+        Converting one element per iteration keeps this independent of the stride, all 8/16bit
+        elements fit into a single 64bit load
+    */
+    template <ComponentType type, uint32_t N, typename Kernels>
+    void toFloatFixed(float* dst, size_t dstStride, const Source& source)
+    {
+        constexpr size_t elementSize = N * (type == ComponentType::Int8 || type == ComponentType::UInt8 ? 1 : 2);
+        auto* dstBytes = reinterpret_cast<std::byte*>(dst);
+        const size_t srcStride = source.effectiveStride();
+        const typename Kernels::Params params = Kernels::template params<type>(source.normalized);
+        for(size_t i = 0; i < source.count; i++)
+        {
+            const uint64_t bits = loadBits<elementSize>(source.data + i * srcStride);
+            const auto converted = Kernels::template widen<type>(bits, params);
+            Kernels::template store<N>(reinterpret_cast<float*>(dstBytes + i * dstStride), converted);
+        }
+    }
+
+    template <ComponentType type, typename Kernels>
+    void toFloatTyped(float* dst, size_t dstStride, const Source& source)
+    {
+        switch(source.componentCount)
+        {
+        case 1:
+            return toFloatFixed<type, 1, Kernels>(dst, dstStride, source);
+        case 2:
+            return toFloatFixed<type, 2, Kernels>(dst, dstStride, source);
+        case 3:
+            return toFloatFixed<type, 3, Kernels>(dst, dstStride, source);
+        case 4:
+            return toFloatFixed<type, 4, Kernels>(dst, dstStride, source);
+        default:
+            assert(false && "Invalid component count");
+        }
+    }
+
+    template <typename Kernels>
+    void toFloatFast(float* dst, size_t dstStride, const Source& source)
+    {
+        switch(source.componentType)
+        {
+        case ComponentType::Int8:
+            return toFloatTyped<ComponentType::Int8, Kernels>(dst, dstStride, source);
+        case ComponentType::UInt8:
+            return toFloatTyped<ComponentType::UInt8, Kernels>(dst, dstStride, source);
+        case ComponentType::Int16:
+            return toFloatTyped<ComponentType::Int16, Kernels>(dst, dstStride, source);
+        case ComponentType::UInt16:
+            return toFloatTyped<ComponentType::UInt16, Kernels>(dst, dstStride, source);
+        case ComponentType::Float32:
+            return copyStridedFast(
+                reinterpret_cast<std::byte*>(dst),
+                dstStride,
+                source.data,
+                source.effectiveStride(),
+                source.elementSize(),
+                source.count);
+        default:
+            // not worth vectorizing, uint32 vertex attributes dont really occur
+            return toFloatScalar(dst, dstStride, source);
+        }
+    }
+} // namespace
+#endif
+
+// ---------------------------- SSE2 --------------------------------------------
+
+#ifdef DECODE_KERNELS_SSE2
+namespace
+{
+    struct SSE2Kernels
+    {
+        struct Params
+        {
+            __m128 scale;
+            __m128 min;
+        };
+
+        template <ComponentType type>
+        static Params params(bool normalized)
+        {
+            return {
+                .scale = _mm_set1_ps(normalized ? normalizeScale(type) : 1.0f),
+                // clamping to -1 only matters for signed normalized values, otherwise it just has to be a no-op
+                .min = _mm_set1_ps(normalized && isSigned(type) ? -1.0f : -3.0e38f),
+            };
+        }
+
+        template <ComponentType type>
+        static __m128 widen(uint64_t bits, const Params& params)
+        {
+            const __m128i packed = _mm_cvtsi64_si128(static_cast<long long>(bits));
+            const __m128i zero = _mm_setzero_si128();
+            __m128i ints;
+            if constexpr(type == ComponentType::Int8)
+            {
+                // duplicate each byte into the upper parts and shift back down, sign extends
+                const __m128i b16 = _mm_unpacklo_epi8(packed, packed);
+                ints = _mm_srai_epi32(_mm_unpacklo_epi16(b16, b16), 24);
+            }
+            else if constexpr(type == ComponentType::UInt8)
+                ints = _mm_unpacklo_epi16(_mm_unpacklo_epi8(packed, zero), zero);
+            else if constexpr(type == ComponentType::Int16)
+                ints = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+            else
+                ints = _mm_unpacklo_epi16(packed, zero);
+            return _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(ints), params.scale), params.min);
+        }
+
+        template <uint32_t N>
+        static void store(float* dst, __m128 value)
+        {
+            if constexpr(N == 4)
+                _mm_storeu_ps(dst, value);
+            else if constexpr(N == 3)
+            {
+                _mm_storel_pi(reinterpret_cast<__m64*>(dst), value);
+                _mm_store_ss(dst + 2, _mm_movehl_ps(value, value));
+            }
+            else if constexpr(N == 2)
+                _mm_storel_pi(reinterpret_cast<__m64*>(dst), value);
+            else
+                _mm_store_ss(dst, value);
+        }
+    };
+
+    void widenIndicesSSE2(uint32_t* dst, const std::byte* src, ComponentType type, size_t count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        if(type == ComponentType::UInt16)
+        {
+            for(; i + 8 <= count; i += 8)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(uint16_t)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(v, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(v, zero));
+            }
+        }
+        else if(type == ComponentType::UInt8)
+        {
+            for(; i + 16 <= count; i += 16)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                const __m128i lo = _mm_unpacklo_epi8(v, zero);
+                const __m128i hi = _mm_unpackhi_epi8(v, zero);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+            }
+        }
+        widenIndicesScalar(dst + i, src + i * componentSize(type), type, count - i);
+    }
+
+    const AttributeDecode::Table sse2Table{
+        .name = "SSE2",
+        .copyStrided = copyStridedFast,
+        .gatherIndexed = gatherIndexedFast,
+        .toFloat = toFloatFast<SSE2Kernels>,
+        .widenIndices = widenIndicesSSE2,
+    };
+} // namespace
+#endif
+
+// ---------------------------- NEON --------------------------------------------
+
+#ifdef DECODE_KERNELS_NEON
+namespace
+{
+    struct NEONKernels
+    {
+        struct Params
+        {
+            float scale;
+            float32x4_t min;
+        };
+
+        template <ComponentType type>
+        static Params params(bool normalized)
+        {
+            return {
+                .scale = normalized ? normalizeScale(type) : 1.0f,
+                .min = vdupq_n_f32(normalized && isSigned(type) ? -1.0f : -3.0e38f),
+            };
+        }
+
+        template <ComponentType type>
+        static float32x4_t widen(uint64_t bits, const Params& params)
+        {
+            int32x4_t ints;
+            if constexpr(type == ComponentType::Int8)
+                ints = vmovl_s16(vget_low_s16(vmovl_s8(vcreate_s8(bits))));
+            else if constexpr(type == ComponentType::UInt8)
+                ints = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vcreate_u8(bits)))));
+            else if constexpr(type == ComponentType::Int16)
+                ints = vmovl_s16(vcreate_s16(bits));
+            else
+                ints = vreinterpretq_s32_u32(vmovl_u16(vcreate_u16(bits)));
+            return vmaxq_f32(vmulq_n_f32(vcvtq_f32_s32(ints), params.scale), params.min);
+        }
+
+        template <uint32_t N>
+        static void store(float* dst, float32x4_t value)
+        {
+            if constexpr(N == 4)
+                vst1q_f32(dst, value);
+            else if constexpr(N == 3)
+            {
+                vst1_f32(dst, vget_low_f32(value));
+                vst1q_lane_f32(dst + 2, value, 2);
+            }
+            else if constexpr(N == 2)
+                vst1_f32(dst, vget_low_f32(value));
+            else
+                vst1q_lane_f32(dst, value, 0);
+        }
+    };
+
+    void widenIndicesNEON(uint32_t* dst, const std::byte* src, ComponentType type, size_t count)
+    {
+        size_t i = 0;
+        if(type == ComponentType::UInt16)
+        {
+            for(; i + 8 <= count; i += 8)
+            {
+                const uint16x8_t v = vld1q_u16(reinterpret_cast<const uint16_t*>(src + i * sizeof(uint16_t)));
+                vst1q_u32(dst + i, vmovl_u16(vget_low_u16(v)));
+                vst1q_u32(dst + i + 4, vmovl_high_u16(v));
+            }
+        }
+        else if(type == ComponentType::UInt8)
+        {
+            for(; i + 16 <= count; i += 16)
+            {
+                const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+                const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+                const uint16x8_t hi = vmovl_high_u8(v);
+                vst1q_u32(dst + i, vmovl_u16(vget_low_u16(lo)));
+                vst1q_u32(dst + i + 4, vmovl_high_u16(lo));
+                vst1q_u32(dst + i + 8, vmovl_u16(vget_low_u16(hi)));
+                vst1q_u32(dst + i + 12, vmovl_high_u16(hi));
+            }
+        }
+        widenIndicesScalar(dst + i, src + i * componentSize(type), type, count - i);
+    }
+
+    const AttributeDecode::Table neonTable{
+        .name = "NEON",
+        .copyStrided = copyStridedFast,
+        .gatherIndexed = gatherIndexedFast,
+        .toFloat = toFloatFast<NEONKernels>,
+        .widenIndices = widenIndicesNEON,
+    };
+} // namespace
+#endif
+
+// ------------------------------------------------------------------------------
+
+namespace AttributeDecode
+{
+    size_t componentSize(ComponentType type)
+    {
+        switch(type)
+        {
+        case ComponentType::Int8:
+        case ComponentType::UInt8:
+            return 1;
+        case ComponentType::Int16:
+        case ComponentType::UInt16:
+            return 2;
+        case ComponentType::UInt32:
+        case ComponentType::Float32:
+            return 4;
+        }
+        return 0;
+    }
+
+    const Table& get()
+    {
+#if defined(DECODE_KERNELS_SSE2)
+        return sse2Table;
+#elif defined(DECODE_KERNELS_NEON)
+        return neonTable;
+#else
+        return scalarTable;
+#endif
+    }
+
+    const Table& scalar() { return scalarTable; }
+
+    void toFloat(float* dst, size_t dstStride, const Source& source) { get().toFloat(dst, dstStride, source); }
+
+    void widenIndices(uint32_t* dst, const std::byte* src, ComponentType type, size_t count)
+    {
+        get().widenIndices(dst, src, type, count);
+    }
+} // namespace AttributeDecode
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Kernels for turning vertex/index data from file formats (glTF accessors, OBJ index triplets, ...)
+    into the layout expected by Mesh: strided gathers, interleaving into the attribute buffer,
+    normalized integer -> float conversion and index widening
+    The implementation only uses baseline instruction sets, so its picked at compile time:
+        x64:     SSE2
+        aarch64: NEON
+        scalar otherwise
+*/
+namespace AttributeDecode
+{
+    enum class ComponentType : uint8_t
+    {
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        UInt32,
+        Float32,
+    };
+
+    size_t componentSize(ComponentType type);
+
+    // Strided attribute stream in its source format
+    struct Source
+    {
+        const std::byte* data = nullptr;
+        // 0 means tightly packed
+        size_t stride = 0;
+        size_t count = 0;
+        ComponentType componentType = ComponentType::Float32;
+        // 1 to 4
+        uint32_t componentCount = 1;
+        // integer values get mapped to [0,1] (unsigned) or [-1,1] (signed) instead of being converted as is
+        bool normalized = false;
+
+        [[nodiscard]] size_t elementSize() const { return componentSize(componentType) * componentCount; }
+        [[nodiscard]] size_t effectiveStride() const { return stride != 0 ? stride : elementSize(); }
+    };
+
+    struct Table
+    {
+        const char* name = "";
+
+        // copies count elements of elementSize bytes each, src and dst can have any stride
+        void (*copyStrided)(
+            std::byte* dst,
+            size_t dstStride,
+            const std::byte* src,
+            size_t srcStride,
+            size_t elementSize,
+            size_t count) = nullptr;
+        /*
+            dst[i] = src[indices[i]], with elementSize sized elements in a tightly packed src
+            indexStride is in bytes, so the indices can be read directly out of an array of structs
+            Negative indices mark missing data and write zeros
+        */
+        void (*gatherIndexed)(
+            std::byte* dst,
+            size_t dstStride,
+            const std::byte* src,
+            size_t elementSize,
+            const int32_t* indices,
+            size_t indexStride,
+            size_t count) = nullptr;
+        // converts source into source.componentCount floats per element, written dstStride bytes apart
+        void (*toFloat)(float* dst, size_t dstStride, const Source& source) = nullptr;
+        // tightly packed UInt8/UInt16/UInt32 indices -> uint32_t
+        void (*widenIndices)(uint32_t* dst, const std::byte* src, ComponentType type, size_t count) = nullptr;
+    };
+
+    const Table& get();
+
+    // Always available, mainly here so the vectorized versions can be tested against it
+    const Table& scalar();
+
+    // Shorthands for get(), float sources are copied without conversion
+    void toFloat(float* dst, size_t dstStride, const Source& source);
+    void widenIndices(uint32_t* dst, const std::byte* src, ComponentType type, size_t count);
+} // namespace AttributeDecode
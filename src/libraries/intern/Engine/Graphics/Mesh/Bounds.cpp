@@ -0,0 +1,203 @@
+#include "Bounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define BOUNDS_SSE2
+    #include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    #define BOUNDS_NEON
+    #include <arm_neon.h>
+#endif
+
+/*
+    The vectorized loops load 4 floats per position, so the 4th float of the last position would be read past
+    the end of the data. They always leave at least the last position to the scalar loops
+*/
+
+namespace
+{
+    const float* positionAt(const float* positions, size_t stride, size_t index)
+    {
+        return reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(positions) + index * stride);
+    }
+} // namespace
+
+namespace Bounds
+{
+    void AABB::merge(const AABB& other)
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            min[i] = std::min(min[i], other.min[i]);
+            max[i] = std::max(max[i], other.max[i]);
+        }
+    }
+
+    void Sphere::merge(const Sphere& other)
+    {
+        if(other.isEmpty())
+            return;
+        if(isEmpty())
+        {
+            *this = other;
+            return;
+        }
+        const float offset[3] = {
+            other.center[0] - center[0], other.center[1] - center[1], other.center[2] - center[2]};
+        const float distance = std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+        if(distance + other.radius <= radius)
+            return;
+        if(distance + radius <= other.radius)
+        {
+            *this = other;
+            return;
+        }
+        const float newRadius = (distance + radius + other.radius) * 0.5f;
+        // distance cant be 0 here, one sphere would contain the other
+        const float t = (newRadius - radius) / distance;
+        for(int c = 0; c < 3; c++)
+            center[c] += offset[c] * t;
+        radius = newRadius;
+    }
+
+    AABB computeAABB(const float* positions, size_t stride, size_t count)
+    {
+        AABB result;
+        size_t i = 0;
+
+#if defined(BOUNDS_SSE2)
+        if(count > 4)
+        {
+            __m128 min = _mm_set1_ps(result.min[0]);
+            __m128 max = _mm_set1_ps(result.max[0]);
+            // reducing 4 positions first keeps the dependency chains on min/max short
+            for(; i + 4 < count; i += 4)
+            {
+                const __m128 p0 = _mm_loadu_ps(positionAt(positions, stride, i));
+                const __m128 p1 = _mm_loadu_ps(positionAt(positions, stride, i + 1));
+                const __m128 p2 = _mm_loadu_ps(positionAt(positions, stride, i + 2));
+                const __m128 p3 = _mm_loadu_ps(positionAt(positions, stride, i + 3));
+                min = _mm_min_ps(min, _mm_min_ps(_mm_min_ps(p0, p1), _mm_min_ps(p2, p3)));
+                max = _mm_max_ps(max, _mm_max_ps(_mm_max_ps(p0, p1), _mm_max_ps(p2, p3)));
+            }
+            alignas(16) float minOut[4];
+            alignas(16) float maxOut[4];
+            _mm_store_ps(minOut, min);
+            _mm_store_ps(maxOut, max);
+            std::copy_n(minOut, 3, result.min);
+            std::copy_n(maxOut, 3, result.max);
+        }
+#elif defined(BOUNDS_NEON)
+        if(count > 4)
+        {
+            float32x4_t min = vdupq_n_f32(result.min[0]);
+            float32x4_t max = vdupq_n_f32(result.max[0]);
+            for(; i + 4 < count; i += 4)
+            {
+                const float32x4_t p0 = vld1q_f32(positionAt(positions, stride, i));
+                const float32x4_t p1 = vld1q_f32(positionAt(positions, stride, i + 1));
+                const float32x4_t p2 = vld1q_f32(positionAt(positions, stride, i + 2));
+                const float32x4_t p3 = vld1q_f32(positionAt(positions, stride, i + 3));
+                min = vminq_f32(min, vminq_f32(vminq_f32(p0, p1), vminq_f32(p2, p3)));
+                max = vmaxq_f32(max, vmaxq_f32(vmaxq_f32(p0, p1), vmaxq_f32(p2, p3)));
+            }
+            float minOut[4];
+            float maxOut[4];
+            vst1q_f32(minOut, min);
+            vst1q_f32(maxOut, max);
+            std::copy_n(minOut, 3, result.min);
+            std::copy_n(maxOut, 3, result.max);
+        }
+#endif
+
+        for(; i < count; i++)
+        {
+            const float* p = positionAt(positions, stride, i);
+            for(int c = 0; c < 3; c++)
+            {
+                result.min[c] = std::min(result.min[c], p[c]);
+                result.max[c] = std::max(result.max[c], p[c]);
+            }
+        }
+        return result;
+    }
+
+    Sphere computeSphere(const float* positions, size_t stride, size_t count, const AABB& aabb)
+    {
+        Sphere result;
+        if(count == 0 || aabb.isEmpty())
+            return result;
+        for(int c = 0; c < 3; c++)
+            result.center[c] = (aabb.min[c] + aabb.max[c]) * 0.5f;
+
+        float maxDistanceSq = 0.0f;
+        size_t i = 0;
+
+#if defined(BOUNDS_SSE2)
+        if(count > 4)
+        {
+            const __m128 cx = _mm_set1_ps(result.center[0]);
+            const __m128 cy = _mm_set1_ps(result.center[1]);
+            const __m128 cz = _mm_set1_ps(result.center[2]);
+            __m128 maxSq = _mm_setzero_ps();
+            for(; i + 4 < count; i += 4)
+            {
+                // transposed, so each lane holds one position
+                __m128 x = _mm_loadu_ps(positionAt(positions, stride, i));
+                __m128 y = _mm_loadu_ps(positionAt(positions, stride, i + 1));
+                __m128 z = _mm_loadu_ps(positionAt(positions, stride, i + 2));
+                __m128 w = _mm_loadu_ps(positionAt(positions, stride, i + 3));
+                _MM_TRANSPOSE4_PS(x, y, z, w);
+                const __m128 dx = _mm_sub_ps(x, cx);
+                const __m128 dy = _mm_sub_ps(y, cy);
+                const __m128 dz = _mm_sub_ps(z, cz);
+                const __m128 distanceSq =
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                maxSq = _mm_max_ps(maxSq, distanceSq);
+            }
+            alignas(16) float maxOut[4];
+            _mm_store_ps(maxOut, maxSq);
+            maxDistanceSq = std::max(std::max(maxOut[0], maxOut[1]), std::max(maxOut[2], maxOut[3]));
+        }
+#elif defined(BOUNDS_NEON)
+        if(count > 4)
+        {
+            const float32x4_t cx = vdupq_n_f32(result.center[0]);
+            const float32x4_t cy = vdupq_n_f32(result.center[1]);
+            const float32x4_t cz = vdupq_n_f32(result.center[2]);
+            float32x4_t maxSq = vdupq_n_f32(0.0f);
+            for(; i + 4 < count; i += 4)
+            {
+                // vld3q would need a stride of 12, so transpose by hand
+                float x[4], y[4], z[4];
+                for(int k = 0; k < 4; k++)
+                {
+                    const float* p = positionAt(positions, stride, i + k);
+                    x[k] = p[0];
+                    y[k] = p[1];
+                    z[k] = p[2];
+                }
+                const float32x4_t dx = vsubq_f32(vld1q_f32(x), cx);
+                const float32x4_t dy = vsubq_f32(vld1q_f32(y), cy);
+                const float32x4_t dz = vsubq_f32(vld1q_f32(z), cz);
+                maxSq = vmaxq_f32(maxSq, vmlaq_f32(vmlaq_f32(vmulq_f32(dx, dx), dy, dy), dz, dz));
+            }
+            maxDistanceSq = vmaxvq_f32(maxSq);
+        }
+#endif
+
+        for(; i < count; i++)
+        {
+            const float* p = positionAt(positions, stride, i);
+            const float dx = p[0] - result.center[0];
+            const float dy = p[1] - result.center[1];
+            const float dz = p[2] - result.center[2];
+            maxDistanceSq = std::max(maxDistanceSq, dx * dx + dy * dy + dz * dz);
+        }
+        result.radius = std::sqrt(maxDistanceSq);
+        return result;
+    }
+} // namespace Bounds
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+/*
+    Bounding volumes of vertex positions, computed once per mesh when it gets created
+    The reductions over the positions use SSE2/NEON where available
+    Positions are float3, the stride can be anything >= 12 bytes
+*/
+namespace Bounds
+{
+    // Same layout as the aabb in MeshData in GPUScene/Structs.hlsl
+    struct AABB
+    {
+        // empty by default, so merging into it just works
+        float min[3] = {
+            std::numeric_limits<float>::max(),
+            std::numeric_limits<float>::max(),
+            std::numeric_limits<float>::max()};
+        float max[3] = {
+            -std::numeric_limits<float>::max(),
+            -std::numeric_limits<float>::max(),
+            -std::numeric_limits<float>::max()};
+
+        [[nodiscard]] bool isEmpty() const { return min[0] > max[0] || min[1] > max[1] || min[2] > max[2]; }
+        void merge(const AABB& other);
+    };
+
+    struct Sphere
+    {
+        float center[3] = {0.0f, 0.0f, 0.0f};
+        // negative if empty
+        float radius = -1.0f;
+
+        [[nodiscard]] bool isEmpty() const { return radius < 0.0f; }
+        // smallest sphere containing both spheres
+        void merge(const Sphere& other);
+    };
+
+    AABB computeAABB(const float* positions, size_t stride, size_t count);
+    /*
+        Centered on the aabb (which has to be the one of the same positions), so not the minimal sphere
+        but a lot cheaper to compute
+    */
+    Sphere computeSphere(const float* positions, size_t stride, size_t count, const AABB& aabb);
+} // namespace Bounds
@@ -1,8 +1,15 @@
 #include "Mesh.hpp"
+#include "MeshOptimize.hpp"
+#include "Simplify.hpp"
+#include "VertexQuantization.hpp"
 #include <Engine/ResourceManager/ResourceManager.hpp>
 #include <TinyOBJ/tiny_obj_loader.h>
+#include <algorithm>
+#include <cstring>
+#include <glm/common.hpp>
 #include <glm/gtc/epsilon.hpp>
 #include <iostream>
+#include <limits>
 
 /*
 VertexInputDescription VertexInputDescription::getDefault()
@@ -59,11 +66,47 @@ VertexInputDescription VertexInputDescription::getDefault()
 }
 */
 
-size_t Mesh::VertexAttributeFormat::normalSize() const { return sizeof(glm::vec3); }
+Mesh::VertexEncoding Mesh::VertexEncoding::compact(bool quantizePositions)
+{
+    return VertexEncoding{
+        .position = quantizePositions ? PositionEncoding::UNorm16 : PositionEncoding::Float3,
+        .normal = NormalEncoding::Oct16,
+        .color = ColorEncoding::RGBA8,
+        .uv = UVEncoding::UNorm16,
+    };
+}
+
+bool Mesh::VertexEncoding::isFloat() const
+{
+    return position == PositionEncoding::Float3 && normal == NormalEncoding::Float3 &&
+           color == ColorEncoding::Float3 && uv == UVEncoding::Float2;
+}
+
+size_t Mesh::VertexEncoding::positionSize() const
+{
+    return position == PositionEncoding::Float3 ? sizeof(glm::vec3) : 4 * sizeof(uint16_t);
+}
+
+uint32_t Mesh::VertexEncoding::bits() const
+{
+    // 2 bits each, has to match the ENCODING_ defines in Structs.hlsl
+    return uint32_t(position) | uint32_t(normal) << 2 | uint32_t(color) << 4 | uint32_t(uv) << 6;
+}
+
+size_t Mesh::VertexAttributeFormat::normalSize() const
+{
+    return encoding.normal == NormalEncoding::Float3 ? sizeof(glm::vec3) : sizeof(uint32_t);
+}
 size_t Mesh::VertexAttributeFormat::normalOffset() const { return 0; }
-size_t Mesh::VertexAttributeFormat::colorSize() const { return sizeof(glm::vec3); }
+size_t Mesh::VertexAttributeFormat::colorSize() const
+{
+    return encoding.color == ColorEncoding::Float3 ? sizeof(glm::vec3) : sizeof(uint32_t);
+}
 size_t Mesh::VertexAttributeFormat::colorOffset() const { return normalSize(); }
-size_t Mesh::VertexAttributeFormat::uvSize() const { return sizeof(glm::vec2); }
+size_t Mesh::VertexAttributeFormat::uvSize() const
+{
+    return encoding.uv == UVEncoding::Float2 ? sizeof(glm::vec2) : sizeof(uint32_t);
+}
 size_t Mesh::VertexAttributeFormat::uvOffset(uint32_t i) const
 {
     return colorOffset() + colorSize() + i * uvSize();
@@ -73,6 +116,212 @@ size_t Mesh::VertexAttributeFormat::combinedSize() const
     return normalSize() + colorSize() + (1 + additionalUVCount) * uvSize();
 }
 
+Mesh::EncodedVertices Mesh::encodeVertices(
+    Span<const PositionType> positions,
+    Span<const std::byte> attributes,
+    VertexAttributeFormat attributeFormat,
+    VertexEncoding encoding)
+{
+    assert(attributeFormat.encoding.isFloat());
+    const size_t vertexCount = positions.size();
+    const size_t srcStride = attributeFormat.combinedSize();
+    assert(attributes.size() == vertexCount * srcStride);
+    const uint32_t uvCount = 1 + attributeFormat.additionalUVCount;
+
+    EncodedVertices result;
+    result.attributeFormat = VertexAttributeFormat{
+        .additionalUVCount = attributeFormat.additionalUVCount,
+        .encoding = encoding,
+    };
+    const VertexAttributeFormat& dstFormat = result.attributeFormat;
+    const size_t dstStride = dstFormat.combinedSize();
+
+    const auto readAttribute = [&](size_t vertex, size_t offset, auto& out)
+    { std::memcpy(&out, attributes.data() + vertex * srcStride + offset, sizeof(out)); };
+
+    // quantization ranges are the bounds of the data, scale is never 0 so decoding stays finite
+    const auto safeScale = [](auto extent)
+    {
+        for(int c = 0; c < extent.length(); c++)
+            extent[c] = extent[c] > 0.0f ? extent[c] : 1.0f;
+        return extent;
+    };
+    if(encoding.position == PositionEncoding::UNorm16 && vertexCount > 0)
+    {
+        glm::vec3 min = positions[0];
+        glm::vec3 max = positions[0];
+        for(const PositionType& position : positions)
+        {
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+        result.dequantization.positionOffset = min;
+        result.dequantization.positionScale = safeScale(max - min);
+    }
+    if(encoding.uv == UVEncoding::UNorm16 && vertexCount > 0)
+    {
+        glm::vec2 min{std::numeric_limits<float>::max()};
+        glm::vec2 max{std::numeric_limits<float>::lowest()};
+        for(size_t v = 0; v < vertexCount; v++)
+        {
+            for(uint32_t set = 0; set < uvCount; set++)
+            {
+                glm::vec2 uv;
+                readAttribute(v, attributeFormat.uvOffset(set), uv);
+                min = glm::min(min, uv);
+                max = glm::max(max, uv);
+            }
+        }
+        result.dequantization.uvOffset = min;
+        result.dequantization.uvScale = safeScale(max - min);
+    }
+    const Dequantization& dq = result.dequantization;
+
+    result.positions.resize(vertexCount * encoding.positionSize());
+    if(encoding.position == PositionEncoding::Float3)
+    {
+        std::memcpy(result.positions.data(), positions.data(), result.positions.size());
+    }
+    else
+    {
+        for(size_t v = 0; v < vertexCount; v++)
+        {
+            const glm::vec3 normalized = (positions[v] - dq.positionOffset) / dq.positionScale;
+            const uint16_t packed[4] = {
+                VertexQuantization::encodeUNorm16(normalized.x),
+                VertexQuantization::encodeUNorm16(normalized.y),
+                VertexQuantization::encodeUNorm16(normalized.z),
+                0};
+            std::memcpy(&result.positions[v * sizeof(packed)], packed, sizeof(packed));
+        }
+    }
+
+    result.attributes.resize(vertexCount * dstStride);
+    for(size_t v = 0; v < vertexCount; v++)
+    {
+        std::byte* dst = result.attributes.data() + v * dstStride;
+
+        glm::vec3 normal;
+        readAttribute(v, attributeFormat.normalOffset(), normal);
+        if(encoding.normal == NormalEncoding::Float3)
+        {
+            std::memcpy(dst + dstFormat.normalOffset(), &normal, sizeof(normal));
+        }
+        else
+        {
+            const uint32_t packed = VertexQuantization::encodeOctahedral16(normal.x, normal.y, normal.z);
+            std::memcpy(dst + dstFormat.normalOffset(), &packed, sizeof(packed));
+        }
+
+        glm::vec3 color;
+        readAttribute(v, attributeFormat.colorOffset(), color);
+        if(encoding.color == ColorEncoding::Float3)
+        {
+            std::memcpy(dst + dstFormat.colorOffset(), &color, sizeof(color));
+        }
+        else
+        {
+            const uint32_t packed = VertexQuantization::encodeRGBA8(color.r, color.g, color.b, 1.0f);
+            std::memcpy(dst + dstFormat.colorOffset(), &packed, sizeof(packed));
+        }
+
+        for(uint32_t set = 0; set < uvCount; set++)
+        {
+            glm::vec2 uv;
+            readAttribute(v, attributeFormat.uvOffset(set), uv);
+            uint16_t packed[2];
+            switch(encoding.uv)
+            {
+            case UVEncoding::Float2:
+                std::memcpy(dst + dstFormat.uvOffset(set), &uv, sizeof(uv));
+                continue;
+            case UVEncoding::Half2:
+                packed[0] = VertexQuantization::floatToHalf(uv.x);
+                packed[1] = VertexQuantization::floatToHalf(uv.y);
+                break;
+            case UVEncoding::UNorm16:
+            {
+                const glm::vec2 normalized = (uv - dq.uvOffset) / dq.uvScale;
+                packed[0] = VertexQuantization::encodeUNorm16(normalized.x);
+                packed[1] = VertexQuantization::encodeUNorm16(normalized.y);
+                break;
+            }
+            }
+            std::memcpy(dst + dstFormat.uvOffset(set), packed, sizeof(packed));
+        }
+    }
+    return result;
+}
+
+std::vector<Mesh::LOD> Mesh::generateLODs(
+    std::vector<uint32_t>& indices,
+    Span<const PositionType> positions,
+    Span<const std::byte> attributes,
+    VertexAttributeFormat attributeFormat,
+    const Simplify::LODOptions& options,
+    bool optimizeVertexCache)
+{
+    assert(attributeFormat.encoding.isFloat());
+    std::vector<LOD> lods{LOD{.indexOffset = 0, .indexCount = uint32_t(indices.size()), .error = 0.0f}};
+    if(options.maxLODs <= 1 || positions.empty())
+        return lods;
+
+    // normals matter less than uvs, a wrong uv is directly visible as a distorted texture
+    Simplify::Attributes simplifyAttributes{
+        .data = reinterpret_cast<const float*>(attributes.data() + attributeFormat.normalOffset()),
+        .stride = attributeFormat.combinedSize(),
+        .count = 5,
+    };
+    const size_t uvOffset = attributeFormat.uvOffset(0) - attributeFormat.normalOffset();
+    const auto uvComponent = uint32_t(uvOffset / sizeof(float));
+    const uint32_t components[5] = {0, 1, 2, uvComponent, uvComponent + 1};
+    const float weights[5] = {0.5f, 0.5f, 0.5f, 1.0f, 1.0f};
+    std::memcpy(simplifyAttributes.components, components, sizeof(components));
+    std::memcpy(simplifyAttributes.weights, weights, sizeof(weights));
+
+    std::vector<Simplify::LOD> simplified = Simplify::generateLODs(
+        indices.data(),
+        indices.size(),
+        reinterpret_cast<const float*>(positions.data()),
+        sizeof(PositionType),
+        positions.size(),
+        simplifyAttributes,
+        Simplify::LODOptions{
+            .maxLODs = std::min<uint32_t>(options.maxLODs, MAX_LODS),
+            .reduction = options.reduction,
+            .maxError = options.maxError,
+            .lockBorder = options.lockBorder,
+        });
+    for(Simplify::LOD& lod : simplified)
+    {
+        if(optimizeVertexCache)
+        {
+            MeshOptimize::optimizeVertexCache(
+                lod.indices.data(), lod.indices.data(), lod.indices.size(), positions.size());
+        }
+        lods.push_back(LOD{
+            .indexOffset = uint32_t(indices.size()),
+            .indexCount = uint32_t(lod.indices.size()),
+            .error = lod.error,
+        });
+        indices.insert(indices.end(), lod.indices.begin(), lod.indices.end());
+    }
+    return lods;
+}
+
+uint32_t Mesh::selectLOD(
+    const RenderData& renderData, float worldScale, float distance, float projectionScale, float maxPixelError)
+{
+    // errors only grow with the LOD index, so go from the coarsest one down
+    const float pixelsPerUnit = worldScale * projectionScale / std::max(distance, 1e-4f);
+    for(uint32_t lod = renderData.lodCount - 1; lod > 0; lod--)
+    {
+        if(renderData.lods[lod].error * pixelsPerUnit <= maxPixelError)
+            return lod;
+    }
+    return 0;
+}
+
 /*
 
 // for mikktspace
@@ -1,12 +1,15 @@
 #pragma once
 
 #include "../Buffer/Buffer.hpp"
+#include "Bounds.hpp"
+#include "Simplify.hpp"
 
 #include <Datastructures/Pool/Handle.hpp>
 #include <Datastructures/Span.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <array>
 #include <mikktspace/mikktspace.h>
 #include <string>
 #include <vector>
@@ -28,16 +31,64 @@ struct Mesh
     using PositionType = glm::vec3;
     using TexCoordType = glm::vec2;
 
+    /*
+        Compact encodings vertex data can be stored in on the GPU, decoded by MeshData in GPUScene/Structs.hlsl
+        Every encoded attribute is a multiple of 4 bytes, so it can be read with ByteAddressBuffer loads
+    */
+    enum class PositionEncoding : uint8_t
+    {
+        Float3,
+        // 3x uint16 + 2 bytes padding, dequantized with the per mesh position offset & scale
+        UNorm16,
+    };
+    enum class NormalEncoding : uint8_t
+    {
+        Float3,
+        // octahedral mapping, 2x snorm16
+        Oct16,
+    };
+    enum class ColorEncoding : uint8_t
+    {
+        Float3,
+        // alpha unused
+        RGBA8,
+    };
+    enum class UVEncoding : uint8_t
+    {
+        Float2,
+        Half2,
+        // 2x uint16, dequantized with the per mesh uv offset & scale
+        UNorm16,
+    };
+    struct VertexEncoding
+    {
+        PositionEncoding position = PositionEncoding::Float3;
+        NormalEncoding normal = NormalEncoding::Float3;
+        ColorEncoding color = ColorEncoding::Float3;
+        UVEncoding uv = UVEncoding::Float2;
+
+        // smallest encodings for all attributes, positions are only quantized when asked for
+        static VertexEncoding compact(bool quantizePositions = false);
+
+        [[nodiscard]] bool isFloat() const;
+        [[nodiscard]] size_t positionSize() const;
+        // as stored in GPUMeshData, see MeshData in GPUScene/Structs.hlsl
+        [[nodiscard]] uint32_t bits() const;
+    };
+
     /*
         Vertex Attributes have to be layed out as:
-            float3 normal
-            float3 color (float4 ?)
-            float2[] uvs
+            normal
+            color
+            uvs[]
+        with the sizes depending on encoding (all floats by default)
         Passed as byte array to functions together with this format struct
     */
     struct VertexAttributeFormat
     {
         uint32_t additionalUVCount = 0;
+        // position encoding is unused here, positions are stored in their own buffer
+        VertexEncoding encoding;
         size_t normalSize() const;
         size_t normalOffset() const;
         size_t colorSize() const;
@@ -46,6 +97,32 @@ struct Mesh
         size_t uvOffset(uint32_t i) const;
         size_t combinedSize() const;
     };
+
+    // stored = (value - offset) / scale, identity for float encodings
+    struct Dequantization
+    {
+        glm::vec3 positionOffset{0.0f};
+        glm::vec3 positionScale{1.0f};
+        glm::vec2 uvOffset{0.0f};
+        glm::vec2 uvScale{1.0f};
+    };
+
+    struct EncodedVertices
+    {
+        std::vector<std::byte> positions;
+        std::vector<std::byte> attributes;
+        VertexAttributeFormat attributeFormat;
+        Dequantization dequantization;
+    };
+    /*
+        Converts float positions and attributes (in a float VertexAttributeFormat) into the given encoding
+        Dequantization ranges are the bounds of the data
+    */
+    static EncodedVertices encodeVertices(
+        Span<const PositionType> positions,
+        Span<const std::byte> attributes,
+        VertexAttributeFormat attributeFormat,
+        VertexEncoding encoding);
     template <uint32_t numExtraUVs>
     struct BasicVertexAttributes
     {
@@ -55,19 +132,63 @@ struct Mesh
     };
 
     static constexpr auto MAX_SUBMESHES = 6;
+    static constexpr auto MAX_LODS = 4;
+
+    // Range of the index buffer used by one level of detail, LOD 0 is the full resolution mesh
+    struct LOD
+    {
+        uint32_t indexOffset = 0;
+        uint32_t indexCount = 0;
+        // largest deviation from LOD 0, in object space units, see Simplify.hpp
+        float error = 0.0f;
+    };
+    /*
+        Simplifies the triangles in indices and appends the indices of the generated LODs
+        attributes have to be in the float layout, normals and the first uv set are part of the error
+        Returns the ranges of all LODs, including LOD 0 (the original indices)
+    */
+    static std::vector<LOD> generateLODs(
+        std::vector<uint32_t>& indices,
+        Span<const PositionType> positions,
+        Span<const std::byte> attributes,
+        VertexAttributeFormat attributeFormat,
+        const Simplify::LODOptions& options,
+        bool optimizeVertexCache);
 
     struct RenderData
     {
         // This does not define GPU representation, change GPUMeshData instead!
+        // of all LODs together, the index buffer contains them back to back
         uint32_t indexCount = 0;
-        uint32_t additionalUVCount = 0;
+        uint32_t lodCount = 1;
+        std::array<LOD, MAX_LODS> lods;
+        VertexAttributeFormat attributeFormat;
+        Dequantization dequantization;
+        // object space, of all vertices
+        Bounds::AABB aabb;
+        Bounds::Sphere boundingSphere;
         Buffer::Handle indexBuffer = Buffer::Handle::Invalid();
         Buffer::Handle positionBuffer = Buffer::Handle::Invalid();
         Buffer::Handle attributeBuffer = Buffer::Handle::Invalid();
-
-        uint32_t gpuIndex = 0xFFFFFFFF;
+        // cluster data from Meshlets::build, meshletCount is 0 if none got built
+        uint32_t meshletCount = 0;
+        Buffer::Handle meshletBuffer = Buffer::Handle::Invalid();
+        Buffer::Handle meshletVertexBuffer = Buffer::Handle::Invalid();
+        Buffer::Handle meshletTriangleBuffer = Buffer::Handle::Invalid();
     };
 
+    /*
+        Coarsest LOD whose error, projected onto the screen, stays below maxPixelError
+        worldScale: largest scale of the object to world transform
+        projectionScale: viewport height / (2 * tan(fov / 2)), projects a size at distance 1 into pixels
+    */
+    static uint32_t selectLOD(
+        const RenderData& renderData,
+        float worldScale,
+        float distance,
+        float projectionScale,
+        float maxPixelError = 1.0f);
+
     /*
         uint is GPU buffer index, TODO: wrap in type?
         Also store submesh count? so dont need to interate over all? (atm MAX is 6 so not that bad)
@@ -0,0 +1,408 @@
+#include "MeshOptimize.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t none = 0xFFFFFFFF;
+
+    /*
+        FIFO cache simulated with timestamps: a vertex is in the cache if less than cacheSize vertices
+        got inserted since it was inserted itself. Clearing the cache is just advancing the time
+    */
+    struct CacheSimulation
+    {
+        std::vector<uint32_t> insertTime;
+        uint32_t time;
+        uint32_t cacheSize;
+
+        CacheSimulation(size_t entries, uint32_t cacheSize)
+            : insertTime(entries, 0), time(cacheSize + 1), cacheSize(cacheSize)
+        {
+        }
+
+        [[nodiscard]] bool contains(uint32_t entry) const { return time - insertTime[entry] <= cacheSize; }
+
+        // returns true on a miss
+        bool access(uint32_t entry)
+        {
+            if(contains(entry))
+                return false;
+            insertTime[entry] = time++;
+            return true;
+        }
+
+        void clear() { time += cacheSize + 1; }
+    };
+
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    Float3 operator-(Float3 a, Float3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+    Float3 operator+(Float3 a, Float3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+    Float3 operator*(Float3 a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+    float dot(Float3 a, Float3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Float3 cross(Float3 a, Float3 b)
+    {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    Float3 loadPosition(const float* positions, size_t stride, uint32_t vertex)
+    {
+        Float3 result;
+        std::memcpy(&result, reinterpret_cast<const std::byte*>(positions) + vertex * stride, sizeof(Float3));
+        return result;
+    }
+} // namespace
+
+namespace MeshOptimize
+{
+    uint64_t Options::key() const
+    {
+        uint32_t thresholdBits;
+        std::memcpy(&thresholdBits, &overdrawThreshold, sizeof(float));
+        const uint64_t flags = uint64_t(vertexCache) | uint64_t(overdraw) << 1 | uint64_t(vertexFetch) << 2;
+        return flags | uint64_t(thresholdBits) << 32;
+    }
+
+    void optimizeVertexCache(
+        uint32_t* dst, const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+    {
+        assert(indexCount % 3 == 0);
+        const size_t triangleCount = indexCount / 3;
+        if(triangleCount == 0)
+            return;
+
+        // vertex -> triangle adjacency, and how many triangles of each vertex still need to be emitted
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for(size_t i = 0; i < indexCount; i++)
+        {
+            assert(indices[i] < vertexCount);
+            liveTriangles[indices[i]]++;
+        }
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for(size_t v = 0; v < vertexCount; v++)
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+        std::vector<uint32_t> adjacency(indexCount);
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for(size_t i = 0; i < indexCount; i++)
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        std::vector<uint32_t> result;
+        result.reserve(indexCount);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEndStack;
+        std::vector<uint32_t> candidates;
+        CacheSimulation cache{vertexCount, cacheSize};
+        size_t cursor = 0;
+
+        const auto skipDeadEnd = [&]() -> uint32_t
+        {
+            while(!deadEndStack.empty())
+            {
+                const uint32_t vertex = deadEndStack.back();
+                deadEndStack.pop_back();
+                if(liveTriangles[vertex] > 0)
+                    return vertex;
+            }
+            for(; cursor < vertexCount; cursor++)
+            {
+                if(liveTriangles[cursor] > 0)
+                    return static_cast<uint32_t>(cursor);
+            }
+            return none;
+        };
+
+        uint32_t fanning = skipDeadEnd();
+        while(fanning != none)
+        {
+            // emit all remaining triangles around the fanning vertex
+            candidates.clear();
+            for(uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++)
+            {
+                const uint32_t triangle = adjacency[a];
+                if(emitted[triangle])
+                    continue;
+                emitted[triangle] = true;
+                for(int k = 0; k < 3; k++)
+                {
+                    const uint32_t vertex = indices[triangle * 3 + k];
+                    result.push_back(vertex);
+                    deadEndStack.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+                    cache.access(vertex);
+                }
+            }
+
+            // next fanning vertex: the oldest one that will still be in the cache after emitting its triangles
+            uint32_t next = none;
+            uint32_t bestPriority = 0;
+            for(const uint32_t vertex : candidates)
+            {
+                if(liveTriangles[vertex] == 0)
+                    continue;
+                const uint32_t age = cache.time - cache.insertTime[vertex];
+                const uint32_t priority = age + 2 * liveTriangles[vertex] <= cacheSize ? age : 0;
+                if(priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = vertex;
+                }
+            }
+            fanning = next != none ? next : skipDeadEnd();
+        }
+        assert(result.size() == indexCount);
+        std::memcpy(dst, result.data(), indexCount * sizeof(uint32_t));
+    }
+
+    void optimizeOverdraw(
+        uint32_t* dst,
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        float threshold,
+        uint32_t cacheSize)
+    {
+        assert(dst != indices);
+        assert(indexCount % 3 == 0);
+        const size_t triangleCount = indexCount / 3;
+        if(triangleCount == 0)
+            return;
+
+        CacheSimulation cache{vertexCount, cacheSize};
+        const auto triangleMisses = [&](size_t triangle)
+        {
+            uint32_t misses = 0;
+            for(int k = 0; k < 3; k++)
+                misses += cache.access(indices[triangle * 3 + k]) ? 1 : 0;
+            return misses;
+        };
+
+        /*
+            Hard boundaries: triangles where the cache order starts over anyways (all vertices miss),
+            reordering the clusters between those doesnt cost any cache efficiency
+        */
+        std::vector<uint32_t> hardClusters;
+        for(size_t t = 0; t < triangleCount; t++)
+        {
+            if(triangleMisses(t) == 3)
+                hardClusters.push_back(static_cast<uint32_t>(t));
+        }
+        if(hardClusters.empty() || hardClusters[0] != 0)
+            hardClusters.insert(hardClusters.begin(), 0);
+        hardClusters.push_back(static_cast<uint32_t>(triangleCount));
+
+        /*
+            Soft boundaries: split the hard clusters further whenever the ACMR of the current piece (with a cold
+            cache) is within threshold of the ACMR of the whole cluster, since splitting there costs little
+        */
+        std::vector<uint32_t> clusters;
+        for(size_t c = 0; c + 1 < hardClusters.size(); c++)
+        {
+            const uint32_t begin = hardClusters[c];
+            const uint32_t end = hardClusters[c + 1];
+
+            cache.clear();
+            uint32_t clusterMisses = 0;
+            for(uint32_t t = begin; t < end; t++)
+                clusterMisses += triangleMisses(t);
+            const float clusterACMR = float(clusterMisses) / float(end - begin);
+
+            cache.clear();
+            clusters.push_back(begin);
+            uint32_t start = begin;
+            uint32_t misses = 0;
+            for(uint32_t t = begin; t < end; t++)
+            {
+                misses += triangleMisses(t);
+                if(t + 1 < end && float(misses) / float(t - start + 1) <= threshold * clusterACMR)
+                {
+                    start = t + 1;
+                    misses = 0;
+                    clusters.push_back(start);
+                    cache.clear();
+                }
+            }
+        }
+        clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+        // clusters facing away from the mesh center are likely to occlude others, so they get drawn first
+        std::vector<Float3> clusterCentroids(clusters.size() - 1, Float3{0, 0, 0});
+        std::vector<Float3> clusterNormals(clusters.size() - 1, Float3{0, 0, 0});
+        Float3 meshCentroid{0, 0, 0};
+        float meshArea = 0.0f;
+        for(size_t c = 0; c + 1 < clusters.size(); c++)
+        {
+            float clusterArea = 0.0f;
+            for(uint32_t t = clusters[c]; t < clusters[c + 1]; t++)
+            {
+                const Float3 p0 = loadPosition(positions, positionStride, indices[t * 3 + 0]);
+                const Float3 p1 = loadPosition(positions, positionStride, indices[t * 3 + 1]);
+                const Float3 p2 = loadPosition(positions, positionStride, indices[t * 3 + 2]);
+                const Float3 normal = cross(p1 - p0, p2 - p0);
+                const float area = std::sqrt(dot(normal, normal));
+                const Float3 centroid = (p0 + p1 + p2) * (1.0f / 3.0f);
+
+                clusterCentroids[c] = clusterCentroids[c] + centroid * area;
+                clusterNormals[c] = clusterNormals[c] + normal;
+                clusterArea += area;
+            }
+            meshCentroid = meshCentroid + clusterCentroids[c];
+            meshArea += clusterArea;
+            if(clusterArea > 0.0f)
+                clusterCentroids[c] = clusterCentroids[c] * (1.0f / clusterArea);
+        }
+        meshCentroid = meshArea > 0.0f ? meshCentroid * (1.0f / meshArea) : Float3{0, 0, 0};
+
+        std::vector<float> sortKeys(clusters.size() - 1);
+        std::vector<uint32_t> order(clusters.size() - 1);
+        for(size_t c = 0; c < order.size(); c++)
+        {
+            const float length = std::sqrt(dot(clusterNormals[c], clusterNormals[c]));
+            sortKeys[c] =
+                length > 0.0f ? dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]) / length : 0.0f;
+            order[c] = static_cast<uint32_t>(c);
+        }
+        std::stable_sort(
+            order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+        size_t written = 0;
+        for(const uint32_t c : order)
+        {
+            const size_t count = (clusters[c + 1] - clusters[c]) * 3;
+            std::memcpy(dst + written, indices + clusters[c] * 3, count * sizeof(uint32_t));
+            written += count;
+        }
+        assert(written == indexCount);
+    }
+
+    void generateVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+    {
+        std::fill(remap, remap + vertexCount, none);
+        uint32_t next = 0;
+        for(size_t i = 0; i < indexCount; i++)
+        {
+            assert(indices[i] < vertexCount);
+            if(remap[indices[i]] == none)
+                remap[indices[i]] = next++;
+        }
+        for(size_t v = 0; v < vertexCount; v++)
+        {
+            if(remap[v] == none)
+                remap[v] = next++;
+        }
+    }
+
+    void remapIndices(uint32_t* indices, size_t indexCount, const uint32_t* remap)
+    {
+        for(size_t i = 0; i < indexCount; i++)
+            indices[i] = remap[indices[i]];
+    }
+
+    void remapVertices(
+        std::byte* dst, const std::byte* src, size_t vertexSize, const uint32_t* remap, size_t vertexCount)
+    {
+        assert(dst != src);
+        for(size_t i = 0; i < vertexCount; i++)
+            std::memcpy(dst + size_t(remap[i]) * vertexSize, src + i * vertexSize, vertexSize);
+    }
+
+    void optimize(
+        const Options& options,
+        Span<uint32_t> indices,
+        Span<std::byte> positions,
+        Span<std::byte> attributes,
+        size_t attributeStride)
+    {
+        constexpr size_t positionSize = 3 * sizeof(float);
+        const size_t vertexCount = positions.size() / positionSize;
+        assert(attributes.size() == vertexCount * attributeStride);
+
+        if(options.vertexCache)
+            optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertexCount);
+        if(options.overdraw)
+        {
+            const std::vector<uint32_t> cacheOrder(indices.begin(), indices.end());
+            optimizeOverdraw(
+                indices.data(),
+                cacheOrder.data(),
+                cacheOrder.size(),
+                reinterpret_cast<const float*>(positions.data()),
+                positionSize,
+                vertexCount,
+                options.overdrawThreshold);
+        }
+        if(options.vertexFetch)
+        {
+            std::vector<uint32_t> remap(vertexCount);
+            generateVertexFetchRemap(remap.data(), indices.data(), indices.size(), vertexCount);
+            remapIndices(indices.data(), indices.size(), remap.data());
+
+            std::vector<std::byte> original(positions.begin(), positions.end());
+            remapVertices(positions.data(), original.data(), positionSize, remap.data(), vertexCount);
+            original.assign(attributes.begin(), attributes.end());
+            remapVertices(attributes.data(), original.data(), attributeStride, remap.data(), vertexCount);
+        }
+    }
+
+    VertexCacheStats
+    analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+    {
+        CacheSimulation cache{vertexCount, cacheSize};
+        std::vector<bool> used(vertexCount, false);
+        uint32_t usedCount = 0;
+        VertexCacheStats stats;
+        for(size_t i = 0; i < indexCount; i++)
+        {
+            stats.vertexShaderInvocations += cache.access(indices[i]) ? 1 : 0;
+            if(!used[indices[i]])
+            {
+                used[indices[i]] = true;
+                usedCount++;
+            }
+        }
+        stats.acmr = indexCount == 0 ? 0.0f : float(stats.vertexShaderInvocations) / float(indexCount / 3);
+        stats.atvr = usedCount == 0 ? 0.0f : float(stats.vertexShaderInvocations) / float(usedCount);
+        return stats;
+    }
+
+    VertexFetchStats
+    analyzeVertexFetch(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t vertexSize)
+    {
+        constexpr size_t lineSize = 64;
+        // 8kb, roughly an L1 worth of vertex data
+        constexpr uint32_t cachedLines = 128;
+
+        const size_t lineCount = (vertexCount * vertexSize + lineSize - 1) / lineSize;
+        CacheSimulation cache{lineCount, cachedLines};
+        std::vector<bool> used(vertexCount, false);
+        size_t usedCount = 0;
+        VertexFetchStats stats;
+        for(size_t i = 0; i < indexCount; i++)
+        {
+            const uint32_t vertex = indices[i];
+            if(!used[vertex])
+            {
+                used[vertex] = true;
+                usedCount++;
+            }
+            const size_t firstLine = vertex * vertexSize / lineSize;
+            const size_t lastLine = (vertex * vertexSize + vertexSize - 1) / lineSize;
+            for(size_t line = firstLine; line <= lastLine; line++)
+                stats.bytesFetched += cache.access(static_cast<uint32_t>(line)) ? lineSize : 0;
+        }
+        stats.overfetch = usedCount == 0 ? 0.0f : float(stats.bytesFetched) / float(usedCount * vertexSize);
+        return stats;
+    }
+} // namespace MeshOptimize
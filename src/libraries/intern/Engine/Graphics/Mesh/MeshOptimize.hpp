@@ -0,0 +1,106 @@
+#pragma once
+
+#include <Datastructures/Span.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Optional reordering passes run on imported meshes before they are uploaded:
+        vertex cache: triangle order with good post-transform cache reuse (Tipsify, Sander et al. 2007)
+        overdraw:     sorts clusters of the cache optimized order so outward facing parts get drawn first,
+                      trading a bit of cache efficiency for less overdraw
+        vertex fetch: renumbers vertices in order of first use, so the positionBuffer/attributeBuffer reads
+                      in the vertex shader are as sequential as possible
+    The analyze functions simulate the hardware caches on the CPU, so the result can be checked without a GPU
+    Indices are triangle lists, positions are float3
+*/
+namespace MeshOptimize
+{
+    // common size for the simulated post-transform vertex cache (FIFO)
+    constexpr uint32_t defaultCacheSize = 16;
+
+    struct Options
+    {
+        bool vertexCache = true;
+        bool overdraw = true;
+        bool vertexFetch = true;
+        // how much the ACMR of the vertex cache order may get worse in favor of less overdraw, 1.05 = 5%
+        float overdrawThreshold = 1.05f;
+
+        // identifies the settings, so cached import results can be invalidated when they change
+        [[nodiscard]] uint64_t key() const;
+    };
+
+    // ------------------- Passes -------------------
+
+    // dst and indices can be the same
+    void optimizeVertexCache(
+        uint32_t* dst,
+        const uint32_t* indices,
+        size_t indexCount,
+        size_t vertexCount,
+        uint32_t cacheSize = defaultCacheSize);
+
+    // expects the result of optimizeVertexCache as input, dst and indices can not be the same
+    void optimizeOverdraw(
+        uint32_t* dst,
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        float threshold,
+        uint32_t cacheSize = defaultCacheSize);
+
+    /*
+        Writes the new position of every vertex into remap, in order of first use in indices
+        Unused vertices get moved to the end, so remap is always a permutation
+    */
+    void generateVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+    // indices[i] = remap[indices[i]]
+    void remapIndices(uint32_t* indices, size_t indexCount, const uint32_t* remap);
+    // dst[remap[i]] = src[i], both tightly packed, dst and src can not be the same
+    void remapVertices(
+        std::byte* dst,
+        const std::byte* src,
+        size_t vertexSize,
+        const uint32_t* remap,
+        size_t vertexCount);
+
+    /*
+        Runs all passes enabled in options, reordering everything in place
+        positions: vertexCount float3, attributes: vertexCount elements of attributeStride bytes
+    */
+    void optimize(
+        const Options& options,
+        Span<uint32_t> indices,
+        Span<std::byte> positions,
+        Span<std::byte> attributes,
+        size_t attributeStride);
+
+    // ------------------- Analysis -------------------
+
+    struct VertexCacheStats
+    {
+        uint32_t vertexShaderInvocations = 0;
+        // average cache miss ratio: invocations per triangle, 0.5 at best for large regular meshes, 3 at worst
+        float acmr = 0.0f;
+        // average transform to vertex ratio: invocations per used vertex, 1 at best
+        float atvr = 0.0f;
+    };
+    VertexCacheStats analyzeVertexCache(
+        const uint32_t* indices,
+        size_t indexCount,
+        size_t vertexCount,
+        uint32_t cacheSize = defaultCacheSize);
+
+    struct VertexFetchStats
+    {
+        uint64_t bytesFetched = 0;
+        // bytes fetched from memory relative to the size of all used vertices, 1 at best
+        float overfetch = 0.0f;
+    };
+    // simulates a small cache of 64 byte lines in front of a single tightly packed vertex buffer
+    VertexFetchStats
+    analyzeVertexFetch(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t vertexSize);
+} // namespace MeshOptimize
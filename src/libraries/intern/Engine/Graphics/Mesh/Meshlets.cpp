@@ -0,0 +1,332 @@
+#include "Meshlets.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t none = 0xFFFFFFFF;
+    constexpr uint8_t notInMeshlet = 0xFF;
+
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    Float3 operator-(Float3 a, Float3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+    Float3 operator+(Float3 a, Float3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+    Float3 operator*(Float3 a, float s) { return {a.x * s, a.y * s, a.z * s}; }
+    float dot(Float3 a, Float3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    float length(Float3 a) { return std::sqrt(dot(a, a)); }
+    Float3 cross(Float3 a, Float3 b)
+    {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    float component(Float3 v, int axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); }
+
+    Float3 loadPosition(const float* positions, size_t stride, uint32_t vertex)
+    {
+        Float3 result;
+        std::memcpy(&result, reinterpret_cast<const std::byte*>(positions) + vertex * stride, sizeof(Float3));
+        return result;
+    }
+
+    void store(float dst[3], Float3 v)
+    {
+        dst[0] = v.x;
+        dst[1] = v.y;
+        dst[2] = v.z;
+    }
+
+    /*
+        Ritter style: start with the sphere spanning the most distant pair of axis extremes,
+        then grow it to include any point still outside
+    */
+    void boundingSphere(const std::vector<Float3>& points, Float3& center, float& radius)
+    {
+        assert(!points.empty());
+        size_t minIndex[3] = {0, 0, 0};
+        size_t maxIndex[3] = {0, 0, 0};
+        for(size_t i = 0; i < points.size(); i++)
+        {
+            for(int axis = 0; axis < 3; axis++)
+            {
+                if(component(points[i], axis) < component(points[minIndex[axis]], axis))
+                    minIndex[axis] = i;
+                if(component(points[i], axis) > component(points[maxIndex[axis]], axis))
+                    maxIndex[axis] = i;
+            }
+        }
+        int widest = 0;
+        float widestDistance = -1.0f;
+        for(int axis = 0; axis < 3; axis++)
+        {
+            const Float3 d = points[maxIndex[axis]] - points[minIndex[axis]];
+            if(dot(d, d) > widestDistance)
+            {
+                widestDistance = dot(d, d);
+                widest = axis;
+            }
+        }
+        center = (points[minIndex[widest]] + points[maxIndex[widest]]) * 0.5f;
+        radius = std::sqrt(widestDistance) * 0.5f;
+
+        for(const Float3& p : points)
+        {
+            const float distance = length(p - center);
+            if(distance > radius)
+            {
+                // move the center towards p so the new sphere touches p and the opposite side of the old one
+                const float newRadius = (radius + distance) * 0.5f;
+                center = center + (p - center) * ((newRadius - radius) / distance);
+                radius = newRadius;
+            }
+        }
+    }
+} // namespace
+
+namespace Meshlets
+{
+    uint32_t packTriangle(uint32_t a, uint32_t b, uint32_t c)
+    {
+        assert(a < 256 && b < 256 && c < 256);
+        return a | b << 8 | c << 16;
+    }
+
+    void unpackTriangle(uint32_t packed, uint32_t out[3])
+    {
+        out[0] = packed & 0xFF;
+        out[1] = (packed >> 8) & 0xFF;
+        out[2] = (packed >> 16) & 0xFF;
+    }
+
+    MeshletData build(
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        uint32_t maxVertices,
+        uint32_t maxTriangles)
+    {
+        assert(indexCount % 3 == 0);
+        assert(maxVertices >= 3 && maxVertices <= 256);
+        assert(maxTriangles >= 1);
+        const size_t triangleCount = indexCount / 3;
+        MeshletData result;
+        if(triangleCount == 0)
+            return result;
+
+        // vertex -> triangle adjacency
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for(size_t i = 0; i < indexCount; i++)
+        {
+            assert(indices[i] < vertexCount);
+            adjacencyOffsets[indices[i] + 1]++;
+        }
+        for(size_t v = 0; v < vertexCount; v++)
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        std::vector<uint32_t> adjacency(indexCount);
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for(size_t i = 0; i < indexCount; i++)
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        std::vector<Float3> centroids(triangleCount);
+        for(size_t t = 0; t < triangleCount; t++)
+        {
+            const Float3 sum = loadPosition(positions, positionStride, indices[t * 3]) +
+                               loadPosition(positions, positionStride, indices[t * 3 + 1]) +
+                               loadPosition(positions, positionStride, indices[t * 3 + 2]);
+            centroids[t] = sum * (1.0f / 3.0f);
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        // local index of each vertex in the current meshlet
+        std::vector<uint8_t> localIndex(vertexCount, notInMeshlet);
+        // triangles adjacent to the current meshlet that havent been emitted yet (may contain duplicates)
+        std::vector<uint32_t> candidates;
+        size_t cursor = 0;
+
+        Meshlet current{};
+        Float3 centroidSum{0.0f, 0.0f, 0.0f};
+        const auto newVertexCount = [&](uint32_t triangle)
+        {
+            uint32_t count = 0;
+            for(int k = 0; k < 3; k++)
+                count += localIndex[indices[triangle * 3 + k]] == notInMeshlet ? 1 : 0;
+            return count;
+        };
+        const auto addTriangle = [&](uint32_t triangle)
+        {
+            emitted[triangle] = true;
+            centroidSum = centroidSum + centroids[triangle];
+            uint32_t local[3];
+            for(int k = 0; k < 3; k++)
+            {
+                const uint32_t vertex = indices[triangle * 3 + k];
+                if(localIndex[vertex] == notInMeshlet)
+                {
+                    localIndex[vertex] = static_cast<uint8_t>(current.vertexCount++);
+                    result.vertices.push_back(vertex);
+                    for(uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++)
+                    {
+                        if(!emitted[adjacency[a]])
+                            candidates.push_back(adjacency[a]);
+                    }
+                }
+                local[k] = localIndex[vertex];
+            }
+            result.triangles.push_back(packTriangle(local[0], local[1], local[2]));
+            current.triangleCount++;
+        };
+        const auto finishMeshlet = [&]()
+        {
+            for(uint32_t i = 0; i < current.vertexCount; i++)
+                localIndex[result.vertices[current.vertexOffset + i]] = notInMeshlet;
+            current.bounds = computeBounds(result, current, positions, positionStride);
+            result.meshlets.push_back(current);
+            current = Meshlet{
+                .vertexOffset = static_cast<uint32_t>(result.vertices.size()),
+                .triangleOffset = static_cast<uint32_t>(result.triangles.size()),
+            };
+            centroidSum = {0.0f, 0.0f, 0.0f};
+            candidates.clear();
+        };
+
+        size_t emittedCount = 0;
+        while(emittedCount < triangleCount)
+        {
+            while(emitted[cursor])
+                cursor++;
+            addTriangle(static_cast<uint32_t>(cursor));
+            emittedCount++;
+
+            while(current.triangleCount < maxTriangles)
+            {
+                /*
+                    Adjacent triangle adding the fewest new vertices, ties go to the one closest to the meshlets
+                    center so meshlets grow round instead of in long strips
+                */
+                const Float3 center = centroidSum * (1.0f / float(current.triangleCount));
+                uint32_t best = none;
+                uint32_t bestNew = 4;
+                float bestDistance = 0.0f;
+                size_t write = 0;
+                for(const uint32_t triangle : candidates)
+                {
+                    if(emitted[triangle])
+                        continue;
+                    candidates[write++] = triangle;
+                    const uint32_t added = newVertexCount(triangle);
+                    if(current.vertexCount + added > maxVertices)
+                        continue;
+                    const Float3 offset = centroids[triangle] - center;
+                    const float distance = dot(offset, offset);
+                    if(added < bestNew || (added == bestNew && distance < bestDistance))
+                    {
+                        best = triangle;
+                        bestNew = added;
+                        bestDistance = distance;
+                    }
+                }
+                candidates.resize(write);
+                if(best == none)
+                    break;
+                addTriangle(best);
+                emittedCount++;
+            }
+            finishMeshlet();
+        }
+        return result;
+    }
+
+    Bounds computeBounds(
+        const MeshletData& data,
+        const Meshlet& meshlet,
+        const float* positions,
+        size_t positionStride)
+    {
+        Bounds bounds{};
+        if(meshlet.triangleCount == 0)
+            return bounds;
+
+        std::vector<Float3> points(meshlet.vertexCount);
+        for(uint32_t i = 0; i < meshlet.vertexCount; i++)
+            points[i] = loadPosition(positions, positionStride, data.vertices[meshlet.vertexOffset + i]);
+        Float3 center;
+        boundingSphere(points, center, bounds.radius);
+        store(bounds.center, center);
+
+        // triangle normals, degenerate triangles dont constrain the cone
+        std::vector<Float3> normals;
+        std::vector<Float3> corners;
+        normals.reserve(meshlet.triangleCount);
+        corners.reserve(meshlet.triangleCount);
+        Float3 axis{0.0f, 0.0f, 0.0f};
+        for(uint32_t t = 0; t < meshlet.triangleCount; t++)
+        {
+            uint32_t local[3];
+            unpackTriangle(data.triangles[meshlet.triangleOffset + t], local);
+            const Float3 p0 = points[local[0]];
+            const Float3 normal = cross(points[local[1]] - p0, points[local[2]] - p0);
+            const float area = length(normal);
+            if(area == 0.0f)
+                continue;
+            normals.push_back(normal * (1.0f / area));
+            corners.push_back(p0);
+            axis = axis + normals.back();
+        }
+
+        // cone that never culls
+        store(bounds.coneApex, center);
+        bounds.coneAxis[0] = 0.0f;
+        bounds.coneAxis[1] = 0.0f;
+        bounds.coneAxis[2] = 1.0f;
+        bounds.coneCutoff = 2.0f;
+
+        const float axisLength = length(axis);
+        if(normals.empty() || axisLength == 0.0f)
+            return bounds;
+        axis = axis * (1.0f / axisLength);
+
+        float minDot = 1.0f;
+        for(const Float3& normal : normals)
+            minDot = std::min(minDot, dot(normal, axis));
+        // cone wider than a hemisphere, some triangle is always frontfacing
+        if(minDot <= 0.0f)
+            return bounds;
+
+        /*
+            Move the apex back along the axis until it lies behind all triangle planes,
+            from there every view direction inside the cone sees all triangles from behind
+        */
+        float maxT = 0.0f;
+        for(size_t i = 0; i < normals.size(); i++)
+        {
+            const float distanceToPlane = dot(center - corners[i], normals[i]);
+            maxT = std::max(maxT, distanceToPlane / dot(axis, normals[i]));
+        }
+        store(bounds.coneApex, center - axis * maxT);
+        store(bounds.coneAxis, axis);
+        // sin of the angle between the cone and the plane perpendicular to the widest normal
+        bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        return bounds;
+    }
+
+    bool isBackfacing(const Bounds& bounds, const float cameraPosition[3])
+    {
+        const Float3 apex{bounds.coneApex[0], bounds.coneApex[1], bounds.coneApex[2]};
+        const Float3 camera{cameraPosition[0], cameraPosition[1], cameraPosition[2]};
+        const Float3 axis{bounds.coneAxis[0], bounds.coneAxis[1], bounds.coneAxis[2]};
+        const Float3 view = apex - camera;
+        const float distance = length(view);
+        if(distance == 0.0f)
+            return false;
+        return dot(view, axis) >= bounds.coneCutoff * distance;
+    }
+} // namespace Meshlets
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <Datastructures/Span.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+    Splits a triangle list into small clusters (meshlets) with a bounded amount of vertices and triangles,
+    sized for mesh shader workgroups and cluster culling
+    Each meshlet references its vertices through meshlet vertex indices, and its triangles are stored as
+    3 local 8 bit indices (into the meshlets vertices) packed into one uint32 (x | y << 8 | z << 16)
+    Positions are float3
+*/
+namespace Meshlets
+{
+    // the usual limits for mesh shader workgroups, 124 leaves room for per primitive data in 128 thread groups
+    constexpr uint32_t defaultMaxVertices = 64;
+    constexpr uint32_t defaultMaxTriangles = 124;
+
+    // Same layout as Meshlet in GPUScene/Structs.hlsl
+    struct Bounds
+    {
+        // bounding sphere
+        float center[3];
+        float radius;
+        /*
+            Normal cone: all triangles are backfacing when seen from a camera at position c if
+                dot(normalize(coneApex - c), coneAxis) >= coneCutoff
+            Cutoff is > 1 when the cone is too wide to ever cull anything
+        */
+        float coneApex[3];
+        float coneCutoff;
+        float coneAxis[3];
+    };
+
+    struct Meshlet
+    {
+        // into MeshletData::vertices
+        uint32_t vertexOffset;
+        // into MeshletData::triangles
+        uint32_t triangleOffset;
+        uint32_t vertexCount;
+        uint32_t triangleCount;
+        Bounds bounds;
+    };
+
+    // read only view, for passing around data that lives elsewhere (like in a cache file)
+    struct View
+    {
+        Span<const Meshlet> meshlets;
+        Span<const uint32_t> vertices;
+        Span<const uint32_t> triangles;
+    };
+
+    struct MeshletData
+    {
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> vertices;
+        std::vector<uint32_t> triangles;
+
+        [[nodiscard]] View view() const { return {meshlets, vertices, triangles}; }
+    };
+
+    /*
+        Greedily grows each meshlet with the adjacent triangle that adds the fewest new vertices, so
+        meshlets stay compact (better bounds and cones) independent of the input triangle order
+    */
+    MeshletData build(
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        uint32_t maxVertices = defaultMaxVertices,
+        uint32_t maxTriangles = defaultMaxTriangles);
+
+    Bounds computeBounds(
+        const MeshletData& data,
+        const Meshlet& meshlet,
+        const float* positions,
+        size_t positionStride);
+
+    // CPU version of the cone test, see Bounds
+    bool isBackfacing(const Bounds& bounds, const float cameraPosition[3]);
+
+    uint32_t packTriangle(uint32_t a, uint32_t b, uint32_t c);
+    void unpackTriangle(uint32_t packed, uint32_t out[3]);
+} // namespace Meshlets
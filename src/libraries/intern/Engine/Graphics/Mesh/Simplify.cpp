@@ -0,0 +1,502 @@
+#include "Simplify.hpp"
+#include "VertexWeld.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
+namespace
+{
+    constexpr uint32_t maxDimensions = 3 + Simplify::maxAttributes;
+
+    // Vertex in the space the quadrics live in: normalized position followed by the weighted attributes
+    using Point = std::array<float, maxDimensions>;
+
+    // Symmetric matrix A (upper triangle), vector b and scalar c, the error of v is v^T A v + 2 b^T v + c
+    struct Quadric
+    {
+        std::array<float, maxDimensions*(maxDimensions + 1) / 2> a{};
+        std::array<float, maxDimensions> b{};
+        float c = 0.0f;
+        // summed area (or border edge weight), the error is normalized by it
+        float weight = 0.0f;
+    };
+
+    constexpr uint32_t upperIndex(uint32_t row, uint32_t column)
+    {
+        // row <= column
+        return row * maxDimensions - row * (row - 1) / 2 + (column - row);
+    }
+
+    void add(Quadric& q, const Quadric& other)
+    {
+        for(size_t i = 0; i < q.a.size(); i++)
+            q.a[i] += other.a[i];
+        for(size_t i = 0; i < q.b.size(); i++)
+            q.b[i] += other.b[i];
+        q.c += other.c;
+        q.weight += other.weight;
+    }
+
+    float evaluate(const Quadric& q, const Point& v, uint32_t dimensions)
+    {
+        if(q.weight == 0.0f)
+            return 0.0f;
+        float result = q.c;
+        for(uint32_t i = 0; i < dimensions; i++)
+        {
+            result += q.a[upperIndex(i, i)] * v[i] * v[i] + 2.0f * q.b[i] * v[i];
+            for(uint32_t j = i + 1; j < dimensions; j++)
+                result += 2.0f * q.a[upperIndex(i, j)] * v[i] * v[j];
+        }
+        // can become slightly negative due to rounding
+        return std::max(result, 0.0f) / q.weight;
+    }
+
+    float dot(const Point& a, const Point& b, uint32_t dimensions)
+    {
+        float result = 0.0f;
+        for(uint32_t i = 0; i < dimensions; i++)
+            result += a[i] * b[i];
+        return result;
+    }
+
+    /*
+        Squared distance to the plane spanned by the triangle in the full dimensional space:
+            A = I - e1 e1^T - e2 e2^T
+            b = (p.e1) e1 + (p.e2) e2 - p
+            c = p.p - (p.e1)^2 - (p.e2)^2
+        with e1, e2 an orthonormal basis of the triangle and p one of its corners
+    */
+    void addTriangle(
+        Quadric& q, const Point& p0, const Point& p1, const Point& p2, uint32_t dimensions, float weight)
+    {
+        Point e1{};
+        Point e2{};
+        for(uint32_t i = 0; i < dimensions; i++)
+        {
+            e1[i] = p1[i] - p0[i];
+            e2[i] = p2[i] - p0[i];
+        }
+        const float length1 = std::sqrt(dot(e1, e1, dimensions));
+        if(length1 == 0.0f)
+            return;
+        for(uint32_t i = 0; i < dimensions; i++)
+            e1[i] /= length1;
+        const float projection = dot(e1, e2, dimensions);
+        for(uint32_t i = 0; i < dimensions; i++)
+            e2[i] -= projection * e1[i];
+        const float length2 = std::sqrt(dot(e2, e2, dimensions));
+        if(length2 == 0.0f)
+            return;
+        for(uint32_t i = 0; i < dimensions; i++)
+            e2[i] /= length2;
+
+        const float pe1 = dot(p0, e1, dimensions);
+        const float pe2 = dot(p0, e2, dimensions);
+        for(uint32_t i = 0; i < dimensions; i++)
+        {
+            for(uint32_t j = i; j < dimensions; j++)
+                q.a[upperIndex(i, j)] += weight * ((i == j ? 1.0f : 0.0f) - e1[i] * e1[j] - e2[i] * e2[j]);
+            q.b[i] += weight * (pe1 * e1[i] + pe2 * e2[i] - p0[i]);
+        }
+        q.c += weight * (dot(p0, p0, dimensions) - pe1 * pe1 - pe2 * pe2);
+        q.weight += weight;
+    }
+
+    // (n.x - d)^2 on the position part only
+    void addPlane(Quadric& q, const float n[3], float d, float weight)
+    {
+        for(uint32_t i = 0; i < 3; i++)
+        {
+            for(uint32_t j = i; j < 3; j++)
+                q.a[upperIndex(i, j)] += weight * n[i] * n[j];
+            q.b[i] -= weight * d * n[i];
+        }
+        q.c += weight * d * d;
+        q.weight += weight;
+    }
+
+    float dot3(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+    void cross(const float a[3], const float b[3], float out[3])
+    {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    // unnormalized normal of the triangle a, b, c (positions only)
+    void triangleNormal(const Point& a, const Point& b, const Point& c, float out[3])
+    {
+        const float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        const float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        cross(e1, e2, out);
+    }
+
+    uint64_t edgeKey(uint32_t from, uint32_t to) { return uint64_t(from) << 32 | to; }
+
+    enum struct VertexKind : uint8_t
+    {
+        Interior,
+        // on an open border, may only slide along it
+        Border,
+        // never collapsed: shares its position with another vertex, or locked border
+        Locked,
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        float cost;
+    };
+} // namespace
+
+namespace Simplify
+{
+    size_t simplify(
+        uint32_t* dst,
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        const Attributes& attributes,
+        const Options& options,
+        float* resultError)
+    {
+        assert(indexCount % 3 == 0);
+        assert(attributes.count <= maxAttributes);
+        if(dst != indices)
+            std::memcpy(dst, indices, indexCount * sizeof(uint32_t));
+        if(resultError != nullptr)
+            *resultError = 0.0f;
+        if(indexCount <= options.targetIndexCount || vertexCount == 0)
+            return indexCount;
+
+        const uint32_t dimensions = 3 + attributes.count;
+        const auto loadFloats = [](const float* base, size_t stride, size_t vertex, float* out, size_t count)
+        { std::memcpy(out, reinterpret_cast<const std::byte*>(base) + vertex * stride, count * sizeof(float)); };
+
+        // positions normalized to the unit cube, so the error limits dont depend on the mesh size
+        float minimum[3] = {INFINITY, INFINITY, INFINITY};
+        float maximum[3] = {-INFINITY, -INFINITY, -INFINITY};
+        for(size_t v = 0; v < vertexCount; v++)
+        {
+            float p[3];
+            loadFloats(positions, positionStride, v, p, 3);
+            for(int i = 0; i < 3; i++)
+            {
+                minimum[i] = std::min(minimum[i], p[i]);
+                maximum[i] = std::max(maximum[i], p[i]);
+            }
+        }
+        const float extent =
+            std::max({maximum[0] - minimum[0], maximum[1] - minimum[1], maximum[2] - minimum[2], 1e-20f});
+        std::vector<Point> points(vertexCount);
+        for(size_t v = 0; v < vertexCount; v++)
+        {
+            float p[3];
+            loadFloats(positions, positionStride, v, p, 3);
+            Point& point = points[v];
+            for(int i = 0; i < 3; i++)
+                point[i] = (p[i] - minimum[i]) / extent;
+            for(uint32_t a = 0; a < attributes.count; a++)
+            {
+                float value;
+                loadFloats(attributes.data + attributes.components[a], attributes.stride, v, &value, 1);
+                point[3 + a] = value * attributes.weights[a];
+            }
+        }
+
+        // vertices with bit identical positions, to find seams and borders independent of attribute splits
+        std::vector<uint32_t> positionIds(vertexCount);
+        {
+            const VertexWeld::Stream stream{
+                .data = reinterpret_cast<const std::byte*>(positions),
+                .size = sizeof(float) * 3,
+                .stride = positionStride,
+            };
+            VertexWeld::generateRemap(positionIds.data(), {&stream, 1}, vertexCount);
+        }
+
+        size_t currentCount = indexCount;
+        const auto isBorderEdge = [](const std::unordered_set<uint64_t>& edges, uint32_t a, uint32_t b)
+        { return edges.contains(edgeKey(a, b)) != edges.contains(edgeKey(b, a)); };
+
+        // directed edges between position ids of the current triangles
+        std::unordered_set<uint64_t> edges;
+        const auto collectEdges = [&]()
+        {
+            edges.clear();
+            edges.reserve(currentCount);
+            for(size_t i = 0; i < currentCount; i += 3)
+            {
+                for(int k = 0; k < 3; k++)
+                    edges.insert(edgeKey(positionIds[dst[i + k]], positionIds[dst[i + (k + 1) % 3]]));
+            }
+        };
+
+        std::vector<Quadric> quadrics(vertexCount);
+        collectEdges();
+        for(size_t i = 0; i < indexCount; i += 3)
+        {
+            const Point& p0 = points[dst[i]];
+            const Point& p1 = points[dst[i + 1]];
+            const Point& p2 = points[dst[i + 2]];
+            float normal[3];
+            triangleNormal(p0, p1, p2, normal);
+            const float area = std::sqrt(dot3(normal, normal));
+            Quadric q;
+            addTriangle(q, p0, p1, p2, dimensions, area * 0.5f);
+            for(int k = 0; k < 3; k++)
+                add(quadrics[dst[i + k]], q);
+
+            if(options.lockBorder || area == 0.0f)
+                continue;
+            // border edges get a plane perpendicular to the triangle, so borders keep their shape
+            for(int k = 0; k < 3; k++)
+            {
+                const uint32_t a = dst[i + k];
+                const uint32_t b = dst[i + (k + 1) % 3];
+                if(!isBorderEdge(edges, positionIds[a], positionIds[b]))
+                    continue;
+                const float* pa = points[a].data();
+                const float* pb = points[b].data();
+                const float edge[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+                float planeNormal[3];
+                cross(edge, normal, planeNormal);
+                const float length = std::sqrt(dot3(planeNormal, planeNormal));
+                if(length == 0.0f)
+                    continue;
+                for(float& n : planeNormal)
+                    n /= length;
+                Quadric border;
+                addPlane(border, planeNormal, dot3(planeNormal, pa), dot3(edge, edge) * 10.0f);
+                add(quadrics[a], border);
+                add(quadrics[b], border);
+            }
+        }
+
+        const float maxCost = options.targetError * options.targetError;
+        float largestCost = 0.0f;
+
+        std::vector<VertexKind> kinds(vertexCount);
+        std::vector<uint32_t> verticesPerPosition(vertexCount);
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+        std::vector<uint32_t> adjacency;
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<bool> locked(vertexCount);
+
+        while(currentCount > options.targetIndexCount)
+        {
+            const size_t triangleCount = currentCount / 3;
+
+            // classify the vertices still in use
+            if(currentCount != indexCount)
+                collectEdges();
+            std::fill(verticesPerPosition.begin(), verticesPerPosition.end(), 0);
+            std::fill(locked.begin(), locked.end(), false);
+            for(size_t i = 0; i < currentCount; i++)
+            {
+                // locked is used as "seen" here
+                if(!locked[dst[i]])
+                    verticesPerPosition[positionIds[dst[i]]]++;
+                locked[dst[i]] = true;
+            }
+            std::fill(kinds.begin(), kinds.end(), VertexKind::Interior);
+            for(size_t i = 0; i < currentCount; i += 3)
+            {
+                for(int k = 0; k < 3; k++)
+                {
+                    const uint32_t a = dst[i + k];
+                    const uint32_t b = dst[i + (k + 1) % 3];
+                    if(isBorderEdge(edges, positionIds[a], positionIds[b]))
+                    {
+                        kinds[a] = options.lockBorder ? VertexKind::Locked : VertexKind::Border;
+                        kinds[b] = options.lockBorder ? VertexKind::Locked : VertexKind::Border;
+                    }
+                }
+            }
+            for(size_t v = 0; v < vertexCount; v++)
+            {
+                if(verticesPerPosition[positionIds[v]] > 1)
+                    kinds[v] = VertexKind::Locked;
+            }
+
+            // vertex -> triangle adjacency
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+            for(size_t i = 0; i < currentCount; i++)
+                adjacencyOffsets[dst[i] + 1]++;
+            for(size_t v = 0; v < vertexCount; v++)
+                adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+            adjacency.resize(currentCount);
+            {
+                std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for(size_t i = 0; i < currentCount; i++)
+                    adjacency[fill[dst[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+
+            collapses.clear();
+            for(size_t i = 0; i < currentCount; i += 3)
+            {
+                for(int k = 0; k < 3; k++)
+                {
+                    const uint32_t a = dst[i + k];
+                    const uint32_t b = dst[i + (k + 1) % 3];
+                    for(const auto& [from, to] : {std::pair{a, b}, std::pair{b, a}})
+                    {
+                        if(kinds[from] == VertexKind::Locked)
+                            continue;
+                        if(kinds[from] == VertexKind::Border &&
+                           (kinds[to] == VertexKind::Interior ||
+                            !isBorderEdge(edges, positionIds[from], positionIds[to])))
+                            continue;
+                        const float cost = evaluate(quadrics[from], points[to], dimensions);
+                        if(cost <= maxCost)
+                            collapses.push_back({from, to, cost});
+                    }
+                }
+            }
+            if(collapses.empty())
+                break;
+            std::sort(
+                collapses.begin(),
+                collapses.end(),
+                [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+            // each collapse changes the triangles around "from", so those vertices are left alone for this pass
+            std::fill(locked.begin(), locked.end(), false);
+            for(size_t v = 0; v < vertexCount; v++)
+                remap[v] = static_cast<uint32_t>(v);
+            const size_t targetTriangles = options.targetIndexCount / 3;
+            size_t removedTriangles = 0;
+            for(const Collapse& collapse : collapses)
+            {
+                if(triangleCount - removedTriangles <= targetTriangles)
+                    break;
+                if(locked[collapse.from] || locked[collapse.to])
+                    continue;
+
+                // reject collapses that flip a triangle
+                uint32_t removes = 0;
+                bool flips = false;
+                for(uint32_t t = adjacencyOffsets[collapse.from]; t < adjacencyOffsets[collapse.from + 1]; t++)
+                {
+                    const uint32_t* triangle = &dst[adjacency[t] * 3];
+                    if(triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                    {
+                        removes++;
+                        continue;
+                    }
+                    float before[3];
+                    float after[3];
+                    const auto corner = [&](int k, bool moved) -> const Point&
+                    { return moved && triangle[k] == collapse.from ? points[collapse.to] : points[triangle[k]]; };
+                    triangleNormal(corner(0, false), corner(1, false), corner(2, false), before);
+                    triangleNormal(corner(0, true), corner(1, true), corner(2, true), after);
+                    if(dot3(before, after) <= 0.0f)
+                    {
+                        flips = true;
+                        break;
+                    }
+                }
+                if(flips)
+                    continue;
+
+                remap[collapse.from] = collapse.to;
+                add(quadrics[collapse.to], quadrics[collapse.from]);
+                largestCost = std::max(largestCost, collapse.cost);
+                removedTriangles += removes;
+                locked[collapse.to] = true;
+                for(uint32_t t = adjacencyOffsets[collapse.from]; t < adjacencyOffsets[collapse.from + 1]; t++)
+                {
+                    for(int k = 0; k < 3; k++)
+                        locked[dst[adjacency[t] * 3 + k]] = true;
+                }
+            }
+            if(removedTriangles == 0)
+                break;
+
+            // apply and drop the triangles that became degenerate
+            size_t write = 0;
+            for(size_t i = 0; i < currentCount; i += 3)
+            {
+                const uint32_t a = remap[dst[i]];
+                const uint32_t b = remap[dst[i + 1]];
+                const uint32_t c = remap[dst[i + 2]];
+                if(a == b || b == c || a == c)
+                    continue;
+                dst[write++] = a;
+                dst[write++] = b;
+                dst[write++] = c;
+            }
+            currentCount = write;
+        }
+
+        if(resultError != nullptr)
+            *resultError = std::sqrt(largestCost) * extent;
+        return currentCount;
+    }
+
+    uint64_t LODOptions::key() const
+    {
+        uint32_t reductionBits;
+        uint32_t errorBits;
+        std::memcpy(&reductionBits, &reduction, sizeof(float));
+        std::memcpy(&errorBits, &maxError, sizeof(float));
+        uint64_t key = maxLODs | uint64_t(lockBorder) << 8;
+        key = key * 0x9E3779B97F4A7C15ull ^ reductionBits;
+        key = key * 0x9E3779B97F4A7C15ull ^ errorBits;
+        return key;
+    }
+
+    std::vector<LOD> generateLODs(
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        const Attributes& attributes,
+        const LODOptions& options)
+    {
+        std::vector<LOD> lods;
+        size_t previousCount = indexCount;
+        for(uint32_t level = 1; level < options.maxLODs; level++)
+        {
+            const size_t targetCount = static_cast<size_t>(float(previousCount / 3) * options.reduction) * 3;
+            const Options simplifyOptions{
+                .targetIndexCount = targetCount,
+                .targetError = options.maxError,
+                .lockBorder = options.lockBorder,
+            };
+            LOD lod;
+            lod.indices.resize(indexCount);
+            const size_t count = simplify(
+                lod.indices.data(),
+                indices,
+                indexCount,
+                positions,
+                positionStride,
+                vertexCount,
+                attributes,
+                simplifyOptions,
+                &lod.error);
+            // not worth an extra LOD if the error limit (or locked vertices) stopped it early
+            if(count == 0 || float(count) > float(previousCount) * 0.9f)
+                break;
+            lod.indices.resize(count);
+            // each LOD contains the previous ones collapses (almost), keep the errors monotonic for the selection
+            if(!lods.empty())
+                lod.error = std::max(lod.error, lods.back().error);
+            previousCount = count;
+            lods.push_back(std::move(lod));
+        }
+        return lods;
+    }
+} // namespace Simplify
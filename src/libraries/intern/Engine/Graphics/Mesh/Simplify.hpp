@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+    Quadric error metric mesh simplification (Garland & Heckbert), used to generate LODs at import time
+    Only collapses edges into one of their existing vertices, so the result is a new index list for the
+    unchanged vertex buffer and all LODs of a mesh can share the vertex data
+    Attributes take part in the error through the generalized quadrics of "Simplifying Surfaces with Color and
+    Texture using Quadric Error Metrics", so uv/normal discontinuities are kept where possible
+    Vertices sharing their position with other vertices (uv/normal seams) are never moved, neither are vertices on
+    open borders if lockBorder is set, so LODs dont open cracks
+    Positions are float3
+*/
+namespace Simplify
+{
+    constexpr uint32_t maxAttributes = 5;
+
+    struct Attributes
+    {
+        // first float of vertex 0
+        const float* data = nullptr;
+        // in bytes
+        size_t stride = 0;
+        // which floats, relative to data, are part of the error and how much they matter compared to positions
+        // (positions are normalized to the mesh extent, so a weight of 1 puts a uv offset of 1 on par with it)
+        uint32_t count = 0;
+        uint32_t components[maxAttributes] = {};
+        float weights[maxAttributes] = {};
+    };
+
+    struct Options
+    {
+        // stops once the index count is at or below this
+        size_t targetIndexCount = 0;
+        // relative to the mesh extent, collapses with a larger error are never done
+        float targetError = 0.01f;
+        bool lockBorder = true;
+    };
+
+    /*
+        dst needs room for indexCount indices and can be the same as indices
+        Returns the new index count, resultError is the largest error of all collapses in the units of the positions
+    */
+    size_t simplify(
+        uint32_t* dst,
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        const Attributes& attributes,
+        const Options& options,
+        float* resultError = nullptr);
+
+    struct LODOptions
+    {
+        // including the full resolution mesh, 1 disables LOD generation
+        uint32_t maxLODs = 4;
+        // each LOD targets this fraction of the previous ones triangles
+        float reduction = 0.5f;
+        // relative to the mesh extent, LOD generation stops when the target count cant be reached within it
+        float maxError = 0.05f;
+        bool lockBorder = true;
+
+        [[nodiscard]] uint64_t key() const;
+    };
+
+    struct LOD
+    {
+        std::vector<uint32_t> indices;
+        // see simplify()
+        float error = 0.0f;
+    };
+
+    /*
+        Returns LOD 1 and up, with decreasing triangle and increasing error, LOD 0 is the input itself
+        Every LOD is simplified from the input so its error is relative to the full resolution mesh
+    */
+    std::vector<LOD> generateLODs(
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        const Attributes& attributes,
+        const LODOptions& options);
+} // namespace Simplify
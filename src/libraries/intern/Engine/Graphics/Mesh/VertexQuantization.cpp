@@ -0,0 +1,128 @@
+#include "VertexQuantization.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    float signNotZero(float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+
+    int16_t encodeSNorm16(float value)
+    {
+        return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+} // namespace
+
+namespace VertexQuantization
+{
+    uint32_t encodeOctahedral16(float x, float y, float z)
+    {
+        const float l1 = std::abs(x) + std::abs(y) + std::abs(z);
+        if(l1 == 0.0f)
+            return 0;
+        float px = x / l1;
+        float py = y / l1;
+        // lower hemisphere gets folded over the diagonals
+        if(z < 0.0f)
+        {
+            const float fx = (1.0f - std::abs(py)) * signNotZero(px);
+            const float fy = (1.0f - std::abs(px)) * signNotZero(py);
+            px = fx;
+            py = fy;
+        }
+        return uint32_t(uint16_t(encodeSNorm16(px))) | uint32_t(uint16_t(encodeSNorm16(py))) << 16;
+    }
+
+    void decodeOctahedral16(uint32_t encoded, float out[3])
+    {
+        float px = std::max(float(int16_t(encoded & 0xFFFF)) / 32767.0f, -1.0f);
+        float py = std::max(float(int16_t(encoded >> 16)) / 32767.0f, -1.0f);
+        const float z = 1.0f - std::abs(px) - std::abs(py);
+        if(z < 0.0f)
+        {
+            const float fx = (1.0f - std::abs(py)) * signNotZero(px);
+            const float fy = (1.0f - std::abs(px)) * signNotZero(py);
+            px = fx;
+            py = fy;
+        }
+        const float length = std::sqrt(px * px + py * py + z * z);
+        out[0] = px / length;
+        out[1] = py / length;
+        out[2] = z / length;
+    }
+
+    uint16_t floatToHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(float));
+        const uint32_t sign = (bits >> 16) & 0x8000;
+        const uint32_t exponent = (bits >> 23) & 0xFF;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        // NaN and infinity
+        if(exponent == 0xFF)
+            return uint16_t(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+
+        const int32_t halfExponent = int32_t(exponent) - 127 + 15;
+        if(halfExponent >= 0x1F)
+            return uint16_t(sign | 0x7C00);
+        if(halfExponent <= 0)
+        {
+            // denormal or zero, 24 bits of mantissa (with implicit 1) shifted into 10
+            if(halfExponent < -10)
+                return uint16_t(sign);
+            mantissa |= 0x800000;
+            const uint32_t shift = uint32_t(14 - halfExponent);
+            uint32_t half = mantissa >> shift;
+            const uint32_t remainder = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway = 1u << (shift - 1);
+            if(remainder > halfway || (remainder == halfway && (half & 1)))
+                half++;
+            return uint16_t(sign | half);
+        }
+
+        uint32_t half = uint32_t(halfExponent) << 10 | mantissa >> 13;
+        const uint32_t remainder = mantissa & 0x1FFF;
+        // a carry out of the mantissa correctly bumps the exponent, up to infinity
+        if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+            half++;
+        return uint16_t(sign | half);
+    }
+
+    float halfToFloat(uint16_t value)
+    {
+        const uint32_t sign = uint32_t(value & 0x8000) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1F;
+        const uint32_t mantissa = value & 0x3FF;
+        if(exponent == 0)
+        {
+            const float magnitude = std::ldexp(float(mantissa), -24);
+            return sign != 0 ? -magnitude : magnitude;
+        }
+        uint32_t bits;
+        if(exponent == 0x1F)
+            bits = sign | 0x7F800000 | mantissa << 13;
+        else
+            bits = sign | (exponent - 15 + 127) << 23 | mantissa << 13;
+        float result;
+        std::memcpy(&result, &bits, sizeof(float));
+        return result;
+    }
+
+    uint16_t encodeUNorm16(float value)
+    {
+        return static_cast<uint16_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    uint8_t encodeUNorm8(float value)
+    {
+        return static_cast<uint8_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
+
+    uint32_t encodeRGBA8(float r, float g, float b, float a)
+    {
+        return uint32_t(encodeUNorm8(r)) | uint32_t(encodeUNorm8(g)) << 8 | uint32_t(encodeUNorm8(b)) << 16 |
+               uint32_t(encodeUNorm8(a)) << 24;
+    }
+} // namespace VertexQuantization
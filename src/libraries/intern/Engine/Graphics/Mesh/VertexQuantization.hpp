@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+    Scalar encode/decode functions for the compact vertex encodings in Mesh::VertexEncoding
+    The decode functions mirror the ones in MeshData (GPUScene/Structs.hlsl) and exist for testing
+*/
+namespace VertexQuantization
+{
+    // unit vector -> octahedral mapping, stored as 2x snorm16 (x in the low bits)
+    uint32_t encodeOctahedral16(float x, float y, float z);
+    void decodeOctahedral16(uint32_t encoded, float out[3]);
+
+    // IEEE 754 binary16, round to nearest even
+    uint16_t floatToHalf(float value);
+    float halfToFloat(uint16_t value);
+
+    // value in [0,1], clamped
+    uint16_t encodeUNorm16(float value);
+    uint8_t encodeUNorm8(float value);
+    // r in the low bits
+    uint32_t encodeRGBA8(float r, float g, float b, float a);
+} // namespace VertexQuantization
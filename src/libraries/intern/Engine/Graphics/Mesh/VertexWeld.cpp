@@ -0,0 +1,117 @@
+#include "VertexWeld.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t emptySlot = 0xFFFFFFFF;
+
+    size_t effectiveStride(const VertexWeld::Stream& stream)
+    {
+        return stream.stride != 0 ? stream.stride : stream.size;
+    }
+
+    // murmur2 style mixing, 4 bytes at a time
+    uint32_t hashVertex(Span<const VertexWeld::Stream> streams, size_t vertex)
+    {
+        constexpr uint32_t m = 0x5BD1E995;
+        uint32_t hash = 0;
+        for(const VertexWeld::Stream& stream : streams)
+        {
+            const std::byte* data = stream.data + vertex * effectiveStride(stream);
+            size_t i = 0;
+            for(; i + 4 <= stream.size; i += 4)
+            {
+                uint32_t k;
+                std::memcpy(&k, data + i, 4);
+                k *= m;
+                k ^= k >> 24;
+                k *= m;
+                hash = (hash * m) ^ k;
+            }
+            for(; i < stream.size; i++)
+                hash = (hash ^ static_cast<uint32_t>(data[i])) * m;
+        }
+        hash ^= hash >> 13;
+        hash *= m;
+        hash ^= hash >> 15;
+        return hash;
+    }
+
+    bool equalVertices(Span<const VertexWeld::Stream> streams, size_t a, size_t b)
+    {
+        for(const VertexWeld::Stream& stream : streams)
+        {
+            const size_t stride = effectiveStride(stream);
+            if(std::memcmp(stream.data + a * stride, stream.data + b * stride, stream.size) != 0)
+                return false;
+        }
+        return true;
+    }
+} // namespace
+
+namespace VertexWeld
+{
+    uint32_t generateRemap(uint32_t* remap, Span<const Stream> streams, size_t vertexCount)
+    {
+        assert(vertexCount < emptySlot);
+        assert(!streams.empty());
+
+        // open addressing with linear probing, kept below 80% load
+        size_t tableSize = 1;
+        while(tableSize < vertexCount + vertexCount / 4)
+            tableSize *= 2;
+        const size_t mask = tableSize - 1;
+        // stores the original index of the first vertex with that content
+        std::vector<uint32_t> table(tableSize, emptySlot);
+
+        uint32_t uniqueCount = 0;
+        for(size_t i = 0; i < vertexCount; i++)
+        {
+            size_t slot = hashVertex(streams, i) & mask;
+            while(true)
+            {
+                const uint32_t existing = table[slot];
+                if(existing == emptySlot)
+                {
+                    table[slot] = static_cast<uint32_t>(i);
+                    remap[i] = uniqueCount++;
+                    break;
+                }
+                if(equalVertices(streams, existing, i))
+                {
+                    remap[i] = remap[existing];
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+        return uniqueCount;
+    }
+
+    void remapVertices(
+        std::byte* dst,
+        const std::byte* src,
+        size_t vertexSize,
+        size_t srcStride,
+        const uint32_t* remap,
+        size_t vertexCount)
+    {
+        if(srcStride == 0)
+            srcStride = vertexSize;
+        // indices are assigned in order of first appearance, so only the first copy of each vertex is written
+        uint32_t next = 0;
+        for(size_t i = 0; i < vertexCount; i++)
+        {
+            if(remap[i] != next)
+            {
+                assert(remap[i] < next);
+                continue;
+            }
+            std::memcpy(dst + size_t(next) * vertexSize, src + i * srcStride, vertexSize);
+            next++;
+        }
+    }
+} // namespace VertexWeld
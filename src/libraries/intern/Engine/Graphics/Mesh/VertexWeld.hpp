@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Datastructures/Span.hpp>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Hash based vertex welding: finds vertices that are bit identical across all given attribute streams,
+    so a mesh with one vertex per triangle corner can be turned into a properly indexed one
+    Works on raw bytes, so streams can also be something like OBJ index triplets, which is cheaper than
+    comparing the final attributes and just as exact
+*/
+namespace VertexWeld
+{
+    // One attribute of every vertex, vertex i starts at data + i * stride
+    struct Stream
+    {
+        const std::byte* data = nullptr;
+        size_t size = 0;
+        // 0 means tightly packed
+        size_t stride = 0;
+    };
+
+    /*
+        Writes the new index of every vertex to remap[i] and returns the amount of unique vertices
+        New indices are assigned in order of first appearance, so remap[i] <= i, and remap can directly be used
+        as index buffer for the welded vertices
+    */
+    uint32_t generateRemap(uint32_t* remap, Span<const Stream> streams, size_t vertexCount);
+
+    /*
+        dst[remap[i]] = src[i], with remap as produced by generateRemap
+        dst needs space for the unique vertex count it returned
+    */
+    void remapVertices(
+        std::byte* dst,
+        const std::byte* src,
+        size_t vertexSize,
+        size_t srcStride,
+        const uint32_t* remap,
+        size_t vertexCount);
+} // namespace VertexWeld
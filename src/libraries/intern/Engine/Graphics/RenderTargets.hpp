@@ -33,4 +33,21 @@ struct DepthTarget : public RenderTarget
     Texture::Handle texture;
     LoadOp loadOp = LoadOp::Load;
     StoreOp storeOp = StoreOp::Store;
-};
\ No newline at end of file
+};
+
+/*
+    One render pass can be split over several command buffers (to record them in parallel) by suspending it at the
+    end of a command buffer and resuming it in the next one
+    Every part has to begin rendering with the same targets, and they have to be submitted in order in the same
+    submitCommandBuffers() call without any other command buffers in between
+*/
+enum struct RenderingSplit
+{
+    None,
+    // first part
+    Suspend,
+    // parts in between
+    ResumeAndSuspend,
+    // last part
+    Resume,
+};
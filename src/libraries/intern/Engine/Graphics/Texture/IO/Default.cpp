@@ -8,7 +8,16 @@ Texture::LoadResult Texture::loadDefault(const Texture::LoadInfo& loadInfo)
     int texWidth = 0;
     int texHeight = 0;
     int texChannels = 0;
-    stbi_uc* pixels = stbi_load(loadInfo.path.data(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    stbi_uc* pixels =
+        loadInfo.fileData.empty()
+            ? stbi_load(loadInfo.path.data(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha)
+            : stbi_load_from_memory(
+                  reinterpret_cast<const stbi_uc*>(loadInfo.fileData.data()),
+                  static_cast<int>(loadInfo.fileData.size()),
+                  &texWidth,
+                  &texHeight,
+                  &texChannels,
+                  STBI_rgb_alpha);
     if(pixels == nullptr)
     {
         std::cout << "Failed to load texture file: " << loadInfo.path << std::endl;
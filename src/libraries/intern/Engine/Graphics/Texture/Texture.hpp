@@ -53,6 +53,8 @@ struct Texture
     struct LoadInfo
     {
         std::string path;
+        // encoded file contents (png, jpg, ...), if set the image is decoded from here instead of reading path
+        Span<const std::byte> fileData;
         std::string_view debugName;
         bool fileDataIsLinear = false;
         int32_t mipLevels = 1;
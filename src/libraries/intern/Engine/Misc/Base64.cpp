@@ -0,0 +1,90 @@
+#include "Base64.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace
+{
+    constexpr uint32_t invalid = 0xFF;
+
+    constexpr std::array<uint8_t, 256> decodeTable = []()
+    {
+        std::array<uint8_t, 256> table{};
+        for(auto& entry : table)
+            entry = invalid;
+        constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for(size_t i = 0; i < alphabet.size(); i++)
+            table[static_cast<uint8_t>(alphabet[i])] = static_cast<uint8_t>(i);
+        return table;
+    }();
+
+    // combines 4 characters into 24 bits, bit 31 ends up set if any of them was invalid
+    inline uint32_t decodeQuad(const char* src)
+    {
+        const uint32_t a = decodeTable[static_cast<uint8_t>(src[0])];
+        const uint32_t b = decodeTable[static_cast<uint8_t>(src[1])];
+        const uint32_t c = decodeTable[static_cast<uint8_t>(src[2])];
+        const uint32_t d = decodeTable[static_cast<uint8_t>(src[3])];
+        return (a << 18) | (b << 12) | (c << 6) | d | ((a | b | c | d) & 0x80u) << 24;
+    }
+} // namespace
+
+namespace Base64
+{
+    size_t decodedSize(std::string_view encoded)
+    {
+        if(encoded.size() < 4)
+            return 0;
+        size_t padding = 0;
+        if(encoded.back() == '=')
+            padding++;
+        if(encoded[encoded.size() - 2] == '=')
+            padding++;
+        return encoded.size() / 4 * 3 - padding;
+    }
+
+    bool decode(std::string_view encoded, std::byte* dst)
+    {
+        if(encoded.size() % 4 != 0)
+            return false;
+        if(encoded.empty())
+            return true;
+
+        // all full quads, without branching on the padding
+        const size_t fullQuads = encoded.size() / 4 - 1;
+        const char* src = encoded.data();
+        uint32_t invalidBits = 0;
+        for(size_t i = 0; i < fullQuads; i++)
+        {
+            const uint32_t bits = decodeQuad(src + i * 4);
+            invalidBits |= bits;
+            dst[i * 3 + 0] = static_cast<std::byte>(bits >> 16);
+            dst[i * 3 + 1] = static_cast<std::byte>(bits >> 8);
+            dst[i * 3 + 2] = static_cast<std::byte>(bits);
+        }
+        if(invalidBits & 0x80000000u)
+            return false;
+
+        // last quad can contain padding
+        const char* last = src + fullQuads * 4;
+        std::byte* lastDst = dst + fullQuads * 3;
+        const char padded[4] = {last[0], last[1], last[2] == '=' ? 'A' : last[2], last[3] == '=' ? 'A' : last[3]};
+        if(last[2] == '=' && last[3] != '=')
+            return false;
+        const uint32_t bits = decodeQuad(padded);
+        if(bits & 0x80000000u)
+            return false;
+        lastDst[0] = static_cast<std::byte>(bits >> 16);
+        if(last[2] != '=')
+            lastDst[1] = static_cast<std::byte>(bits >> 8);
+        if(last[3] != '=')
+            lastDst[2] = static_cast<std::byte>(bits);
+        return true;
+    }
+
+    bool decode(std::string_view encoded, std::vector<std::byte>& out)
+    {
+        out.resize(decodedSize(encoded));
+        return decode(encoded, out.data());
+    }
+} // namespace Base64
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace Base64
+{
+    // Size of the decoded data, assumes valid input (length multiple of 4, padding with '=')
+    size_t decodedSize(std::string_view encoded);
+
+    /*
+        Decodes into dst, which needs to hold decodedSize(encoded) bytes
+        Returns false if encoded contains invalid characters or has an invalid length
+    */
+    bool decode(std::string_view encoded, std::byte* dst);
+    bool decode(std::string_view encoded, std::vector<std::byte>& out);
+} // namespace Base64
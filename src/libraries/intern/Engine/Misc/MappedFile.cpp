@@ -0,0 +1,130 @@
+#include "MappedFile.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        return;
+    }
+    fileHandle = file;
+    _size = static_cast<size_t>(fileSize.QuadPart);
+    _opened = true;
+    // cant map empty files
+    if(_size == 0)
+        return;
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mapping == nullptr)
+    {
+        close();
+        return;
+    }
+    mappingHandle = mapping;
+    _data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if(_data == nullptr)
+        close();
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return;
+
+    struct stat fileStat
+    {
+    };
+    if(fstat(fd, &fileStat) != 0)
+    {
+        ::close(fd);
+        return;
+    }
+    _size = static_cast<size_t>(fileStat.st_size);
+    _opened = true;
+    // cant map empty files
+    if(_size != 0)
+    {
+        void* mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED)
+        {
+            _opened = false;
+            _size = 0;
+        }
+        else
+        {
+            _data = static_cast<const std::byte*>(mapping);
+            // mostly read front to back when converting vertex data
+            madvise(mapping, _size, MADV_SEQUENTIAL);
+        }
+    }
+    // mapping stays valid after closing the descriptor
+    ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if(this == &other)
+        return *this;
+    close();
+    _data = std::exchange(other._data, nullptr);
+    _size = std::exchange(other._size, 0);
+    _opened = std::exchange(other._opened, false);
+#ifdef _WIN32
+    fileHandle = std::exchange(other.fileHandle, nullptr);
+    mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    return *this;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if(_data != nullptr)
+        UnmapViewOfFile(_data);
+    if(mappingHandle != nullptr)
+        CloseHandle(mappingHandle);
+    if(fileHandle != nullptr)
+        CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if(_data != nullptr)
+        munmap(const_cast<std::byte*>(_data), _size);
+#endif
+    _data = nullptr;
+    _size = 0;
+    _opened = false;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Datastructures/Span.hpp>
+#include <cstddef>
+#include <string>
+
+/*
+    Read only memory mapping of a whole file
+    The OS pages the data in on access, so nothing is copied into process owned memory up front
+    and untouched parts of the file never get read at all
+*/
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    // check isOpen() afterwards
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] bool isOpen() const { return _opened; }
+    [[nodiscard]] const std::byte* data() const { return _data; }
+    [[nodiscard]] size_t size() const { return _size; }
+    [[nodiscard]] Span<const std::byte> bytes() const { return {_data, _size}; }
+
+    void close();
+
+  private:
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+    bool _opened = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -4,10 +4,16 @@
 #include "Graphics/Shaders/HLSL.hpp"
 #include <Datastructures/ArrayHelpers.hpp>
 #include <Engine/Application/Application.hpp>
+#include <Engine/Graphics/Mesh/AttributeDecode.hpp>
+#include <Engine/Graphics/Mesh/MeshOptimize.hpp>
+#include <Engine/Graphics/Mesh/Meshlets.hpp>
+#include <Engine/Graphics/Mesh/VertexWeld.hpp>
 #include <Engine/Graphics/Material/Material.hpp>
 #include <Engine/Misc/PathHelpers.hpp>
 #include <TinyOBJ/tiny_obj_loader.h>
+#include <execution>
 #include <future>
+#include <ranges>
 #include <span>
 #include <tracy/TracyC.h>
 #include <vulkan/vulkan_core.h>
@@ -59,7 +65,12 @@ Buffer::Handle ResourceManager::createBuffer(Buffer::CreateInfo&& createInfo)
 
 void ResourceManager::destroy(Buffer::Handle handle) { VulkanDevice::impl()->destroy(handle); }
 
-Mesh::Handle ResourceManager::createMesh(const char* file, std::string name)
+Mesh::Handle ResourceManager::createMesh(
+    const char* file,
+    std::string name,
+    const MeshOptimize::Options& meshOptions,
+    const Mesh::VertexEncoding& encoding,
+    const Simplify::LODOptions& lodOptions)
 {
     std::string_view fileView{file};
     auto fileName = PathHelpers::fileName(fileView);
@@ -74,7 +85,8 @@ Mesh::Handle ResourceManager::createMesh(const char* file, std::string name)
     std::string warn;
     std::string err;
 
-    tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file, nullptr);
+    // faces with more than 3 vertices get triangulated
+    tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file, nullptr, true);
     if(!warn.empty())
     {
         std::cout << "TinyOBJ WARN: " << warn << std::endl;
@@ -86,54 +98,156 @@ Mesh::Handle ResourceManager::createMesh(const char* file, std::string name)
         return {};
     }
 
-    std::vector<glm::vec3> vertexPositions;
-    std::vector<Mesh::BasicVertexAttributes<0>> vertexAttributes;
+    // tinyobj::index_t is read as raw int32 triplets
+    static_assert(std::is_same_v<tinyobj::real_t, float>);
+    static_assert(sizeof(tinyobj::index_t) == 3 * sizeof(int32_t));
 
-    // TODO: **VERY** unoptimized, barebones
-    for(size_t s = 0; s < shapes.size(); s++)
+    /*
+        Corners that reference the same position/normal/uv triplet are the same vertex, so the welding is done
+        on the index triplets before any attribute is read. Shapes are independent and welded in parallel,
+        then their vertices are gathered into one indexed mesh
+    */
+    struct WeldedShape
     {
+        std::vector<tinyobj::index_t> uniqueCorners;
+        std::vector<uint32_t> indices;
+        size_t vertexOffset = 0;
         size_t indexOffset = 0;
-        for(size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++)
+    };
+    std::vector<WeldedShape> welded(shapes.size());
+    std::ranges::iota_view shapeIndices((size_t)0, shapes.size());
+    std::for_each(
+        std::execution::par,
+        shapeIndices.begin(),
+        shapeIndices.end(),
+        [&shapes, &welded](size_t i)
         {
-            int fv = 3;
+            TracyCZoneN(zoneWeld, "Weld Shape", true);
+            const std::vector<tinyobj::index_t>& corners = shapes[i].mesh.indices;
+            WeldedShape& result = welded[i];
+            result.indices.resize(corners.size());
+            const VertexWeld::Stream triplets{
+                .data = reinterpret_cast<const std::byte*>(corners.data()),
+                .size = sizeof(tinyobj::index_t),
+            };
+            const uint32_t uniqueCount =
+                VertexWeld::generateRemap(result.indices.data(), {&triplets, 1}, corners.size());
+            result.uniqueCorners.resize(uniqueCount);
+            VertexWeld::remapVertices(
+                reinterpret_cast<std::byte*>(result.uniqueCorners.data()),
+                reinterpret_cast<const std::byte*>(corners.data()),
+                sizeof(tinyobj::index_t),
+                0,
+                result.indices.data(),
+                corners.size());
+            TracyCZoneEnd(zoneWeld);
+        });
 
-            for(size_t v = 0; v < fv; v++)
-            {
-                tinyobj::index_t idx = shapes[s].mesh.indices[indexOffset + v];
-
-                // position
-                tinyobj::real_t vx = attrib.vertices[3 * idx.vertex_index + 0];
-                tinyobj::real_t vy = attrib.vertices[3 * idx.vertex_index + 1];
-                tinyobj::real_t vz = attrib.vertices[3 * idx.vertex_index + 2];
-
-                // normal
-                tinyobj::real_t nx = attrib.normals[3 * idx.normal_index + 0];
-                tinyobj::real_t ny = attrib.normals[3 * idx.normal_index + 1];
-                tinyobj::real_t nz = attrib.normals[3 * idx.normal_index + 2];
-
-                // uv
-                tinyobj::real_t uvx = attrib.texcoords[2 * idx.texcoord_index + 0];
-                tinyobj::real_t uvy = attrib.texcoords[2 * idx.texcoord_index + 1];
-
-                vertexPositions.emplace_back(vx, vy, vz);
-                vertexAttributes.emplace_back(Mesh::BasicVertexAttributes<0>{
-                    .normal = {nx, ny, nz},
-                    .color = {nx, ny, nz},
-                    .uvs = {{glm::vec2{uvx, 1.0 - uvy}}},
-                });
-            }
-            indexOffset += fv;
-        }
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    for(WeldedShape& shape : welded)
+    {
+        shape.vertexOffset = vertexCount;
+        shape.indexOffset = indexCount;
+        vertexCount += shape.uniqueCorners.size();
+        indexCount += shape.indices.size();
     }
 
+    using VertexAttributes = Mesh::BasicVertexAttributes<0>;
+    std::vector<glm::vec3> vertexPositions(vertexCount);
+    std::vector<VertexAttributes> vertexAttributes(vertexCount);
+    std::vector<uint32_t> indices(indexCount);
+
+    const AttributeDecode::Table& decode = AttributeDecode::get();
+    std::for_each(
+        std::execution::par,
+        shapeIndices.begin(),
+        shapeIndices.end(),
+        [&](size_t i)
+        {
+            const WeldedShape& shape = welded[i];
+            for(size_t j = 0; j < shape.indices.size(); j++)
+                indices[shape.indexOffset + j] = static_cast<uint32_t>(shape.vertexOffset) + shape.indices[j];
+
+            const size_t count = shape.uniqueCorners.size();
+            if(count == 0)
+                return;
+            const tinyobj::index_t& firstIndex = shape.uniqueCorners[0];
+            auto* attributes = reinterpret_cast<std::byte*>(&vertexAttributes[shape.vertexOffset]);
+            // missing normals/uvs have negative indices and end up as zeros
+            decode.gatherIndexed(
+                reinterpret_cast<std::byte*>(&vertexPositions[shape.vertexOffset]),
+                sizeof(glm::vec3),
+                reinterpret_cast<const std::byte*>(attrib.vertices.data()),
+                sizeof(glm::vec3),
+                &firstIndex.vertex_index,
+                sizeof(tinyobj::index_t),
+                count);
+            decode.gatherIndexed(
+                attributes + offsetof(VertexAttributes, normal),
+                sizeof(VertexAttributes),
+                reinterpret_cast<const std::byte*>(attrib.normals.data()),
+                sizeof(glm::vec3),
+                &firstIndex.normal_index,
+                sizeof(tinyobj::index_t),
+                count);
+            // no vertex colors in obj, use the normals instead
+            decode.gatherIndexed(
+                attributes + offsetof(VertexAttributes, color),
+                sizeof(VertexAttributes),
+                reinterpret_cast<const std::byte*>(attrib.normals.data()),
+                sizeof(glm::vec3),
+                &firstIndex.normal_index,
+                sizeof(tinyobj::index_t),
+                count);
+            decode.gatherIndexed(
+                attributes + offsetof(VertexAttributes, uvs),
+                sizeof(VertexAttributes),
+                reinterpret_cast<const std::byte*>(attrib.texcoords.data()),
+                sizeof(glm::vec2),
+                &firstIndex.texcoord_index,
+                sizeof(tinyobj::index_t),
+                count);
+            // obj has v pointing up
+            for(size_t j = shape.vertexOffset; j < shape.vertexOffset + count; j++)
+                vertexAttributes[j].uvs[0].y = 1.0f - vertexAttributes[j].uvs[0].y;
+        });
+
     Span<std::byte> vertexAttributesByteArr{
         (std::byte*)vertexAttributes.data(), vertexAttributes.size() * sizeof(vertexAttributes[0])};
+    MeshOptimize::optimize(
+        meshOptions,
+        indices,
+        {(std::byte*)vertexPositions.data(), vertexPositions.size() * sizeof(vertexPositions[0])},
+        vertexAttributesByteArr,
+        sizeof(VertexAttributes));
+    TracyCZoneN(zoneMeshlets, "Build Meshlets", true);
+    const Meshlets::MeshletData meshlets = Meshlets::build(
+        indices.data(),
+        indices.size(),
+        reinterpret_cast<const float*>(vertexPositions.data()),
+        sizeof(glm::vec3),
+        vertexPositions.size());
+    TracyCZoneEnd(zoneMeshlets);
+    // appended after LOD 0, the meshlets above only cover LOD 0
+    TracyCZoneN(zoneLODs, "Generate LODs", true);
+    const std::vector<Mesh::LOD> lods = Mesh::generateLODs(
+        indices,
+        vertexPositions,
+        vertexAttributesByteArr,
+        Mesh::VertexAttributeFormat{.additionalUVCount = 0},
+        lodOptions,
+        meshOptions.vertexCache);
+    TracyCZoneEnd(zoneLODs);
     return createMesh(
         vertexPositions,
         vertexAttributesByteArr,
         Mesh::VertexAttributeFormat{.additionalUVCount = 0},
-        {},
-        std::move(meshName));
+        indices,
+        std::move(meshName),
+        encoding,
+        meshlets.view(),
+        lods);
 }
 
 Mesh::Handle ResourceManager::createMesh(
@@ -141,12 +255,33 @@ Mesh::Handle ResourceManager::createMesh(
     Span<std::byte> vertexAttributes,
     Mesh::VertexAttributeFormat vertexAttributesFormat,
     Span<const uint32_t> indices,
-    std::string name)
+    std::string name,
+    const Mesh::VertexEncoding& encoding,
+    const Meshlets::View& meshlets,
+    Span<const Mesh::LOD> lods)
 {
     // todo: handle naming collisions
     auto iterator = nameToMeshLUT.find(name);
     assert(iterator == nameToMeshLUT.end());
 
+    Span<const std::byte> positionBytes{
+        reinterpret_cast<const std::byte*>(vertexPositions.data()),
+        vertexPositions.size() * sizeof(Mesh::PositionType)};
+    Span<const std::byte> attributeBytes{vertexAttributes.data(), vertexAttributes.size()};
+    Mesh::VertexAttributeFormat attributeFormat = vertexAttributesFormat;
+    Mesh::Dequantization dequantization;
+    Mesh::EncodedVertices encoded;
+    if(!encoding.isFloat())
+    {
+        TracyCZoneN(zoneEncode, "Encode Vertices", true);
+        encoded = Mesh::encodeVertices(vertexPositions, vertexAttributes, vertexAttributesFormat, encoding);
+        positionBytes = encoded.positions;
+        attributeBytes = encoded.attributes;
+        attributeFormat = encoded.attributeFormat;
+        dequantization = encoded.dequantization;
+        TracyCZoneEnd(zoneEncode);
+    }
+
     std::vector<uint32_t> trivialIndices{};
     if(indices.empty())
     {
@@ -161,20 +296,20 @@ Mesh::Handle ResourceManager::createMesh(
 
     Buffer::Handle positionBufferHandle = createBuffer(Buffer::CreateInfo{
         .debugName = (name + "_positionsBuffer"),
-        .size = vertexPositions.size() * sizeof(glm::vec3),
+        .size = positionBytes.size(),
         .memoryType = Buffer::MemoryType::GPU,
         .allStates = ResourceState::VertexBuffer | ResourceState::Storage | ResourceState::TransferDst,
         .initialState = ResourceState::VertexBuffer,
-        .initialData = {(uint8_t*)vertexPositions.data(), vertexPositions.size() * sizeof(vertexPositions[0])},
+        .initialData = {(uint8_t*)positionBytes.data(), positionBytes.size()},
     });
 
     Buffer::Handle attributesBufferHandle = createBuffer(Buffer::CreateInfo{
         .debugName = (name + "_attributesBuffer"),
-        .size = vertexAttributes.size(),
+        .size = attributeBytes.size(),
         .memoryType = Buffer::MemoryType::GPU,
         .allStates = ResourceState::VertexBuffer | ResourceState::Storage | ResourceState::TransferDst,
         .initialState = ResourceState::VertexBuffer,
-        .initialData = {(uint8_t*)vertexAttributes.data(), vertexAttributes.size()},
+        .initialData = {(uint8_t*)attributeBytes.data(), attributeBytes.size()},
     });
 
     Buffer::Handle indexBufferHandle = createBuffer(Buffer::CreateInfo{
@@ -186,16 +321,62 @@ Mesh::Handle ResourceManager::createMesh(
         .initialData = {(uint8_t*)indices.data(), indices.size() * sizeof(indices[0])},
     });
 
-    Mesh::Handle newMeshHandle = meshPool.insert(
-        name,
-        Mesh::RenderData{
-            .indexCount = uint32_t(indices.size()),
-            .additionalUVCount = vertexAttributesFormat.additionalUVCount,
-            .indexBuffer = indexBufferHandle,
-            .positionBuffer = positionBufferHandle,
-            .attributeBuffer = attributesBufferHandle,
-            .gpuIndex = 0xFFFFFFFF,
-        });
+    // from the float positions, so quantized meshes dont get bounds that are off by the rounding
+    TracyCZoneN(zoneBounds, "Compute Bounds", true);
+    const auto* positionFloats = reinterpret_cast<const float*>(vertexPositions.data());
+    const size_t positionStride = sizeof(Mesh::PositionType);
+    const Bounds::AABB aabb = Bounds::computeAABB(positionFloats, positionStride, vertexPositions.size());
+    const Bounds::Sphere boundingSphere =
+        Bounds::computeSphere(positionFloats, positionStride, vertexPositions.size(), aabb);
+    TracyCZoneEnd(zoneBounds);
+
+    Mesh::RenderData renderData{
+        .indexCount = uint32_t(indices.size()),
+        .lodCount = 1,
+        .lods = {Mesh::LOD{.indexOffset = 0, .indexCount = uint32_t(indices.size())}},
+        .attributeFormat = attributeFormat,
+        .dequantization = dequantization,
+        .aabb = aabb,
+        .boundingSphere = boundingSphere,
+        .indexBuffer = indexBufferHandle,
+        .positionBuffer = positionBufferHandle,
+        .attributeBuffer = attributesBufferHandle,
+    };
+
+    if(lods.size() > 0)
+    {
+        assert(lods.size() <= Mesh::MAX_LODS);
+        renderData.lodCount = uint32_t(lods.size());
+        for(int i = 0; i < lods.size(); i++)
+        {
+            assert(lods[i].indexOffset + lods[i].indexCount <= indices.size());
+            renderData.lods[i] = lods[i];
+        }
+    }
+
+    if(meshlets.meshlets.size() > 0)
+    {
+        const auto createMeshletBuffer = [&](const std::string& suffix, const void* data, size_t size)
+        {
+            return createBuffer(Buffer::CreateInfo{
+                .debugName = (name + suffix),
+                .size = size,
+                .memoryType = Buffer::MemoryType::GPU,
+                .allStates = ResourceState::Storage | ResourceState::TransferDst,
+                .initialState = ResourceState::Storage,
+                .initialData = {(uint8_t*)data, size},
+            });
+        };
+        renderData.meshletCount = uint32_t(meshlets.meshlets.size());
+        renderData.meshletBuffer = createMeshletBuffer(
+            "_meshletBuffer", meshlets.meshlets.data(), meshlets.meshlets.size() * sizeof(Meshlets::Meshlet));
+        renderData.meshletVertexBuffer = createMeshletBuffer(
+            "_meshletVertexBuffer", meshlets.vertices.data(), meshlets.vertices.size() * sizeof(uint32_t));
+        renderData.meshletTriangleBuffer = createMeshletBuffer(
+            "_meshletTriangleBuffer", meshlets.triangles.data(), meshlets.triangles.size() * sizeof(uint32_t));
+    }
+
+    Mesh::Handle newMeshHandle = meshPool.insert(name, renderData);
 
     nameToMeshLUT.insert({std::string{name}, newMeshHandle});
 
@@ -216,6 +397,9 @@ void ResourceManager::destroy(Mesh::Handle handle)
     device->destroy(renderData.positionBuffer);
     device->destroy(renderData.attributeBuffer);
     device->destroy(renderData.indexBuffer);
+    device->destroy(renderData.meshletBuffer);
+    device->destroy(renderData.meshletVertexBuffer);
+    device->destroy(renderData.meshletTriangleBuffer);
     meshPool.remove(handle);
 }
 
@@ -254,9 +438,6 @@ Texture::Handle ResourceManager::createTexture(Texture::LoadInfo&& loadInfo)
 
     return newTextureHandle;
 }
-// TODO: move to top
-#include <execution>
-#include <ranges>
 
 std::vector<Texture::Handle> ResourceManager::createTextures(const Span<Texture::LoadInfo> loadInfos)
 {
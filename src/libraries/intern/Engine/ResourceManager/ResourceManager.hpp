@@ -7,6 +7,8 @@
 #include <Engine/Graphics/Device/VulkanDevice.hpp>
 #include <Engine/Graphics/Material/Material.hpp>
 #include <Engine/Graphics/Mesh/Mesh.hpp>
+#include <Engine/Graphics/Mesh/MeshOptimize.hpp>
+#include <Engine/Graphics/Mesh/Meshlets.hpp>
 #include <Engine/Graphics/Texture/Sampler.hpp>
 #include <Engine/Graphics/Texture/Texture.hpp>
 #include <Engine/Graphics/Texture/TextureView.hpp>
@@ -46,14 +48,28 @@ class ResourceManager
 
     // --------- Mesh -----------------------------------
 
-    Mesh::Handle createMesh(const char* file, std::string name = "");
-    // indices can be {}, but then a trivial index list will still be used!
+    // meshOptions selects the reordering passes run before the upload, LODs and meshlets get built afterwards
+    Mesh::Handle createMesh(
+        const char* file,
+        std::string name = "",
+        const MeshOptimize::Options& meshOptions = {},
+        const Mesh::VertexEncoding& encoding = {},
+        const Simplify::LODOptions& lodOptions = {});
+    /*
+        indices can be {}, but then a trivial index list will still be used!
+        vertexAttributesFormat has to use float encodings, the data gets converted into encoding for the upload
+        meshlets have to be built from the LOD 0 indices, they are optional
+        lods are the ranges of indices, if empty all indices are LOD 0
+    */
     Mesh::Handle createMesh(
         Span<const Mesh::PositionType> vertexPositions,
         Span<std::byte> vertexAttributes,
         Mesh::VertexAttributeFormat vertexAttributesFormat,
         Span<const uint32_t> indices,
-        std::string name);
+        std::string name,
+        const Mesh::VertexEncoding& encoding = {},
+        const Meshlets::View& meshlets = {},
+        Span<const Mesh::LOD> lods = {});
     void destroy(Mesh::Handle handle);
     template <typename T>
         requires Mesh::Handle::holdsType<T>
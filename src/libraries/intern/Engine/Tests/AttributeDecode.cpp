@@ -0,0 +1,164 @@
+#include <Engine/Graphics/Mesh/AttributeDecode.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace AttributeDecode;
+
+int main()
+{
+    const Table& fast = get();
+    const Table& reference = scalar();
+    std::mt19937 rng{1337};
+
+    std::vector<std::byte> randomBytes(4096);
+    for(auto& b : randomBytes)
+        b = static_cast<std::byte>(rng() & 0xFF);
+
+    // known values
+    {
+        const int8_t snorm8[4] = {127, -127, -128, 0};
+        float out[4];
+        fast.toFloat(
+            out,
+            sizeof(out),
+            Source{
+                .data = reinterpret_cast<const std::byte*>(snorm8),
+                .count = 1,
+                .componentType = ComponentType::Int8,
+                .componentCount = 4,
+                .normalized = true});
+        assert(out[0] == 1.0f && out[1] == -1.0f && out[2] == -1.0f && out[3] == 0.0f);
+
+        const uint16_t unorm16[2] = {65535, 0};
+        fast.toFloat(
+            out,
+            sizeof(float) * 2,
+            Source{
+                .data = reinterpret_cast<const std::byte*>(unorm16),
+                .count = 1,
+                .componentType = ComponentType::UInt16,
+                .componentCount = 2,
+                .normalized = true});
+        assert(out[0] == 1.0f && out[1] == 0.0f);
+
+        const int16_t ints[3] = {-5, 300, 7};
+        fast.toFloat(
+            out,
+            sizeof(float) * 3,
+            Source{
+                .data = reinterpret_cast<const std::byte*>(ints),
+                .count = 1,
+                .componentType = ComponentType::Int16,
+                .componentCount = 3});
+        assert(out[0] == -5.0f && out[1] == 300.0f && out[2] == 7.0f);
+    }
+
+    // toFloat, every type/component count, interleaved source and destination
+    for(auto type :
+        {ComponentType::Int8,
+         ComponentType::UInt8,
+         ComponentType::Int16,
+         ComponentType::UInt16,
+         ComponentType::UInt32,
+         ComponentType::Float32})
+    {
+        for(uint32_t components = 1; components <= 4; components++)
+        {
+            for(bool normalized : {false, true})
+            {
+                if(normalized && (type == ComponentType::UInt32 || type == ComponentType::Float32))
+                    continue;
+                // float sources have to be copied bit exact, avoid NaNs
+                std::vector<std::byte> bytes = randomBytes;
+                if(type == ComponentType::Float32)
+                {
+                    for(size_t i = 0; i + 4 <= bytes.size(); i += 4)
+                    {
+                        const float f = static_cast<float>(rng() % 2000) - 1000.0f;
+                        std::memcpy(&bytes[i], &f, 4);
+                    }
+                }
+                const Source source{
+                    .data = bytes.data() + 1,
+                    .stride = 20,
+                    .count = 101,
+                    .componentType = type,
+                    .componentCount = components,
+                    .normalized = normalized};
+                // leave gaps in the destination to make sure they arent touched
+                constexpr size_t dstStride = 24;
+                std::vector<float> expected(source.count * dstStride / sizeof(float), 42.0f);
+                std::vector<float> result(expected.size(), 42.0f);
+                reference.toFloat(expected.data(), dstStride, source);
+                fast.toFloat(result.data(), dstStride, source);
+                assert(std::memcmp(expected.data(), result.data(), expected.size() * sizeof(float)) == 0);
+            }
+        }
+    }
+
+    // copyStrided
+    for(size_t elementSize : {2, 4, 8, 12, 16})
+    {
+        for(auto [srcStride, dstStride] : {std::pair<size_t, size_t>{elementSize, elementSize}, {20, 32}})
+        {
+            std::vector<std::byte> expected(100 * dstStride, std::byte{0xCD});
+            std::vector<std::byte> result = expected;
+            reference.copyStrided(expected.data(), dstStride, randomBytes.data() + 3, srcStride, elementSize, 100);
+            fast.copyStrided(result.data(), dstStride, randomBytes.data() + 3, srcStride, elementSize, 100);
+            assert(expected == result);
+        }
+    }
+
+    // gatherIndexed, index read out of a struct like tinyobjs index triplets
+    {
+        struct IndexTriplet
+        {
+            int32_t a, b, c;
+        };
+        std::vector<IndexTriplet> triplets(200);
+        for(auto& t : triplets)
+            t = {static_cast<int32_t>(rng() % 200), -1, static_cast<int32_t>(rng() % 200)};
+
+        for(size_t elementSize : {4, 8, 12, 16, 6})
+        {
+            for(const int32_t* indices : {&triplets[0].a, &triplets[0].b, &triplets[0].c})
+            {
+                constexpr size_t dstStride = 40;
+                std::vector<std::byte> expected(triplets.size() * dstStride, std::byte{0xCD});
+                std::vector<std::byte> result = expected;
+                reference.gatherIndexed(
+                    expected.data(), dstStride, randomBytes.data(), elementSize, indices, 12, triplets.size());
+                fast.gatherIndexed(
+                    result.data(), dstStride, randomBytes.data(), elementSize, indices, 12, triplets.size());
+                assert(expected == result);
+            }
+        }
+        // missing data gets zeroed
+        std::vector<uint32_t> out(2, 0xFFFFFFFF);
+        const int32_t missing[2] = {-1, 0};
+        fast.gatherIndexed(
+            reinterpret_cast<std::byte*>(out.data()), 4, randomBytes.data(), 4, missing, sizeof(int32_t), 2);
+        assert(out[0] == 0);
+        assert(std::memcmp(&out[1], randomBytes.data(), 4) == 0);
+    }
+
+    // widenIndices, odd counts to hit the scalar tails
+    for(auto type : {ComponentType::UInt8, ComponentType::UInt16, ComponentType::UInt32})
+    {
+        const size_t count = 1021 / componentSize(type);
+        std::vector<uint32_t> expected(count);
+        std::vector<uint32_t> result(count);
+        reference.widenIndices(expected.data(), randomBytes.data() + 1, type, count);
+        fast.widenIndices(result.data(), randomBytes.data() + 1, type, count);
+        assert(expected == result);
+    }
+    {
+        const uint16_t indices[9] = {0, 1, 2, 65535, 4, 5, 6, 7, 8};
+        uint32_t out[9];
+        widenIndices(out, reinterpret_cast<const std::byte*>(indices), ComponentType::UInt16, 9);
+        assert(out[3] == 65535 && out[8] == 8);
+    }
+}
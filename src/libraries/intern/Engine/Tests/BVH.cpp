@@ -0,0 +1,200 @@
+#include <Engine/Graphics/Culling/BVH.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+/*
+    Builds BVHs over random boxes (enough to go through the parallel part of the build) and compares all
+    queries against brute force, before and after moving items around and refitting
+*/
+
+namespace
+{
+    struct Matrix
+    {
+        float m[16] = {};
+    };
+
+    // column major perspective * view looking from position at -z, see Tests/Frustum.cpp
+    Matrix perspectiveAt(float x, float y, float z)
+    {
+        constexpr float nearPlane = 0.1f;
+        constexpr float farPlane = 200.0f;
+        const float f = 1.0f / std::tan(0.5f);
+        Matrix result;
+        result.m[0] = f / (16.0f / 9.0f);
+        result.m[5] = -f;
+        result.m[10] = farPlane / (nearPlane - farPlane);
+        result.m[11] = -1.0f;
+        result.m[14] = -(farPlane * nearPlane) / (farPlane - nearPlane);
+        // translation by -position, only changes the last column
+        const float t[3] = {-x, -y, -z};
+        for(int r = 0; r < 4; r++)
+            result.m[12 + r] += result.m[r] * t[0] + result.m[4 + r] * t[1] + result.m[8 + r] * t[2];
+        return result;
+    }
+
+    Bounds::AABB randomBox(std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> position{-500.0f, 500.0f};
+        std::uniform_real_distribution<float> size{0.1f, 4.0f};
+        const float p[3] = {position(rng), position(rng) * 0.1f, position(rng)};
+        const float s = size(rng);
+        return {.min = {p[0] - s, p[1] - s, p[2] - s}, .max = {p[0] + s, p[1] + s, p[2] + s}};
+    }
+
+    bool overlaps(const Bounds::AABB& a, const Bounds::AABB& b)
+    {
+        for(int c = 0; c < 3; c++)
+        {
+            if(a.max[c] < b.min[c] || a.min[c] > b.max[c])
+                return false;
+        }
+        return true;
+    }
+
+    void checkStructure(const BVH& bvh, const std::vector<Bounds::AABB>& boxes)
+    {
+        const Span<const BVH::Node> nodes = bvh.getNodes();
+        std::vector<uint32_t> seen(boxes.size(), 0);
+        for(uint32_t i = 0; i < nodes.size(); i++)
+        {
+            const BVH::Node& node = nodes[i];
+            if(node.isLeaf())
+            {
+                assert(node.itemCount <= BVH::maxLeafSize);
+                continue;
+            }
+            assert(node.firstOrChild > i && node.firstOrChild + 1 < nodes.size());
+            // children are contained
+            for(uint32_t child = node.firstOrChild; child < node.firstOrChild + 2; child++)
+            {
+                for(int c = 0; c < 3; c++)
+                {
+                    assert(nodes[child].bounds.min[c] >= node.bounds.min[c]);
+                    assert(nodes[child].bounds.max[c] <= node.bounds.max[c]);
+                }
+            }
+        }
+        // every item in exactly one leaf, with its bounds
+        for(uint32_t item = 0; item < boxes.size(); item++)
+        {
+            const Bounds::AABB& stored = bvh.getItemBounds(item);
+            for(int c = 0; c < 3; c++)
+                assert(stored.min[c] == boxes[item].min[c] && stored.max[c] == boxes[item].max[c]);
+        }
+        std::vector<uint32_t> all;
+        bvh.queryAABB({.min = {-1e9f, -1e9f, -1e9f}, .max = {1e9f, 1e9f, 1e9f}}, all);
+        assert(all.size() == boxes.size());
+        for(const uint32_t item : all)
+            seen[item]++;
+        assert(std::all_of(seen.begin(), seen.end(), [](uint32_t n) { return n == 1; }));
+    }
+
+    void checkQueries(const BVH& bvh, const std::vector<Bounds::AABB>& boxes, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> position{-400.0f, 400.0f};
+        for(int q = 0; q < 8; q++)
+        {
+            const Matrix projView = perspectiveAt(position(rng), 0.0f, position(rng));
+            const Culling::Frustum frustum = Culling::extractFrustum(projView.m);
+            std::vector<uint32_t> result;
+            bvh.queryFrustum(frustum, result);
+            std::vector<uint32_t> expected(boxes.size());
+            expected.resize(Culling::cullAABBs(frustum, boxes, 0, expected.data()));
+            std::sort(result.begin(), result.end());
+            assert(result == expected);
+
+            const float x = position(rng);
+            const float z = position(rng);
+            const Bounds::AABB range{.min = {x, -20.0f, z}, .max = {x + 100.0f, 20.0f, z + 50.0f}};
+            result.clear();
+            expected.clear();
+            bvh.queryAABB(range, result);
+            for(uint32_t i = 0; i < boxes.size(); i++)
+            {
+                if(overlaps(boxes[i], range))
+                    expected.push_back(i);
+            }
+            std::sort(result.begin(), result.end());
+            assert(result == expected);
+
+            const float center[3] = {position(rng), 0.0f, position(rng)};
+            result.clear();
+            bvh.querySphere(center, 30.0f, result);
+            for(const uint32_t item : result)
+            {
+                const Bounds::AABB& b = boxes[item];
+                float distanceSq = 0.0f;
+                for(int c = 0; c < 3; c++)
+                {
+                    const float d = center[c] - std::clamp(center[c], b.min[c], b.max[c]);
+                    distanceSq += d * d;
+                }
+                assert(distanceSq <= 30.0f * 30.0f);
+            }
+
+            // ray along x through the middle of a random box has to hit it or something before it
+            const Bounds::AABB& target = boxes[rng() % boxes.size()];
+            const float origin[3] = {
+                -1000.0f, (target.min[1] + target.max[1]) * 0.5f, (target.min[2] + target.max[2]) * 0.5f};
+            const float direction[3] = {1.0f, 0.0f, 0.0f};
+            const BVH::RayHit hit = bvh.raycast(origin, direction);
+            assert(hit.item != BVH::NoItem);
+            assert(hit.distance <= target.min[0] - origin[0]);
+            float bestDistance = std::numeric_limits<float>::infinity();
+            for(const Bounds::AABB& b : boxes)
+            {
+                const bool insideY = origin[1] >= b.min[1] && origin[1] <= b.max[1];
+                if(insideY && origin[2] >= b.min[2] && origin[2] <= b.max[2])
+                    bestDistance = std::min(bestDistance, b.min[0] - origin[0]);
+            }
+            assert(hit.distance == bestDistance);
+
+            // refining with a callback that rejects everything
+            const BVH::RayHit miss = bvh.raycast(
+                origin, direction, 1e9f, [](uint32_t) { return std::numeric_limits<float>::infinity(); });
+            assert(miss.item == BVH::NoItem);
+        }
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 rng{17};
+    for(const uint32_t count : {0u, 1u, 5u, 100u, 50000u})
+    {
+        std::vector<Bounds::AABB> boxes(count);
+        for(Bounds::AABB& box : boxes)
+            box = randomBox(rng);
+
+        BVH bvh;
+        bvh.build(boxes);
+        if(count == 0)
+        {
+            assert(bvh.getNodes().empty());
+            std::vector<uint32_t> result;
+            bvh.queryFrustum(Culling::extractFrustum(perspectiveAt(0.0f, 0.0f, 0.0f).m), result);
+            assert(result.empty());
+            continue;
+        }
+        checkStructure(bvh, boxes);
+        checkQueries(bvh, boxes, rng);
+
+        // move a tenth of the items
+        for(uint32_t i = 0; i < count; i += 10)
+        {
+            boxes[i] = randomBox(rng);
+            bvh.updateItem(i, boxes[i]);
+        }
+        bvh.refit();
+        checkStructure(bvh, boxes);
+        checkQueries(bvh, boxes, rng);
+        printf("%u items, %zu nodes\n", count, bvh.getNodes().size());
+    }
+}
@@ -0,0 +1,50 @@
+#include <Engine/Misc/Base64.hpp>
+
+#include <cassert>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    std::string decodeToString(std::string_view encoded)
+    {
+        std::vector<std::byte> bytes;
+        bool success = Base64::decode(encoded, bytes);
+        assert(success);
+        return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    }
+} // namespace
+
+int main()
+{
+    assert(decodeToString("") == "");
+    assert(decodeToString("Zg==") == "f");
+    assert(decodeToString("Zm8=") == "fo");
+    assert(decodeToString("Zm9v") == "foo");
+    assert(decodeToString("Zm9vYg==") == "foob");
+    assert(decodeToString("Zm9vYmE=") == "fooba");
+    assert(decodeToString("Zm9vYmFy") == "foobar");
+    assert(decodeToString("SGVsbG8sIFdvcmxkIQ==") == "Hello, World!");
+
+    {
+        // every byte value
+        const std::string_view encoded =
+            "AAECAwQFBgcICQoLDA0ODxAREhMUFRYXGBkaGxwdHh8gISIjJCUmJygpKissLS4vMDEyMzQ1Njc4OTo7"
+            "PD0+P0BBQkNERUZHSElKS0xNTk9QUVJTVFVWV1hZWltcXV5fYGFiY2RlZmdoaWprbG1ub3BxcnN0dXZ3"
+            "eHl6e3x9fn+AgYKDhIWGh4iJiouMjY6PkJGSk5SVlpeYmZqbnJ2en6ChoqOkpaanqKmqq6ytrq+wsbKz"
+            "tLW2t7i5uru8vb6/wMHCw8TFxsfIycrLzM3Oz9DR0tPU1dbX2Nna29zd3t/g4eLj5OXm5+jp6uvs7e7v"
+            "8PHy8/T19vf4+fr7/P3+/w==";
+        std::vector<std::byte> bytes;
+        assert(Base64::decode(encoded, bytes));
+        assert(bytes.size() == 256);
+        for(int i = 0; i < 256; i++)
+            assert(bytes[i] == static_cast<std::byte>(i));
+    }
+
+    // invalid input
+    std::vector<std::byte> bytes;
+    assert(!Base64::decode("Zm9", bytes));
+    assert(!Base64::decode("Zm9v!m9v", bytes));
+    assert(!Base64::decode("Zm=v", bytes));
+    assert(!Base64::decode("Zm9v Zm9", bytes));
+}
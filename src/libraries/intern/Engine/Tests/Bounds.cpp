@@ -0,0 +1,109 @@
+#include <Engine/Graphics/Mesh/Bounds.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*
+    Compares the vectorized reductions against a plain loop for all small counts and a few strides,
+    and checks that the spheres contain all positions
+*/
+
+using namespace Bounds;
+
+namespace
+{
+    void check(const std::vector<float>& data, size_t floatStride, size_t count)
+    {
+        const size_t stride = floatStride * sizeof(float);
+        // copy into an exactly sized allocation, so ASan catches reads past the last position
+        std::vector<float> positions(data.begin(), data.begin() + (count == 0 ? 0 : (count - 1) * floatStride + 3));
+
+        AABB expected;
+        for(size_t i = 0; i < count; i++)
+        {
+            for(int c = 0; c < 3; c++)
+            {
+                expected.min[c] = std::min(expected.min[c], positions[i * floatStride + c]);
+                expected.max[c] = std::max(expected.max[c], positions[i * floatStride + c]);
+            }
+        }
+
+        const AABB aabb = computeAABB(positions.data(), stride, count);
+        assert(aabb.isEmpty() == (count == 0));
+        for(int c = 0; c < 3; c++)
+        {
+            assert(aabb.min[c] == expected.min[c]);
+            assert(aabb.max[c] == expected.max[c]);
+        }
+
+        const Sphere sphere = computeSphere(positions.data(), stride, count, aabb);
+        if(count == 0)
+        {
+            assert(sphere.radius < 0.0f);
+            return;
+        }
+        float maxDistance = 0.0f;
+        for(size_t i = 0; i < count; i++)
+        {
+            const float* p = &positions[i * floatStride];
+            const float distance =
+                std::hypot(p[0] - sphere.center[0], p[1] - sphere.center[1], p[2] - sphere.center[2]);
+            assert(distance <= sphere.radius * 1.0001f + 1e-6f);
+            maxDistance = std::max(maxDistance, distance);
+        }
+        // tight around the center it uses
+        assert(std::abs(maxDistance - sphere.radius) <= sphere.radius * 1e-4f + 1e-6f);
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 rng{5};
+    std::uniform_real_distribution<float> dist{-100.0f, 50.0f};
+    std::vector<float> data(4 * 1000);
+    for(float& f : data)
+        f = dist(rng);
+
+    for(const size_t floatStride : {3, 4, 8})
+    {
+        for(size_t count = 0; count < 20; count++)
+            check(data, floatStride, count);
+        check(data, floatStride, data.size() / floatStride);
+    }
+
+    {
+        // all positions on one side of the origin
+        std::vector<float> shifted = data;
+        for(float& f : shifted)
+            f += 1000.0f;
+        check(shifted, 3, shifted.size() / 3);
+        const AABB aabb = computeAABB(shifted.data(), sizeof(float) * 3, shifted.size() / 3);
+        assert(aabb.min[0] > 899.0f && aabb.max[0] <= 1050.0f);
+
+        AABB merged;
+        assert(merged.isEmpty());
+        merged.merge(aabb);
+        merged.merge(computeAABB(data.data(), sizeof(float) * 3, data.size() / 3));
+        assert(merged.min[0] < -99.0f && merged.max[0] > 1049.0f);
+    }
+    {
+        Sphere merged;
+        assert(merged.isEmpty());
+        const Sphere a{.center = {0.0f, 0.0f, 0.0f}, .radius = 1.0f};
+        const Sphere b{.center = {4.0f, 0.0f, 0.0f}, .radius = 2.0f};
+        merged.merge(a);
+        assert(merged.radius == 1.0f);
+        merged.merge(b);
+        assert(std::abs(merged.radius - 3.5f) < 1e-6f && std::abs(merged.center[0] - 2.5f) < 1e-6f);
+        // contained ones dont change it
+        merged.merge(Sphere{.center = {2.0f, 1.0f, 0.0f}, .radius = 0.5f});
+        assert(std::abs(merged.radius - 3.5f) < 1e-6f);
+        merged.merge(Sphere{.center = {2.5f, 0.0f, 0.0f}, .radius = 10.0f});
+        assert(merged.radius == 10.0f);
+    }
+    printf("bounds ok\n");
+}
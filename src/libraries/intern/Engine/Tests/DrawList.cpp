@@ -0,0 +1,129 @@
+#include <Engine/Graphics/DrawList/DrawList.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*
+    Checks the key layout, that sorting matches std::stable_sort (small lists and ones large enough to go
+    wide), the state change counting and the merging into instanced batches
+*/
+
+using namespace DrawList;
+
+int main()
+{
+    // fields end up where they belong and get truncated
+    {
+        const uint64_t key = makeKey(3, 0x123, 0xBEEF, 0xCAFE, 1.0f);
+        assert(keyField(key, passShift, passBits) == 3);
+        assert(keyField(key, pipelineShift, pipelineBits) == 0x123);
+        assert(keyField(key, materialShift, materialBits) == 0xBEEF);
+        assert(keyField(key, meshShift, meshBits) == 0xCAFE);
+        assert(keyField(makeKey(0x13, 0x1123, 0, 0, 0.0f), pipelineShift, pipelineBits) == 0x123);
+        assert(keyField(makeKey(0x13, 0x1123, 0, 0, 0.0f), passShift, passBits) == 3);
+    }
+    // depth sorts front to back and never overrides the more significant parts
+    {
+        float lastDepth = 0.0f;
+        for(const float depth : {0.001f, 0.5f, 1.0f, 10.0f, 1000.0f, 1e6f})
+        {
+            assert(makeKey(0, 1, 1, 1, lastDepth) < makeKey(0, 1, 1, 1, depth));
+            lastDepth = depth;
+        }
+        assert(makeKey(0, 1, 1, 1, -5.0f) == makeKey(0, 1, 1, 1, 0.0f));
+        assert(makeKey(0, 1, 1, 1, 1e30f) < makeKey(0, 1, 1, 2, 0.0f));
+        assert(makeKey(0, 1, 2, 0, 0.0f) < makeKey(0, 2, 0, 0, 0.0f));
+        assert(makeKey(0, 0xFFF, 0, 0, 0.0f) < makeKey(1, 0, 0, 0, 0.0f));
+    }
+
+    std::mt19937 rng{5};
+    std::vector<Packet> scratch;
+    for(const uint32_t count : {0u, 1u, 2u, 100u, 5000u, 100000u})
+    {
+        // few pipelines and materials so there are lots of equal keys to check stability with
+        std::uniform_int_distribution<uint32_t> pipeline{0, 5};
+        std::uniform_int_distribution<uint32_t> material{0, 40};
+        std::uniform_int_distribution<uint32_t> mesh{0, 300};
+        std::uniform_int_distribution<uint32_t> depth{0, 8};
+        std::vector<Packet> packets(count);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            const uint64_t key = makeKey(0, pipeline(rng), material(rng), mesh(rng), float(depth(rng)));
+            packets[i] = {.key = key, .draw = i};
+        }
+        const std::vector<Packet> unsorted = packets;
+        std::vector<Packet> expected = packets;
+        std::stable_sort(
+            expected.begin(), expected.end(), [](const Packet& a, const Packet& b) { return a.key < b.key; });
+
+        sort(packets, scratch);
+        assert(packets.size() == count);
+        for(uint32_t i = 0; i < count; i++)
+            assert(packets[i].key == expected[i].key && packets[i].draw == expected[i].draw);
+
+        // already sorted stays the same
+        sort(packets, scratch);
+        for(uint32_t i = 0; i < count; i++)
+            assert(packets[i].draw == expected[i].draw);
+
+        const StateChanges changes = countStateChanges(packets);
+        if(count > 0)
+        {
+            assert(changes.passes == 1);
+            assert(changes.pipelines <= 6);
+            assert(changes.materials <= 6 * 41);
+            assert(changes.pipelines <= changes.materials && changes.materials <= changes.meshes);
+        }
+        if(count == 100000)
+        {
+            const StateChanges before = countStateChanges(unsorted);
+            printf("%u draws, pipeline changes: %u -> %u", count, before.pipelines, changes.pipelines);
+            printf(", material changes: %u -> %u\n", before.materials, changes.materials);
+        }
+    }
+
+    // counting itself
+    {
+        const std::vector<Packet> packets = {
+            {.key = makeKey(0, 1, 1, 1, 0.0f), .draw = 0},
+            {.key = makeKey(0, 1, 1, 1, 5.0f), .draw = 1},
+            {.key = makeKey(0, 1, 1, 2, 0.0f), .draw = 2},
+            {.key = makeKey(0, 1, 2, 2, 0.0f), .draw = 3},
+            {.key = makeKey(0, 2, 2, 2, 0.0f), .draw = 4},
+        };
+        const StateChanges changes = countStateChanges(packets);
+        assert(changes.passes == 1);
+        assert(changes.pipelines == 2);
+        assert(changes.materials == 3);
+        assert(changes.meshes == 4);
+        assert(countStateChanges({}).meshes == 0);
+    }
+
+    // batching, the draw index stands in for the LOD here
+    {
+        const std::vector<Packet> packets = {
+            {.key = makeKey(0, 1, 1, 1, 0.0f), .draw = 0},
+            {.key = makeKey(0, 1, 1, 1, 5.0f), .draw = 0},
+            {.key = makeKey(0, 1, 1, 1, 9.0f), .draw = 1},
+            {.key = makeKey(0, 1, 1, 2, 0.0f), .draw = 1},
+            {.key = makeKey(0, 1, 2, 2, 0.0f), .draw = 1},
+            {.key = makeKey(0, 1, 2, 2, 3.0f), .draw = 1},
+        };
+        std::vector<Batch> batches;
+        buildBatches(packets, [](uint32_t a, uint32_t b) { return a == b; }, batches);
+        assert(batches.size() == 4);
+        const uint32_t expectedCounts[4] = {2, 1, 1, 2};
+        uint32_t nextPacket = 0;
+        for(uint32_t i = 0; i < 4; i++)
+        {
+            assert(batches[i].firstPacket == nextPacket && batches[i].packetCount == expectedCounts[i]);
+            nextPacket += batches[i].packetCount;
+        }
+        batches.clear();
+        buildBatches({}, [](uint32_t, uint32_t) { return true; }, batches);
+        assert(batches.empty());
+    }
+}
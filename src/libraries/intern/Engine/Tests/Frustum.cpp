@@ -0,0 +1,122 @@
+#include <Engine/Graphics/Culling/Frustum.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*
+    Culls boxes against a Vulkan style perspective frustum and checks known cases, that the vectorized path
+    matches the scalar one, and that no box containing a point inside the frustum ever gets culled
+*/
+
+using namespace Culling;
+
+namespace
+{
+    // column major, like glm::perspectiveRH_ZO with the y flip the Camera does, camera at the origin looking at -z
+    struct Matrix
+    {
+        float m[16] = {};
+    };
+
+    constexpr float nearPlane = 0.1f;
+    constexpr float farPlane = 100.0f;
+
+    Matrix perspective(float fov, float aspect)
+    {
+        const float f = 1.0f / std::tan(fov * 0.5f);
+        Matrix result;
+        result.m[0] = f / aspect;
+        result.m[5] = -f;
+        result.m[10] = farPlane / (nearPlane - farPlane);
+        result.m[11] = -1.0f;
+        result.m[14] = -(farPlane * nearPlane) / (farPlane - nearPlane);
+        return result;
+    }
+
+    // inside the clip volume after projecting
+    bool pointInside(const Matrix& projView, const float* p)
+    {
+        float clip[4];
+        for(int r = 0; r < 4; r++)
+        {
+            const float* m = projView.m;
+            clip[r] = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+        }
+        return std::abs(clip[0]) <= clip[3] && std::abs(clip[1]) <= clip[3] && clip[2] >= 0.0f &&
+               clip[2] <= clip[3];
+    }
+
+    Bounds::AABB box(float x, float y, float z, float size)
+    {
+        return {.min = {x - size, y - size, z - size}, .max = {x + size, y + size, z + size}};
+    }
+} // namespace
+
+int main()
+{
+    const Matrix projView = perspective(1.0f, 16.0f / 9.0f);
+    const Frustum frustum = extractFrustum(projView.m);
+
+    assert(isVisible(frustum, box(0.0f, 0.0f, -5.0f, 1.0f)));
+    // behind the camera
+    assert(!isVisible(frustum, box(0.0f, 0.0f, 5.0f, 1.0f)));
+    // beyond the far plane
+    assert(!isVisible(frustum, box(0.0f, 0.0f, -150.0f, 1.0f)));
+    // far to the side or above
+    assert(!isVisible(frustum, box(50.0f, 0.0f, -5.0f, 1.0f)));
+    assert(!isVisible(frustum, box(0.0f, -50.0f, -5.0f, 1.0f)));
+    // around the camera, crossing the near plane
+    assert(isVisible(frustum, box(0.0f, 0.0f, 0.0f, 1.0f)));
+    assert(!isVisible(frustum, Bounds::AABB{}));
+
+    std::mt19937 rng{11};
+    std::uniform_real_distribution<float> position{-60.0f, 60.0f};
+    std::uniform_real_distribution<float> size{0.01f, 5.0f};
+    std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+    for(const size_t count : {0, 1, 3, 4, 7, 1000})
+    {
+        std::vector<Bounds::AABB> boxes;
+        for(size_t i = 0; i < count; i++)
+        {
+            // some empty ones inbetween
+            if(i % 97 == 13)
+                boxes.push_back({});
+            else
+                boxes.push_back(box(position(rng), position(rng), position(rng) - 40.0f, size(rng)));
+        }
+
+        std::vector<uint32_t> visible(count);
+        const uint32_t visibleCount = cullAABBs(frustum, boxes, 100, visible.data());
+        std::vector<uint32_t> expected;
+        for(size_t i = 0; i < count; i++)
+        {
+            if(isVisible(frustum, boxes[i]))
+                expected.push_back(uint32_t(i) + 100);
+        }
+        assert(visibleCount == expected.size());
+        for(uint32_t i = 0; i < visibleCount; i++)
+            assert(visible[i] == expected[i]);
+
+        // conservative
+        for(size_t i = 0; i < count; i++)
+        {
+            const Bounds::AABB& b = boxes[i];
+            if(b.isEmpty())
+                continue;
+            for(int s = 0; s < 32; s++)
+            {
+                const float p[3] = {
+                    b.min[0] + (b.max[0] - b.min[0]) * unit(rng),
+                    b.min[1] + (b.max[1] - b.min[1]) * unit(rng),
+                    b.min[2] + (b.max[2] - b.min[2]) * unit(rng)};
+                if(pointInside(projView, p))
+                    assert(isVisible(frustum, b));
+            }
+        }
+        if(count == 1000)
+            printf("%u of %zu boxes visible\n", visibleCount, count);
+    }
+}
@@ -0,0 +1,168 @@
+#include "TestMeshes.hpp"
+#include <Engine/Graphics/Mesh/MeshOptimize.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/*
+    Runs the passes on a shuffled grid and a sphere like mesh, checks that the result still describes the same
+    triangles and prints the cache statistics before and after
+*/
+
+using namespace MeshOptimize;
+using namespace TestMeshes;
+
+namespace
+{
+    void shuffleTriangles(std::vector<uint32_t>& indices, std::mt19937& rng)
+    {
+        const size_t triangleCount = indices.size() / 3;
+        for(size_t t = triangleCount - 1; t > 0; t--)
+        {
+            const size_t other = rng() % (t + 1);
+            for(int k = 0; k < 3; k++)
+                std::swap(indices[t * 3 + k], indices[other * 3 + k]);
+        }
+    }
+
+    // triangles as sorted (by first vertex position) lists, independent of order and rotation
+    std::vector<std::array<float, 9>>
+    canonicalTriangles(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+    {
+        std::vector<std::array<float, 9>> triangles;
+        for(size_t t = 0; t < indices.size(); t += 3)
+        {
+            std::array<std::array<float, 3>, 3> corners;
+            for(int k = 0; k < 3; k++)
+            {
+                const Vertex& v = vertices[indices[t + k]];
+                corners[k] = {v.position[0], v.position[1], v.position[2]};
+            }
+            // rotate the smallest corner to the front, keeps the winding
+            const int first = int(std::min_element(corners.begin(), corners.end()) - corners.begin());
+            std::array<float, 9> triangle;
+            for(int k = 0; k < 3; k++)
+            {
+                for(int c = 0; c < 3; c++)
+                    triangle[k * 3 + c] = corners[(first + k) % 3][c];
+            }
+            triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    void printStats(const char* name, const TestMesh& mesh)
+    {
+        const VertexCacheStats cache =
+            analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+        const VertexFetchStats fetch =
+            analyzeVertexFetch(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size(), sizeof(Vertex));
+        printf("%-28s ACMR %5.3f  ATVR %5.3f  overfetch %5.3f\n", name, cache.acmr, cache.atvr, fetch.overfetch);
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 rng{3};
+
+    // stats of known orders
+    {
+        const uint32_t triangle[3] = {0, 1, 2};
+        const VertexCacheStats stats = analyzeVertexCache(triangle, 3, 3);
+        assert(stats.vertexShaderInvocations == 3 && stats.acmr == 3.0f && stats.atvr == 1.0f);
+    }
+
+    TestMesh mesh = makeGrid(100, {.bump = 0.01f});
+    shuffleTriangles(mesh.indices, rng);
+    const auto expectedTriangles = canonicalTriangles(mesh.vertices, mesh.indices);
+    const VertexCacheStats shuffled =
+        analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    printStats("shuffled grid", mesh);
+
+    // vertex cache
+    TestMesh cacheOptimized = mesh;
+    optimizeVertexCache(
+        cacheOptimized.indices.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertices.size());
+    assert(canonicalTriangles(cacheOptimized.vertices, cacheOptimized.indices) == expectedTriangles);
+    const VertexCacheStats optimized =
+        analyzeVertexCache(cacheOptimized.indices.data(), cacheOptimized.indices.size(), mesh.vertices.size());
+    printStats("+ vertex cache", cacheOptimized);
+    assert(optimized.acmr < shuffled.acmr * 0.5f);
+    assert(optimized.acmr < 0.8f);
+
+    // overdraw, allowed to get at most a bit worse
+    TestMesh overdrawOptimized = cacheOptimized;
+    optimizeOverdraw(
+        overdrawOptimized.indices.data(),
+        cacheOptimized.indices.data(),
+        cacheOptimized.indices.size(),
+        mesh.positions.data(),
+        sizeof(float) * 3,
+        mesh.vertices.size(),
+        1.05f);
+    assert(canonicalTriangles(overdrawOptimized.vertices, overdrawOptimized.indices) == expectedTriangles);
+    printStats("+ overdraw", overdrawOptimized);
+    const VertexCacheStats afterOverdraw = analyzeVertexCache(
+        overdrawOptimized.indices.data(), overdrawOptimized.indices.size(), mesh.vertices.size());
+    assert(afterOverdraw.acmr <= optimized.acmr * 1.1f);
+
+    // vertex fetch
+    TestMesh fetchOptimized = overdrawOptimized;
+    std::vector<uint32_t> remap(mesh.vertices.size());
+    generateVertexFetchRemap(
+        remap.data(), fetchOptimized.indices.data(), fetchOptimized.indices.size(), remap.size());
+    remapIndices(fetchOptimized.indices.data(), fetchOptimized.indices.size(), remap.data());
+    remapVertices(
+        reinterpret_cast<std::byte*>(fetchOptimized.vertices.data()),
+        reinterpret_cast<const std::byte*>(overdrawOptimized.vertices.data()),
+        sizeof(Vertex),
+        remap.data(),
+        remap.size());
+    assert(canonicalTriangles(fetchOptimized.vertices, fetchOptimized.indices) == expectedTriangles);
+    printStats("+ vertex fetch", fetchOptimized);
+    const VertexFetchStats fetchBefore = analyzeVertexFetch(
+        overdrawOptimized.indices.data(), overdrawOptimized.indices.size(), mesh.vertices.size(), sizeof(Vertex));
+    const VertexFetchStats fetchAfter = analyzeVertexFetch(
+        fetchOptimized.indices.data(), fetchOptimized.indices.size(), mesh.vertices.size(), sizeof(Vertex));
+    assert(fetchAfter.overfetch < fetchBefore.overfetch);
+
+    // everything at once, in place
+    {
+        TestMesh combined = mesh;
+        std::vector<std::byte> attributes(combined.vertices.size() * sizeof(float) * 2);
+        for(size_t v = 0; v < combined.vertices.size(); v++)
+            std::memcpy(&attributes[v * 8], combined.vertices[v].uv, 8);
+        optimize(
+            Options{},
+            combined.indices,
+            {reinterpret_cast<std::byte*>(combined.positions.data()), combined.positions.size() * sizeof(float)},
+            attributes,
+            sizeof(float) * 2);
+        for(size_t v = 0; v < combined.vertices.size(); v++)
+        {
+            std::memcpy(combined.vertices[v].position, &combined.positions[v * 3], 12);
+            std::memcpy(combined.vertices[v].uv, &attributes[v * 8], 8);
+            // uvs are derived from the positions, so they have to move together
+            assert(std::abs(combined.vertices[v].uv[0] * 100.0f - combined.vertices[v].position[0]) < 0.001f);
+        }
+        assert(canonicalTriangles(combined.vertices, combined.indices) == expectedTriangles);
+        printStats("all passes", combined);
+    }
+
+    // degenerate inputs
+    optimizeVertexCache(nullptr, nullptr, 0, 0);
+    {
+        // unused vertices end up behind the used ones
+        const uint32_t indices[3] = {3, 1, 3};
+        uint32_t fetchRemap[4];
+        generateVertexFetchRemap(fetchRemap, indices, 3, 4);
+        assert(fetchRemap[3] == 0 && fetchRemap[1] == 1 && fetchRemap[0] == 2 && fetchRemap[2] == 3);
+    }
+}
@@ -0,0 +1,170 @@
+#include "TestMeshes.hpp"
+#include <Engine/Graphics/Mesh/Meshlets.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+/*
+    Builds meshlets for a shuffled grid and a sphere and checks the limits, that every triangle ends up in
+    exactly one meshlet, that the spheres contain their vertices and that the cones only cull backfacing triangles
+*/
+
+using namespace Meshlets;
+using namespace TestMeshes;
+
+namespace
+{
+    void shuffleTriangles(std::vector<uint32_t>& indices)
+    {
+        std::vector<uint32_t> order(indices.size() / 3);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937{7});
+        std::vector<uint32_t> shuffled;
+        for(const uint32_t t : order)
+            shuffled.insert(shuffled.end(), {indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2]});
+        indices = shuffled;
+    }
+
+    MeshletData buildFor(const TestMesh& mesh, uint32_t maxVertices, uint32_t maxTriangles)
+    {
+        return build(
+            mesh.indices.data(),
+            mesh.indices.size(),
+            mesh.positions.data(),
+            sizeof(float) * 3,
+            mesh.positions.size() / 3,
+            maxVertices,
+            maxTriangles);
+    }
+
+    std::array<float, 3> position(const TestMesh& mesh, uint32_t vertex)
+    {
+        return {mesh.positions[vertex * 3], mesh.positions[vertex * 3 + 1], mesh.positions[vertex * 3 + 2]};
+    }
+
+    void check(const TestMesh& mesh, const MeshletData& data, uint32_t maxVertices, uint32_t maxTriangles)
+    {
+        std::vector<std::array<uint32_t, 3>> expected;
+        for(size_t i = 0; i < mesh.indices.size(); i += 3)
+            expected.push_back({mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]});
+        std::vector<std::array<uint32_t, 3>> actual;
+
+        float averageTriangles = 0.0f;
+        for(const Meshlet& meshlet : data.meshlets)
+        {
+            assert(meshlet.vertexCount <= maxVertices);
+            assert(meshlet.triangleCount <= maxTriangles && meshlet.triangleCount > 0);
+            assert(meshlet.vertexOffset + meshlet.vertexCount <= data.vertices.size());
+            assert(meshlet.triangleOffset + meshlet.triangleCount <= data.triangles.size());
+            averageTriangles += float(meshlet.triangleCount);
+
+            const Bounds& b = meshlet.bounds;
+            for(uint32_t i = 0; i < meshlet.vertexCount; i++)
+            {
+                const auto p = position(mesh, data.vertices[meshlet.vertexOffset + i]);
+                const float d = std::hypot(p[0] - b.center[0], p[1] - b.center[1], p[2] - b.center[2]);
+                assert(d <= b.radius * 1.0001f + 1e-5f);
+            }
+
+            for(uint32_t t = 0; t < meshlet.triangleCount; t++)
+            {
+                uint32_t local[3];
+                unpackTriangle(data.triangles[meshlet.triangleOffset + t], local);
+                std::array<uint32_t, 3> triangle;
+                for(int k = 0; k < 3; k++)
+                {
+                    assert(local[k] < meshlet.vertexCount);
+                    triangle[k] = data.vertices[meshlet.vertexOffset + local[k]];
+                }
+                actual.push_back(triangle);
+            }
+        }
+        // winding has to be preserved, so compare the triangles as they are
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        assert(expected == actual);
+
+        printf(
+            "%zu triangles -> %zu meshlets, %.1f triangles per meshlet\n",
+            expected.size(),
+            data.meshlets.size(),
+            averageTriangles / float(data.meshlets.size()));
+    }
+
+    // every triangle of a meshlet the cone test culls has to face away from the camera
+    uint32_t checkCones(const TestMesh& mesh, const MeshletData& data)
+    {
+        std::mt19937 rng{3};
+        std::uniform_real_distribution<float> dist{-4.0f, 4.0f};
+        uint32_t culled = 0;
+        for(int c = 0; c < 64; c++)
+        {
+            const float camera[3] = {dist(rng), dist(rng), dist(rng)};
+            for(const Meshlet& meshlet : data.meshlets)
+            {
+                if(!isBackfacing(meshlet.bounds, camera))
+                    continue;
+                culled++;
+                for(uint32_t t = 0; t < meshlet.triangleCount; t++)
+                {
+                    uint32_t local[3];
+                    unpackTriangle(data.triangles[meshlet.triangleOffset + t], local);
+                    const auto p0 = position(mesh, data.vertices[meshlet.vertexOffset + local[0]]);
+                    const auto p1 = position(mesh, data.vertices[meshlet.vertexOffset + local[1]]);
+                    const auto p2 = position(mesh, data.vertices[meshlet.vertexOffset + local[2]]);
+                    const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                    const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+                    const float n[3] = {
+                        e1[1] * e2[2] - e1[2] * e2[1],
+                        e1[2] * e2[0] - e1[0] * e2[2],
+                        e1[0] * e2[1] - e1[1] * e2[0]};
+                    const float toCamera[3] = {camera[0] - p0[0], camera[1] - p0[1], camera[2] - p0[2]};
+                    assert(n[0] * toCamera[0] + n[1] * toCamera[1] + n[2] * toCamera[2] <= 1e-4f);
+                }
+            }
+        }
+        return culled;
+    }
+} // namespace
+
+int main()
+{
+    {
+        TestMesh grid = makeGrid(64);
+        shuffleTriangles(grid.indices);
+        const MeshletData data = buildFor(grid, defaultMaxVertices, defaultMaxTriangles);
+        check(grid, data, defaultMaxVertices, defaultMaxTriangles);
+        // even from a random order the meshlets should stay compact, an 8x8 vertex patch has 98 triangles
+        assert(float(grid.indices.size() / 3) / float(data.meshlets.size()) > 60.0f);
+
+        // flat grid facing +z: culled from below, never from above
+        for(const Meshlet& meshlet : data.meshlets)
+        {
+            const float below[3] = {32.0f, 32.0f, -10.0f};
+            const float above[3] = {32.0f, 32.0f, 10.0f};
+            assert(isBackfacing(meshlet.bounds, below));
+            assert(!isBackfacing(meshlet.bounds, above));
+        }
+    }
+    {
+        const TestMesh sphere = makeSphere(32, 64);
+        const MeshletData data = buildFor(sphere, defaultMaxVertices, defaultMaxTriangles);
+        check(sphere, data, defaultMaxVertices, defaultMaxTriangles);
+        const uint32_t culled = checkCones(sphere, data);
+        assert(culled > 0);
+        printf("cone culled %u meshlets over 64 cameras\n", culled);
+    }
+    {
+        // small limits
+        const TestMesh sphere = makeSphere(8, 16);
+        const MeshletData data = buildFor(sphere, 3, 1);
+        check(sphere, data, 3, 1);
+        assert(data.meshlets.size() == sphere.indices.size() / 3);
+    }
+}
@@ -0,0 +1,161 @@
+#include "TestMeshes.hpp"
+#include <Engine/Graphics/Mesh/Simplify.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+/*
+    Simplifies grids and a sphere and checks that the results are valid triangle lists, that locked borders and
+    flat regions keep their shape, that attributes limit the simplification, and that LOD chains are ordered
+*/
+
+using namespace Simplify;
+using namespace TestMeshes;
+
+namespace
+{
+    Attributes uvAttributes(const TestMesh& mesh, float weight)
+    {
+        Attributes attributes{.data = mesh.vertices[0].uv, .stride = sizeof(Vertex), .count = 2};
+        attributes.components[1] = 1;
+        attributes.weights[0] = weight;
+        attributes.weights[1] = weight;
+        return attributes;
+    }
+
+    std::vector<uint32_t>
+    run(const TestMesh& mesh, const Attributes& attributes, const Options& options, float* error)
+    {
+        std::vector<uint32_t> result(mesh.indices.size());
+        const size_t count = simplify(
+            result.data(),
+            mesh.indices.data(),
+            mesh.indices.size(),
+            mesh.vertices[0].position,
+            sizeof(Vertex),
+            mesh.vertices.size(),
+            attributes,
+            options,
+            error);
+        result.resize(count);
+
+        assert(count % 3 == 0);
+        for(size_t i = 0; i < count; i += 3)
+        {
+            assert(result[i] < mesh.vertices.size());
+            assert(result[i] != result[i + 1] && result[i + 1] != result[i + 2] && result[i] != result[i + 2]);
+        }
+        return result;
+    }
+
+    // signed area of all triangles projected onto the xy plane
+    float projectedArea(const TestMesh& mesh, const std::vector<uint32_t>& indices)
+    {
+        float area = 0.0f;
+        for(size_t i = 0; i < indices.size(); i += 3)
+        {
+            const float* a = mesh.vertices[indices[i]].position;
+            const float* b = mesh.vertices[indices[i + 1]].position;
+            const float* c = mesh.vertices[indices[i + 2]].position;
+            const float z = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+            // no flipped triangles
+            assert(z > 0.0f);
+            area += z * 0.5f;
+        }
+        return area;
+    }
+} // namespace
+
+int main()
+{
+    constexpr uint32_t gridSize = 32;
+    {
+        // a flat grid can be simplified without error, locked borders keep all their vertices
+        const TestMesh grid = makeGrid(gridSize);
+        float error = 1.0f;
+        const std::vector<uint32_t> result =
+            run(grid, {}, Options{.targetIndexCount = 0, .targetError = 1e-3f, .lockBorder = true}, &error);
+        assert(error < 1e-3f);
+        assert(std::abs(projectedArea(grid, result) - float(gridSize * gridSize)) < 1e-2f);
+        const std::set<uint32_t> used(result.begin(), result.end());
+        for(uint32_t i = 0; i <= gridSize; i++)
+        {
+            assert(used.contains(i));
+            assert(used.contains(gridSize * (gridSize + 1) + i));
+            assert(used.contains(i * (gridSize + 1)));
+            assert(used.contains(i * (gridSize + 1) + gridSize));
+        }
+        // only the border is left, connected to a few interior vertices
+        assert(used.size() < (gridSize + 1) * 4 + 8);
+        printf("grid, locked border: %zu -> %zu triangles\n", grid.indices.size() / 3, result.size() / 3);
+
+        // borders can slide along themselves, corners stay
+        const std::vector<uint32_t> unlocked =
+            run(grid, {}, Options{.targetIndexCount = 0, .targetError = 1e-3f, .lockBorder = false}, &error);
+        assert(unlocked.size() < result.size());
+        assert(std::abs(projectedArea(grid, unlocked) - float(gridSize * gridSize)) < 1e-2f);
+        printf("grid, free border: %zu -> %zu triangles\n", grid.indices.size() / 3, unlocked.size() / 3);
+    }
+    {
+        // the uv discontinuity has to stay
+        const TestMesh grid = makeGrid(gridSize, {.uvStep = true});
+        float error = 0.0f;
+        const Options options{.targetIndexCount = 0, .targetError = 1e-2f, .lockBorder = true};
+        const std::vector<uint32_t> withoutUVs = run(grid, {}, options, &error);
+        const std::vector<uint32_t> withUVs = run(grid, uvAttributes(grid, 1.0f), options, &error);
+        assert(withUVs.size() > withoutUVs.size());
+        // the jump stays as sharp as in the original: only triangles between the two middle columns cross it
+        for(size_t i = 0; i < withUVs.size(); i += 3)
+        {
+            float minX = INFINITY, maxX = -INFINITY, minU = INFINITY, maxU = -INFINITY;
+            for(int k = 0; k < 3; k++)
+            {
+                const Vertex& v = grid.vertices[withUVs[i + k]];
+                minX = std::min(minX, v.position[0]);
+                maxX = std::max(maxX, v.position[0]);
+                minU = std::min(minU, v.uv[0]);
+                maxU = std::max(maxU, v.uv[0]);
+            }
+            if(minU != maxU)
+                assert(minX == float(gridSize / 2) && maxX == float(gridSize / 2 + 1));
+        }
+        printf("uv step: %zu triangles without, %zu with uvs\n", withoutUVs.size() / 3, withUVs.size() / 3);
+    }
+    {
+        const TestMesh sphere = makeSphere(32, 64);
+        float error = 0.0f;
+        const size_t target = sphere.indices.size() / 4 / 3 * 3;
+        const std::vector<uint32_t> result = run(
+            sphere,
+            uvAttributes(sphere, 0.5f),
+            Options{.targetIndexCount = target, .targetError = 0.1f, .lockBorder = true},
+            &error);
+        assert(result.size() <= target);
+        assert(error > 0.0f && error < 0.2f);
+        printf("sphere: %zu -> %zu triangles, error %f\n", sphere.indices.size() / 3, result.size() / 3, error);
+
+        const std::vector<LOD> lods = generateLODs(
+            sphere.indices.data(),
+            sphere.indices.size(),
+            sphere.vertices[0].position,
+            sizeof(Vertex),
+            sphere.vertices.size(),
+            uvAttributes(sphere, 0.5f),
+            LODOptions{.maxLODs = 4, .reduction = 0.5f, .maxError = 0.1f});
+        assert(lods.size() == 3);
+        size_t previousCount = sphere.indices.size();
+        float previousError = 0.0f;
+        for(const LOD& lod : lods)
+        {
+            assert(lod.indices.size() < previousCount);
+            assert(lod.error >= previousError);
+            printf("  LOD: %zu triangles, error %f\n", lod.indices.size() / 3, lod.error);
+            previousCount = lod.indices.size();
+            previousError = lod.error;
+        }
+    }
+}
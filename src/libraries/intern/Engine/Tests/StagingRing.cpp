@@ -0,0 +1,113 @@
+#include <Engine/Graphics/Device/StagingRing.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <execution>
+#include <ranges>
+#include <vector>
+
+/*
+    Checks alignment, wrapping, running full and reclaiming, and that concurrent allocations never overlap
+*/
+
+namespace
+{
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    void checkNoOverlap(std::vector<Range>& ranges, size_t capacity)
+    {
+        std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) { return a.begin < b.begin; });
+        for(size_t i = 0; i < ranges.size(); i++)
+        {
+            assert(ranges[i].end <= capacity);
+            if(i > 0)
+                assert(ranges[i - 1].end <= ranges[i].begin);
+        }
+    }
+} // namespace
+
+int main()
+{
+    constexpr size_t capacity = 4096;
+
+    // alignment and running full
+    {
+        StagingRing ring;
+        ring.init(capacity);
+        assert(ring.allocate(3, 1) == 0);
+        assert(ring.allocate(8, 16) == 16);
+        assert(ring.allocate(100, 256) == 256);
+        assert(ring.allocate(capacity + 1, 4) == StagingRing::NoSpace);
+        // 356 used, so the next 3840 bytes dont fit anymore
+        assert(ring.allocate(3740, 4) == 356);
+        assert(ring.allocate(1, 1) == StagingRing::NoSpace);
+        assert(ring.getUsedSize() == capacity);
+    }
+
+    // frames: everything before a release point gets reused, allocations skip to the start instead of wrapping
+    {
+        StagingRing ring;
+        ring.init(capacity);
+        const size_t first = ring.allocate(1500, 16);
+        const uint64_t frame0End = ring.getHead();
+        const size_t second = ring.allocate(1500, 16);
+        const uint64_t frame1End = ring.getHead();
+        assert(first == 0 && second == 1504);
+        // would cross the end of the buffer, and the start is still in use by frame 0
+        assert(ring.allocate(1500, 16) == StagingRing::NoSpace);
+
+        ring.release(frame0End);
+        assert(ring.allocate(1500, 16) == 0);
+        // the skipped end of the buffer counts as used as well, until the allocation that skipped it is released
+        assert(ring.getUsedSize() == capacity);
+        assert(ring.allocate(1, 1) == StagingRing::NoSpace);
+        ring.release(frame1End);
+        assert(ring.allocate(1, 1) == 1500);
+        assert(ring.getUsedSize() == (capacity - 3004) + 1501);
+        ring.release(ring.getHead());
+        assert(ring.getUsedSize() == 0);
+        assert(ring.allocate(capacity / 2, 256) == 1536);
+    }
+
+    // many threads allocating at once, over multiple "frames"
+    {
+        constexpr size_t bigCapacity = 1 << 20;
+        StagingRing ring;
+        ring.init(bigCapacity);
+        constexpr uint32_t jobCount = 64;
+        constexpr uint32_t allocationsPerJob = 200;
+        for(int frame = 0; frame < 10; frame++)
+        {
+            std::vector<std::vector<Range>> jobRanges(jobCount);
+            std::ranges::iota_view jobs(0u, jobCount);
+            std::for_each(
+                std::execution::par,
+                jobs.begin(),
+                jobs.end(),
+                [&](uint32_t job)
+                {
+                    for(uint32_t i = 0; i < allocationsPerJob; i++)
+                    {
+                        const size_t size = 1 + (job * 131 + i * 17 + frame) % 61;
+                        const size_t alignment = size_t(1) << ((job + i) % 9);
+                        const size_t offset = ring.allocate(size, alignment);
+                        // 64 * 200 * 61 is below the capacity, so everything fits
+                        assert(offset != StagingRing::NoSpace);
+                        assert(offset % alignment == 0);
+                        jobRanges[job].push_back({offset, offset + size});
+                    }
+                });
+            std::vector<Range> ranges;
+            for(const std::vector<Range>& r : jobRanges)
+                ranges.insert(ranges.end(), r.begin(), r.end());
+            checkNoOverlap(ranges, bigCapacity);
+            ring.release(ring.getHead());
+        }
+        printf("concurrent allocations ok\n");
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/*
+    Procedural meshes shared by the mesh processing tests
+    Every vertex is stored twice: tightly packed positions for the functions that only take those, and interleaved
+    with a uv set for the ones that get a stride or look at attributes
+*/
+namespace TestMeshes
+{
+    struct Vertex
+    {
+        float position[3];
+        float uv[2];
+    };
+
+    struct TestMesh
+    {
+        // xyz per vertex, same as Vertex::position
+        std::vector<float> positions;
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+
+        void addVertex(float x, float y, float z, float u, float v)
+        {
+            positions.insert(positions.end(), {x, y, z});
+            vertices.push_back({{x, y, z}, {u, v}});
+        }
+    };
+
+    // two triangles per quad of a (columns + 1) wide vertex grid, with the same winding for every quad
+    inline void addQuadIndices(TestMesh& mesh, uint32_t columns, uint32_t rows)
+    {
+        for(uint32_t y = 0; y < rows; y++)
+        {
+            for(uint32_t x = 0; x < columns; x++)
+            {
+                const uint32_t i = y * (columns + 1) + x;
+                const uint32_t above = i + columns + 1;
+                mesh.indices.insert(mesh.indices.end(), {i, i + 1, above, i + 1, above + 1, above});
+            }
+        }
+    }
+
+    struct GridOptions
+    {
+        // z = (x - size / 2)^2 * bump, so the normals arent all the same
+        float bump = 0.0f;
+        // uv.x jumps from 0 to 1 in the middle instead of going from 0 to 1 across the grid
+        bool uvStep = false;
+    };
+
+    // size x size quads in the xy plane facing +z, position = (x, y), uv = position / size
+    inline TestMesh makeGrid(uint32_t size, const GridOptions& options = {})
+    {
+        TestMesh mesh;
+        const float half = float(size) * 0.5f;
+        for(uint32_t y = 0; y <= size; y++)
+        {
+            for(uint32_t x = 0; x <= size; x++)
+            {
+                const float px = float(x);
+                const float py = float(y);
+                const float u = options.uvStep ? (x <= size / 2 ? 0.0f : 1.0f) : px / float(size);
+                mesh.addVertex(px, py, (px - half) * (px - half) * options.bump, u, py / float(size));
+            }
+        }
+        addQuadIndices(mesh, size, size);
+        return mesh;
+    }
+
+    // unit uv sphere, with the usual duplicated seam column and pole vertices
+    inline TestMesh makeSphere(uint32_t rings, uint32_t segments)
+    {
+        TestMesh mesh;
+        constexpr float pi = 3.14159265f;
+        for(uint32_t r = 0; r <= rings; r++)
+        {
+            const float theta = pi * float(r) / float(rings);
+            for(uint32_t s = 0; s <= segments; s++)
+            {
+                const float phi = 2.0f * pi * float(s) / float(segments);
+                mesh.addVertex(
+                    std::sin(theta) * std::cos(phi),
+                    std::cos(theta),
+                    std::sin(theta) * std::sin(phi),
+                    float(s) / float(segments),
+                    float(r) / float(rings));
+            }
+        }
+        addQuadIndices(mesh, segments, rings);
+        return mesh;
+    }
+} // namespace TestMeshes
@@ -0,0 +1,73 @@
+#include <Engine/Graphics/Mesh/VertexQuantization.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace VertexQuantization;
+
+int main()
+{
+    std::mt19937 rng{99};
+    std::uniform_real_distribution<float> unit{-1.0f, 1.0f};
+
+    // octahedral normals, including the axes and the folded lower hemisphere
+    const float axes[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for(const auto& axis : axes)
+    {
+        float decoded[3];
+        decodeOctahedral16(encodeOctahedral16(axis[0], axis[1], axis[2]), decoded);
+        for(int c = 0; c < 3; c++)
+            assert(std::abs(decoded[c] - axis[c]) < 1e-4f);
+    }
+    float maxAngleError = 0.0f;
+    for(int i = 0; i < 100000; i++)
+    {
+        float n[3] = {unit(rng), unit(rng), unit(rng)};
+        const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if(length < 1e-3f)
+            continue;
+        for(float& c : n)
+            c /= length;
+        float decoded[3];
+        decodeOctahedral16(encodeOctahedral16(n[0], n[1], n[2]), decoded);
+        // angle through the cross product, acos of the dot product is too imprecise this close to 1
+        const double cx = double(n[1]) * decoded[2] - double(n[2]) * decoded[1];
+        const double cy = double(n[2]) * decoded[0] - double(n[0]) * decoded[2];
+        const double cz = double(n[0]) * decoded[1] - double(n[1]) * decoded[0];
+        maxAngleError = std::max(maxAngleError, float(std::asin(std::sqrt(cx * cx + cy * cy + cz * cz))));
+    }
+    // 16 bit octahedral is good to roughly 0.004 degrees
+    assert(maxAngleError < 1e-4f);
+
+    // half floats
+    assert(floatToHalf(0.0f) == 0x0000);
+    assert(floatToHalf(-0.0f) == 0x8000);
+    assert(floatToHalf(1.0f) == 0x3C00);
+    assert(floatToHalf(-2.0f) == 0xC000);
+    assert(floatToHalf(65504.0f) == 0x7BFF);
+    assert(floatToHalf(65536.0f) == 0x7C00);
+    assert(floatToHalf(INFINITY) == 0x7C00);
+    assert((floatToHalf(NAN) & 0x7FFF) > 0x7C00);
+    // smallest denormal, and ties to even on both sides of it
+    assert(floatToHalf(std::ldexp(1.0f, -24)) == 0x0001);
+    assert(floatToHalf(std::ldexp(1.0f, -25)) == 0x0000);
+    assert(floatToHalf(std::ldexp(3.0f, -25)) == 0x0002);
+    // 1 + 2^-11 is exactly between 1 and the next half, rounds to the even one
+    assert(floatToHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3C00);
+    assert(floatToHalf(1.0f + std::ldexp(3.0f, -11)) == 0x3C02);
+    // every half survives the round trip
+    for(uint32_t h = 0; h < 0x10000; h++)
+    {
+        const float f = halfToFloat(uint16_t(h));
+        if(std::isnan(f))
+            continue;
+        assert(floatToHalf(f) == h);
+    }
+
+    // unorm
+    assert(encodeUNorm16(0.0f) == 0 && encodeUNorm16(1.0f) == 65535 && encodeUNorm16(2.0f) == 65535);
+    assert(encodeUNorm16(-1.0f) == 0 && encodeUNorm16(0.5f) == 32768);
+    assert(encodeRGBA8(1.0f, 0.0f, 0.5f, 1.0f) == 0xFF8000FF);
+}
@@ -0,0 +1,88 @@
+#include <Engine/Graphics/Mesh/VertexWeld.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace VertexWeld;
+
+int main()
+{
+    // quad made out of two triangles with un-shared corners, position + uv in separate streams
+    {
+        const float positions[6][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+        const float uvs[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+        const Stream streams[2] = {
+            {.data = reinterpret_cast<const std::byte*>(positions), .size = sizeof(positions[0])},
+            {.data = reinterpret_cast<const std::byte*>(uvs), .size = sizeof(uvs[0])},
+        };
+        uint32_t remap[6];
+        const uint32_t unique = generateRemap(remap, streams, 6);
+        assert(unique == 4);
+        const uint32_t expected[6] = {0, 1, 2, 0, 2, 3};
+        assert(std::memcmp(remap, expected, sizeof(remap)) == 0);
+
+        float welded[4][3];
+        remapVertices(
+            reinterpret_cast<std::byte*>(welded),
+            reinterpret_cast<const std::byte*>(positions),
+            sizeof(positions[0]),
+            0,
+            remap,
+            6);
+        for(int i = 0; i < 6; i++)
+            assert(std::memcmp(welded[remap[i]], positions[i], sizeof(positions[0])) == 0);
+
+        // a differing second stream keeps the vertices apart
+        const float seamUVs[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0.5f, 0}, {1, 1}, {0, 1}};
+        const Stream seamStreams[2] = {
+            streams[0],
+            {.data = reinterpret_cast<const std::byte*>(seamUVs), .size = sizeof(seamUVs[0])},
+        };
+        assert(generateRemap(remap, seamStreams, 6) == 5);
+    }
+
+    // random interleaved vertices with lots of duplicates, strided stream
+    {
+        struct Vertex
+        {
+            int32_t a, b, c;
+            uint16_t d;
+            uint16_t padding;
+        };
+        std::mt19937 rng{7};
+        constexpr size_t count = 10000;
+        std::vector<Vertex> vertices(count);
+        for(Vertex& v : vertices)
+            v = {int32_t(rng() % 10), int32_t(rng() % 10), 0, uint16_t(rng() % 5), uint16_t(rng())};
+
+        // padding differs between duplicates, only compare a, b, c and d
+        const Stream streams[2] = {
+            {.data = reinterpret_cast<const std::byte*>(vertices.data()), .size = 12, .stride = sizeof(Vertex)},
+            {.data = reinterpret_cast<const std::byte*>(&vertices[0].d), .size = 2, .stride = sizeof(Vertex)},
+        };
+        std::vector<uint32_t> remap(count);
+        const uint32_t unique = generateRemap(remap.data(), streams, count);
+        assert(unique == 10 * 10 * 5);
+
+        std::vector<Vertex> welded(unique);
+        remapVertices(
+            reinterpret_cast<std::byte*>(welded.data()),
+            reinterpret_cast<const std::byte*>(vertices.data()),
+            sizeof(Vertex),
+            0,
+            remap.data(),
+            count);
+        for(size_t i = 0; i < count; i++)
+        {
+            const Vertex& v = welded[remap[i]];
+            assert(v.a == vertices[i].a && v.b == vertices[i].b && v.d == vertices[i].d);
+        }
+        for(uint32_t i = 0; i < unique; i++)
+        {
+            for(uint32_t j = i + 1; j < unique; j++)
+                assert(welded[i].a != welded[j].a || welded[i].b != welded[j].b || welded[i].d != welded[j].d);
+        }
+    }
+}
@@ -17,12 +17,11 @@ struct VSOutput
 
 VSOutput main(VSInput input)
 {
-    const InstanceInfo instanceInfo = getInstanceInfo(input.baseInstance);
+    const int instanceIndex = getInstanceIndex(input.instanceID);
+    const InstanceInfo instanceInfo = getInstanceInfo(instanceIndex);
     const MeshData meshData = getMeshDataBuffer()[instanceInfo.meshDataIndex];
 
     const StructuredBuffer<uint> indexBuffer = meshData.indexBuffer.get();
-    const StructuredBuffer<float3> vertexPositions = meshData.positionBuffer.get();
-
     const ByteAddressBuffer vertexAttributes = meshData.attributesBuffer.get();
 
     // ConstantBuffer<RenderPassData> renderPassData = shaderInputs.renderPassData.get();
@@ -34,22 +33,22 @@ VSOutput main(VSInput input)
     // const mat4 transformMatrix = getBuffer(RenderPassData, bindlessIndices.renderPassDataBuffer).projView * modelMatrix;
 
     VSOutput vsOut = (VSOutput)0;
-    vsOut.baseInstance = input.baseInstance;
+    vsOut.baseInstance = instanceIndex;
 
     uint vertexIndex = indexBuffer[input.vertexID];
-    const float3 vertPos = vertexPositions[vertexIndex];
-    float4 worldPos = mul(instanceInfo.transform, float4(vertPos,1.0));
+    const float3 vertPos = meshData.loadPosition(vertexIndex);
+    float4 worldPos = instanceInfo.transformPoint(vertPos);
 
     vsOut.vPositionWS = worldPos.xyz;
     vsOut.posOut = mul(projViewMatrix, worldPos);
 
-    vsOut.vColor = vertexAttributes.Load<float3>(vertexIndex * meshData.attribStride() + meshData.colorOffset());
-    vsOut.vTexCoord0 = vertexAttributes.Load<float2>(vertexIndex * meshData.attribStride() + meshData.uvOffset(0));
-    vsOut.vTexCoord1 = vertexAttributes.Load<float2>(vertexIndex * meshData.attribStride() + meshData.uvOffset(1));
-    vsOut.vTexCoord2 = vertexAttributes.Load<float2>(vertexIndex * meshData.attribStride() + meshData.uvOffset(2));
+    vsOut.vColor = meshData.loadColor(vertexAttributes, vertexIndex);
+    vsOut.vTexCoord0 = meshData.loadUV(vertexAttributes, vertexIndex, 0);
+    vsOut.vTexCoord1 = meshData.loadUV(vertexAttributes, vertexIndex, 1);
+    vsOut.vTexCoord2 = meshData.loadUV(vertexAttributes, vertexIndex, 2);
 
-    const float3x3 invTranspModelMatrix3 = (float3x3)(instanceInfo.invTranspTransform);
-    const float3 vNormal = vertexAttributes.Load<float3>(vertexIndex * meshData.attribStride());
+    const float3x3 invTranspModelMatrix3 = instanceInfo.normalMatrix();
+    const float3 vNormal = meshData.loadNormal(vertexAttributes, vertexIndex);
     vsOut.vNormalWS = normalize(mul(invTranspModelMatrix3, vNormal));
 
     return vsOut;
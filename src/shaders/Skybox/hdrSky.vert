@@ -10,19 +10,18 @@ struct VSOutput
 
 VSOutput main(VSInput input)
 {
-    const InstanceInfo instanceInfo = getInstanceInfo(input.baseInstance);
+    const int instanceIndex = getInstanceIndex(input.instanceID);
+    const InstanceInfo instanceInfo = getInstanceInfo(instanceIndex);
     const MeshData meshData = getMeshData(instanceInfo);
 
     const StructuredBuffer<uint> indexBuffer = meshData.indexBuffer.get();
-    const StructuredBuffer<float3> vertexPositions = meshData.positionBuffer.get();
-    const ByteAddressBuffer vertexAttributes = meshData.attributesBuffer.get();
     
     uint vertexIndex = indexBuffer[input.vertexID];
 
     VSOutput vsOut = (VSOutput)0;
-    vsOut.instanceIndex = input.baseInstance;
+    vsOut.instanceIndex = instanceIndex;
 
-    const float3 vertPos = vertexPositions[vertexIndex];
+    const float3 vertPos = meshData.loadPosition(vertexIndex);
     //todo: dont just scale up by some large number, instead make forcing depth to 1.0 work!
     float4 worldPos = float4(500*vertPos,1.0);
 
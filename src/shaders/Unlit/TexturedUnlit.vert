@@ -15,14 +15,14 @@ struct VSOutput
 
 VSOutput main(VSInput input)
 {
-    const InstanceInfo instanceInfo = getInstanceInfo(input.baseInstance);
+    const int instanceIndex = getInstanceIndex(input.instanceID);
+    const InstanceInfo instanceInfo = getInstanceInfo(instanceIndex);
     const MeshData meshData = getMeshData(instanceInfo);
 
     VSOutput vsOut = (VSOutput)0;
-    vsOut.instanceIndex = input.baseInstance;
+    vsOut.instanceIndex = instanceIndex;
 
     const StructuredBuffer<uint> indexBuffer = meshData.indexBuffer.get();
-    const StructuredBuffer<float3> vertexPositions = meshData.positionBuffer.get();
     const ByteAddressBuffer vertexAttributes = meshData.attributesBuffer.get();
     
     uint vertexIndex = indexBuffer[input.vertexID];
@@ -35,10 +35,10 @@ VSOutput main(VSInput input)
     //todo: test mul-ing here already, like in GLSL version
     // const mat4 transformMatrix = getBuffer(RenderPassData, bindlessIndices.renderPassDataBuffer).projView * modelMatrix;
     
-    const float3 vertPos = vertexPositions[vertexIndex];
-    float4 worldPos = mul(instanceInfo.transform, float4(vertPos,1.0));
+    const float3 vertPos = meshData.loadPosition(vertexIndex);
+    float4 worldPos = instanceInfo.transformPoint(vertPos);
     vsOut.posOut = mul(projViewMatrix, worldPos);    
-    vsOut.vTexCoord = vertexAttributes.Load<float2>(vertexIndex * meshData.attribStride() + meshData.uvOffset(0));
+    vsOut.vTexCoord = meshData.loadUV(vertexAttributes, vertexIndex, 0);
 
     return vsOut;
 }
\ No newline at end of file
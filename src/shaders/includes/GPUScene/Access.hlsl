@@ -28,6 +28,12 @@ InstanceInfo getInstanceInfo(int instanceIndex)
     return getInstanceBuffer()[instanceIndex];
 }
 
+// instanceID: SV_InstanceID of the vertex shader
+int getInstanceIndex(uint instanceID)
+{
+    return pushConstants.instanceIndexBuffer.get()[instanceID];
+}
+
 ConstantBuffer<RenderPassData> getRenderPassData()
 {
     return pushConstants.renderPassData.get();
@@ -6,6 +6,7 @@
 
 ENABLE_BINDLESS_BUFFER_ACCESS(MeshData);
 ENABLE_BINDLESS_BUFFER_ACCESS(InstanceInfo);
+ENABLE_BINDLESS_BUFFER_ACCESS(Meshlet);
 
 #include "../CommonTypes.hlsl"
 ENABLE_BINDLESS_BUFFER_ACCESS(RenderPassData)
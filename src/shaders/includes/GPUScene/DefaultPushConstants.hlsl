@@ -11,6 +11,8 @@ struct DefaultPushConstants
     Handle< ConstantBuffer<RenderPassData> > renderPassData;
     // Buffer with information about all instances that are being rendered
     Handle< StructuredBuffer<InstanceInfo> > instanceBuffer;
+    // Index into instanceBuffer for every drawn instance, instanced draws cover a contiguous range of it
+    Handle< StructuredBuffer<uint> > instanceIndexBuffer;
 };
 
 [[vk::push_constant]]
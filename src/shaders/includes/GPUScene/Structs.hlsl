@@ -4,20 +4,88 @@
 #include "../VertexAttributes.hlsl"
 #include "../Bindless/Common.hlsl"
 
+// vertex encodings, see Mesh::VertexEncoding. 2 bits each in MeshData.encoding
+#define ENCODING_POSITION_FLOAT3 0
+#define ENCODING_POSITION_UNORM16 1
+#define ENCODING_NORMAL_FLOAT3 0
+#define ENCODING_NORMAL_OCT16 1
+#define ENCODING_COLOR_FLOAT3 0
+#define ENCODING_COLOR_RGBA8 1
+#define ENCODING_UV_FLOAT2 0
+#define ENCODING_UV_HALF2 1
+#define ENCODING_UV_UNORM16 2
+
+float3 decodeOctahedral16(uint encoded)
+{
+    // snorm16 -> [-1, 1]
+    const int2 snorm = int2(encoded << 16, encoded) >> 16;
+    float2 p = max(float2(snorm) / 32767.0, -1.0);
+    const float z = 1.0 - abs(p.x) - abs(p.y);
+    if(z < 0.0)
+        p = (1.0 - abs(p.yx)) * select(p >= 0.0, 1.0, -1.0);
+    return normalize(float3(p, z));
+}
+
+float2 unpackUNorm16x2(uint packed)
+{
+    return float2(packed & 0xFFFF, packed >> 16) / 65535.0;
+}
+
+// see Meshlets::Meshlet
+struct Meshlet
+{
+    uint vertexOffset;
+    uint triangleOffset;
+    uint vertexCount;
+    uint triangleCount;
+    float3 center;
+    float radius;
+    float3 coneApex;
+    float coneCutoff;
+    float3 coneAxis;
+
+    // all triangles face away from a camera at cameraPosition
+    bool isBackfacing(float3 cameraPosition)
+    {
+        return dot(normalize(coneApex - cameraPosition), coneAxis) >= coneCutoff;
+    }
+};
+
 struct MeshData
 {
     uint indexCount;
     uint additionalUVCount;
     Handle< StructuredBuffer<uint> > indexBuffer;
-    Handle< StructuredBuffer<float3> > positionBuffer;
+    Handle< ByteAddressBuffer > positionBuffer;
     Handle< ByteAddressBuffer > attributesBuffer;
+    uint encoding;
+    // value = offset + scale * unorm, only used by the UNORM16 encodings
+    float3 positionOffset;
+    float3 positionScale;
+    float2 uvOffset;
+    float2 uvScale;
+    uint meshletCount;
+    Handle< StructuredBuffer<Meshlet> > meshletBuffer;
+    Handle< StructuredBuffer<uint> > meshletVertexBuffer;
+    Handle< StructuredBuffer<uint> > meshletTriangleBuffer;
+    // object space
+    float3 aabbMin;
+    float3 aabbMax;
+    float3 sphereCenter;
+    float sphereRadius;
 
-    uint normalSize() { return sizeof(float3); }
+    uint positionEncoding() { return encoding & 3; }
+    uint normalEncoding() { return (encoding >> 2) & 3; }
+    uint colorEncoding() { return (encoding >> 4) & 3; }
+    uint uvEncoding() { return (encoding >> 6) & 3; }
+
+    uint normalSize() { return normalEncoding() == ENCODING_NORMAL_FLOAT3 ? sizeof(float3) : sizeof(uint); }
     uint normalOffset() { return 0; }
-    uint colorSize() { return sizeof(float3); }
+    uint colorSize() { return colorEncoding() == ENCODING_COLOR_FLOAT3 ? sizeof(float3) : sizeof(uint); }
     uint colorOffset() { return normalSize(); }
-    uint uvSize() { return sizeof(float2); }
-    uint uvOffset(uint i)
+    uint uvSize() { return uvEncoding() == ENCODING_UV_FLOAT2 ? sizeof(float2) : sizeof(uint); }
+    // byte offset of uv set i inside the attributes of a vertex, see Mesh::VertexAttributeFormat::uvOffset
+    uint uvAttributeOffset(uint i)
     {
         return colorOffset() + colorSize() + i * uvSize();
     }
@@ -25,16 +93,96 @@ struct MeshData
     {
         return normalSize() + colorSize() + (1 + additionalUVCount) * uvSize();
     }
+
+    // --- decoding ---
+
+    float3 loadPosition(uint vertexIndex)
+    {
+        const ByteAddressBuffer positions = positionBuffer.get();
+        if(positionEncoding() == ENCODING_POSITION_FLOAT3)
+            return asfloat(positions.Load3(vertexIndex * sizeof(float3)));
+        const uint2 packed = positions.Load2(vertexIndex * sizeof(uint2));
+        const float3 unorm = float3(packed.x & 0xFFFF, packed.x >> 16, packed.y & 0xFFFF) / 65535.0;
+        return positionOffset + positionScale * unorm;
+    }
+
+    float3 loadNormal(ByteAddressBuffer attributes, uint vertexIndex)
+    {
+        const uint address = vertexIndex * attribStride() + normalOffset();
+        if(normalEncoding() == ENCODING_NORMAL_FLOAT3)
+            return asfloat(attributes.Load3(address));
+        return decodeOctahedral16(attributes.Load(address));
+    }
+
+    float3 loadColor(ByteAddressBuffer attributes, uint vertexIndex)
+    {
+        const uint address = vertexIndex * attribStride() + colorOffset();
+        if(colorEncoding() == ENCODING_COLOR_FLOAT3)
+            return asfloat(attributes.Load3(address));
+        const uint packed = attributes.Load(address);
+        return float3(packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF) / 255.0;
+    }
+
+    float2 loadUV(ByteAddressBuffer attributes, uint vertexIndex, uint set)
+    {
+        const uint address = vertexIndex * attribStride() + uvAttributeOffset(set);
+        const uint uvEnc = uvEncoding();
+        if(uvEnc == ENCODING_UV_FLOAT2)
+            return asfloat(attributes.Load2(address));
+        const uint packed = attributes.Load(address);
+        if(uvEnc == ENCODING_UV_HALF2)
+            return f16tof32(uint2(packed & 0xFFFF, packed >> 16));
+        return uvOffset + uvScale * unpackUNorm16x2(packed);
+    }
+
+    // --- meshlets ---
+
+    Meshlet loadMeshlet(uint meshletIndex)
+    {
+        return meshletBuffer.get()[meshletIndex];
+    }
+
+    // index into the vertex buffers of the i-th vertex of the meshlet
+    uint loadMeshletVertex(Meshlet meshlet, uint i)
+    {
+        return meshletVertexBuffer.get()[meshlet.vertexOffset + i];
+    }
+
+    // local vertex indices (< meshlet.vertexCount) of the i-th triangle of the meshlet
+    uint3 loadMeshletTriangle(Meshlet meshlet, uint i)
+    {
+        const uint packed = meshletTriangleBuffer.get()[meshlet.triangleOffset + i];
+        return uint3(packed & 0xFF, (packed >> 8) & 0xFF, (packed >> 16) & 0xFF);
+    }
 };
 
 struct InstanceInfo
 {
-    float4x4 transform;
-    float4x4 invTranspTransform;
+    // affine object to world transform, the implicit last row is (0, 0, 0, 1)
+    row_major float3x4 transform;
     uint meshDataIndex;
     uint materialIndex;
     Handle< Placeholder > materialParamsBuffer;
     Handle< Placeholder > materialInstanceParamsBuffer;
+
+    float4 transformPoint(float3 position)
+    {
+        return float4(mul(transform, float4(position, 1.0)), 1.0);
+    }
+
+    /*
+        Inverse transpose of the upper 3x3 without having to store it
+        Its rows are the cross products of the rows of the upper 3x3, divided by the determinant
+    */
+    float3x3 normalMatrix()
+    {
+        const float3 r0 = transform[0].xyz;
+        const float3 r1 = transform[1].xyz;
+        const float3 r2 = transform[2].xyz;
+        const float3 c0 = cross(r1, r2);
+        const float det = dot(r0, c0);
+        return float3x3(c0, cross(r2, r0), cross(r0, r1)) / det;
+    }
 };
 
 #endif
\ No newline at end of file
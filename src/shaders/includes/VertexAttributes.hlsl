@@ -28,8 +28,9 @@ struct VertexAttributes
 struct VSInput
 {
     uint vertexID : SV_VertexID;
-    [[vk::builtin("BaseInstance")]]
-    int baseInstance : BASE_INSTANCE;
+    // Vulkan InstanceIndex, so it includes firstInstance (no -fvk-support-nonzero-base-instance)
+    // Index into the draws instance index buffer, see getInstanceIndex()
+    uint instanceID : SV_InstanceID;
 };
 
 #endif
\ No newline at end of file